@@ -27,6 +27,7 @@ class ALabel : public AModule {
 
   bool handleToggle(GdkEventButton *const &e) override;
   virtual std::string getState(uint8_t value, bool lesser = false);
+  std::optional<std::string> getRenderedText() const override { return label_.get_label(); }
 };
 
 }  // namespace waybar
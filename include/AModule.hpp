@@ -5,7 +5,12 @@
 #include <gtkmm/eventbox.h>
 #include <json/json.h>
 
+#include <atomic>
+#include <memory>
+
 #include "IModule.hpp"
+#include "util/scroll_burst.hpp"
+#include "util/update_hook.hpp"
 
 namespace waybar {
 
@@ -31,7 +36,11 @@ class AModule : public IModule {
   enum SCROLL_DIR { NONE, UP, DOWN, LEFT, RIGHT };
 
   SCROLL_DIR getScrollDir(GdkEventScroll *e);
+  // Direction and number of steps of a scroll event, smooth deltas step once per threshold
+  std::pair<SCROLL_DIR, unsigned> getScrollSteps(GdkEventScroll *e);
   bool tooltipEnabled();
+  // Rendered text passed to the on-update hook, nullopt if the module has no single label
+  virtual std::optional<std::string> getRenderedText() const { return std::nullopt; }
 
   const std::string name_;
   const Json::Value &config_;
@@ -43,15 +52,26 @@ class AModule : public IModule {
   virtual bool handleMouseEnter(GdkEventCrossing *const &ev);
   virtual bool handleMouseLeave(GdkEventCrossing *const &ev);
   virtual bool handleScroll(GdkEventScroll *);
+  // Called once per frame with the steps scrolled in one direction
+  virtual void handleScrollSteps(SCROLL_DIR dir, unsigned steps);
   virtual bool handleRelease(GdkEventButton *const &ev);
 
  private:
   bool handleUserEvent(GdkEventButton *const &ev);
+  void flushScroll();
+  std::string getRenderedClasses();
+  void scheduleUpdateHook();
   const bool isTooltip;
   bool hasUserEvents_;
-  std::vector<int> pid_;
-  gdouble distance_scrolled_y_;
-  gdouble distance_scrolled_x_;
+  util::ScrollDistance distance_scrolled_y_;
+  util::ScrollDistance distance_scrolled_x_;
+  util::ScrollBurst<SCROLL_DIR> scroll_burst_;
+  sigc::connection scroll_flush_;
+  util::UpdateHook update_hook_;
+  // cleared by the reaper once the running invocation exits
+  std::shared_ptr<std::atomic<bool>> update_hook_running_ =
+      std::make_shared<std::atomic<bool>>(false);
+  sigc::connection update_hook_timer_;
   std::map<std::string, std::string> eventActionMap_;
   static const inline std::map<std::pair<uint, GdkEventType>, std::string> eventMap_{
       {std::make_pair(1, GdkEventType::GDK_BUTTON_PRESS), "on-click"},
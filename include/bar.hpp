@@ -71,7 +71,7 @@ class Bar {
   void handleSignal(int);
 
   struct waybar_output *output;
-  Json::Value config;
+  const Json::Value &config;
   struct wl_surface *surface;
   bool visible = true;
   Gtk::Window window;
@@ -89,8 +89,6 @@ class Bar {
   void onMap(GdkEventAny *);
   auto setupWidgets() -> void;
   void getModules(const Factory &, const std::string &, waybar::Group *);
-  void setupAltFormatKeyForModule(const std::string &module_name);
-  void setupAltFormatKeyForModuleList(const char *module_list_name);
   void setMode(const bar_mode &);
   void setPassThrough(bool passthrough);
   void setPosition(Gtk::PositionType position);
@@ -38,7 +38,8 @@ class Client {
   void handleOutput(struct waybar_output &output);
   auto setupCss(const std::string &css_file) -> void;
   struct waybar_output &getOutput(void *);
-  std::vector<Json::Value> getOutputConfigs(struct waybar_output &output);
+  std::vector<std::reference_wrapper<const Json::Value>> getOutputConfigs(
+      struct waybar_output &output);
 
   static void handleGlobal(void *data, struct wl_registry *registry, uint32_t name,
                            const char *interface, uint32_t version);
@@ -2,8 +2,11 @@
 
 #include <json/json.h>
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
+#include <vector>
 
 #ifndef SYSCONFDIR
 #define SYSCONFDIR "/etc"
@@ -22,19 +25,54 @@ class Config {
 
   Config() = default;
 
+  /* Reuses the previously merged config when none of the files it was read from changed */
   void load(const std::string &config);
 
+  /* Whether the last load() was served from the cache instead of parsing the files */
+  bool loadedFromCache() const { return from_cache_; }
+
+  /* Where the merged config of a main config file is cached, empty without a cache directory */
+  static std::string cachePath(const std::string &config_file);
+
   Json::Value &getConfig() { return config_; }
 
-  std::vector<Json::Value> getOutputConfigs(const std::string &name, const std::string &identifier);
+  /* Bar configs for the output; views into the loaded config, valid until the next load() */
+  std::vector<std::reference_wrapper<const Json::Value>> getOutputConfigs(
+      const std::string &name, const std::string &identifier) const;
 
  private:
-  void setupConfig(Json::Value &dst, const std::string &config_file, int depth);
+  /* A file the config was read from, as it was when it was read */
+  struct Source {
+    std::string include;  // spec the path was expanded from, empty for the main config file
+    std::string path;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    int64_t ctime_ns = 0;
+
+    bool operator==(const Source &) const = default;
+  };
+
+  static std::optional<Source> statSource(const std::string &include, const std::string &path);
+  static bool sourcesUnchanged(const std::vector<Source> &sources);
+  bool loadCache();
+  void saveCache() const;
+
+  void setupConfig(Json::Value &dst, const std::string &config_file, int depth,
+                   const std::string &include = "");
   void resolveConfigIncludes(Json::Value &config, int depth);
   void mergeConfig(Json::Value &a_config_, Json::Value &b_config_);
+  void setupAltFormatKeyForModule(Json::Value &bar_config, const std::string &module_name);
+  void setupAltFormatKeyForModuleList(Json::Value &bar_config, const char *module_list_name);
 
   std::string config_file_;
 
   Json::Value config_;
+  // config_ as it was loaded, reused while sources_ are unchanged
+  Json::Value cached_;
+  std::vector<Source> sources_;
+  std::vector<Source> reading_;  // sources of the load in progress
+  bool from_cache_ = false;
 };
 }  // namespace waybar
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/sleeper_thread.hpp"
+
+namespace cava {
+extern "C" {
+#include <cava/common.h>
+}
+}  // namespace cava
+
+namespace waybar::modules {
+using namespace std::literals::chrono_literals;
+
+/*
+ * Audio capture and spectrum computation shared by the cava modules of all bars.
+ * One engine runs per set of options that change the captured audio or the computed bars,
+ * modules only turn the latest frame into markup.
+ */
+class CavaEngine {
+  struct private_constructor_tag {};
+
+ public:
+  struct Frame {
+    std::vector<int> bars;
+    bool silence = false;
+    bool suspended = false;
+  };
+
+  static std::shared_ptr<CavaEngine> getInstance(const Json::Value& config);
+  // Options of the module config the engine is keyed on
+  static std::string keyFor(const Json::Value& config);
+
+  CavaEngine(const Json::Value& config, private_constructor_tag tag);
+  ~CavaEngine();
+
+  Frame frame() const;
+  const cava::config_params& params() const { return prm_; }
+  void pauseResume();
+
+  // Listeners are called from the engine thread, at most once per computed frame
+  uint64_t addListener(std::function<void()> listener);
+  void removeListener(uint64_t id);
+
+ private:
+  void tick();
+  void notify();
+  std::chrono::milliseconds frameTime();
+
+  util::SleeperThread thread_;
+  util::SleeperThread thread_fetch_input_;
+
+  struct cava::error_s error_ {};          // cava errors
+  struct cava::config_params prm_ {};      // cava parameters
+  struct cava::audio_raw audio_raw_ {};    // cava handled raw audio data(is based on audio_data)
+  struct cava::audio_data audio_data_ {};  // cava audio data
+  struct cava::cava_plan* plan_;           //{new cava_plan{}};
+  // Cava API to read audio source
+  cava::ptr input_source_;
+  // Delay to handle audio source. Changed by the engine thread and by pauseResume(), both
+  // under audio_data_.lock
+  std::chrono::milliseconds frame_time_milsec_{1s};
+  int rePaint_{1};
+  std::chrono::seconds fetch_input_delay_{4};
+  // guarded by audio_data_.lock like frame_time_milsec_
+  std::chrono::seconds suspend_silence_delay_{0};
+  bool silence_{false};
+  int sleep_counter_{0};
+
+  mutable std::mutex mutex_;
+  Frame frame_;
+  std::map<uint64_t, std::function<void()>> listeners_;
+  uint64_t next_listener_ = 1;
+};
+
+}  // namespace waybar::modules
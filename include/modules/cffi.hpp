@@ -1,8 +1,14 @@
 #pragma once
 
+#include <sigc++/connection.h>
+
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 
 #include "AModule.hpp"
+#include "modules/cffi_plugin.hpp"
 #include "util/command.hpp"
 #include "util/json.hpp"
 #include "util/sleeper_thread.hpp"
@@ -10,21 +16,20 @@
 namespace waybar::modules {
 
 namespace ffi {
-extern "C" {
-typedef struct wbcffi_module wbcffi_module;
-
-typedef struct {
-  wbcffi_module* obj;
-  const char* waybar_version;
-  GtkContainer* (*get_root_widget)(wbcffi_module*);
-  void (*queue_update)(wbcffi_module*);
-} wbcffi_init_info;
-
-struct wbcffi_config_entry {
-  const char* key;
-  const char* value;
+// Host side of the wbcffi_module pointer handed to the plugin
+struct wbcffi_module {
+  GtkContainer* root = nullptr;
+  std::function<void()> queue_update;
+  // fds and timers registered on the GTK main loop, removed with the object
+  std::map<wbcffi_source, sigc::connection> sources;
+  wbcffi_source next_source = 1;
+  // handed to the plugin, valid for the lifetime of the object
+  wbcffi_init_info info{};
+
+  ~wbcffi_module();
+
+  const wbcffi_init_info& initInfo(const wbcffi_config_node* config, void* shared);
 };
-}
 }  // namespace ffi
 
 class CFFI : public AModule {
@@ -37,24 +42,26 @@ class CFFI : public AModule {
   virtual auto update() -> void override;
 
  private:
-  ///
-  void* cffi_instance_ = nullptr;
+  // One instance of wbcffi_shared_init for all modules of a library with equal configs
+  struct Shared {
+    std::shared_ptr<ffi::Plugin> plugin;
+    ffi::ConfigTree config;
+    ffi::wbcffi_module module;
+    void* instance = nullptr;
+    std::vector<CFFI*> views;
 
-  typedef void*(InitFn)(const ffi::wbcffi_init_info* init_info,
-                        const ffi::wbcffi_config_entry* config_entries, size_t config_entries_len);
-  typedef void(DenitFn)(void* instance);
-  typedef void(RefreshFn)(void* instance, int signal);
-  typedef void(DoActionFn)(void* instance, const char* name);
-  typedef void(UpdateFn)(void* instance);
-
-  // FFI hooks
-  struct {
-    std::function<InitFn> init = nullptr;
-    std::function<DenitFn> deinit = nullptr;
-    std::function<RefreshFn> refresh = [](void*, int) {};
-    std::function<DoActionFn> doAction = [](void*, const char*) {};
-    std::function<UpdateFn> update = [](void*) {};
-  } hooks_;
+    Shared(std::shared_ptr<ffi::Plugin> plugin, const Json::Value& config);
+    ~Shared();
+  };
+
+  static std::shared_ptr<Shared> getShared(const std::shared_ptr<ffi::Plugin>& plugin,
+                                           const Json::Value& config);
+
+  std::shared_ptr<ffi::Plugin> plugin_;
+  std::shared_ptr<Shared> shared_;
+  ffi::ConfigTree config_tree_;
+  ffi::wbcffi_module module_;
+  void* cffi_instance_ = nullptr;
 };
 
 }  // namespace waybar::modules
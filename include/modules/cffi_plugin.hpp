@@ -0,0 +1,154 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef struct _GtkContainer GtkContainer;
+
+namespace waybar::modules::ffi {
+
+// Mirrors resources/custom_modules/cffi_example/waybar_cffi_module.h
+extern "C" {
+typedef struct wbcffi_module wbcffi_module;
+
+typedef enum {
+  WBCFFI_CONFIG_NULL,
+  WBCFFI_CONFIG_BOOL,
+  WBCFFI_CONFIG_INT,
+  WBCFFI_CONFIG_UINT,
+  WBCFFI_CONFIG_DOUBLE,
+  WBCFFI_CONFIG_STRING,
+  WBCFFI_CONFIG_ARRAY,
+  WBCFFI_CONFIG_OBJECT,
+} wbcffi_config_type;
+
+typedef struct wbcffi_config_node wbcffi_config_node;
+struct wbcffi_config_node {
+  wbcffi_config_type type;
+  const char* key;
+  union {
+    bool boolean;
+    int64_t integer;
+    uint64_t uinteger;
+    double real;
+    const char* string;
+    struct {
+      const wbcffi_config_node* items;
+      size_t len;
+    } children;
+  } as;
+};
+
+typedef uint64_t wbcffi_source;
+
+enum {
+  WBCFFI_FD_READABLE = 1 << 0,
+  WBCFFI_FD_WRITABLE = 1 << 1,
+  WBCFFI_FD_HANGUP = 1 << 2,
+};
+
+typedef bool (*wbcffi_fd_callback)(void* user_data, int fd, uint32_t events);
+typedef bool (*wbcffi_timer_callback)(void* user_data);
+
+typedef struct {
+  wbcffi_module* obj;
+  const char* waybar_version;
+  GtkContainer* (*get_root_widget)(wbcffi_module*);
+  void (*queue_update)(wbcffi_module*);
+  // ABI version 2
+  const wbcffi_config_node* config;
+  void* shared;
+  wbcffi_source (*add_fd)(wbcffi_module*, int fd, uint32_t events, wbcffi_fd_callback callback,
+                          void* user_data);
+  wbcffi_source (*add_timer)(wbcffi_module*, uint32_t interval_ms,
+                             wbcffi_timer_callback callback, void* user_data);
+  void (*remove_source)(wbcffi_module*, wbcffi_source source);
+} wbcffi_init_info;
+
+struct wbcffi_config_entry {
+  const char* key;
+  const char* value;
+};
+}
+
+/*
+ * Copy of a JSON config as a tree of wbcffi_config_node.
+ * The nodes and strings stay valid as long as the tree exists; children of an array or object
+ * are stored contiguously so plugins can index them directly.
+ */
+class ConfigTree {
+ public:
+  explicit ConfigTree(const Json::Value& config);
+  ConfigTree(const ConfigTree&) = delete;
+  ConfigTree& operator=(const ConfigTree&) = delete;
+
+  const wbcffi_config_node* root() const { return &root_; }
+
+ private:
+  void fill(wbcffi_config_node& node, const Json::Value& value);
+  const char* store(std::string str);
+
+  wbcffi_config_node root_;
+  std::vector<std::unique_ptr<wbcffi_config_node[]>> children_;
+  std::deque<std::string> strings_;
+};
+
+/*
+ * A loaded CFFI dynamic library.
+ * Libraries are opened once per path and kept open while a module or shared backend uses them.
+ */
+class Plugin {
+ public:
+  static std::shared_ptr<Plugin> load(const std::string& path);
+
+  Plugin(const Plugin&) = delete;
+  Plugin& operator=(const Plugin&) = delete;
+  ~Plugin();
+
+  size_t version() const { return version_; }
+  // The library exports wbcffi_shared_init and wbcffi_shared_deinit
+  bool hasShared() const { return shared_init_ != nullptr; }
+
+  // Calls wbcffi_init, passing the config as flat key/value entries as well
+  void* init(const wbcffi_init_info& info, const Json::Value& config) const;
+  void deinit(void* instance) const { deinit_(instance); }
+  void update(void* instance) const;
+  void refresh(void* instance, int signal) const;
+  void doAction(void* instance, const char* name) const;
+
+  void* sharedInit(const wbcffi_init_info& info) const;
+  void sharedDeinit(void* shared) const { shared_deinit_(shared); }
+
+ private:
+  explicit Plugin(const std::string& path);
+
+  template <typename T>
+  T* symbol(const char* name, bool required) const;
+
+  using InitFn = void*(const wbcffi_init_info* init_info,
+                       const wbcffi_config_entry* config_entries, size_t config_entries_len);
+  using DeinitFn = void(void* instance);
+  using UpdateFn = void(void* instance);
+  using RefreshFn = void(void* instance, int signal);
+  using DoActionFn = void(void* instance, const char* name);
+  using SharedInitFn = void*(const wbcffi_init_info* init_info);
+  using SharedDeinitFn = void(void* shared);
+
+  void* handle_;
+  size_t version_;
+  InitFn* init_ = nullptr;
+  DeinitFn* deinit_ = nullptr;
+  UpdateFn* update_ = nullptr;
+  RefreshFn* refresh_ = nullptr;
+  DoActionFn* do_action_ = nullptr;
+  SharedInitFn* shared_init_ = nullptr;
+  SharedDeinitFn* shared_deinit_ = nullptr;
+};
+
+}  // namespace waybar::modules::ffi
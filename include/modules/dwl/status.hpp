@@ -0,0 +1,113 @@
+#pragma once
+
+#include <sigc++/connection.h>
+#include <wayland-client.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dwl-ipc-unstable-v2-client-protocol.h"
+
+namespace waybar::modules::dwl {
+
+// Bits describing which parts of the state changed since the last notification
+enum StatusChange : uint32_t {
+  TAGS = 1 << 0,
+  LAYOUT = 1 << 1,
+  TITLE = 1 << 2,
+  APPID = 1 << 3,
+  LAYOUT_SYMBOL = 1 << 4,
+  ACTIVE = 1 << 5,
+  ALL = (1 << 6) - 1,
+};
+
+struct TagState {
+  uint32_t state{0};
+  uint32_t clients{0};
+  uint32_t focused{0};
+
+  bool operator==(const TagState &) const = default;
+};
+
+struct OutputState {
+  std::vector<TagState> tags;
+  uint32_t active_tags{0};  // mask of the tags with ZDWL_IPC_OUTPUT_V2_TAG_STATE_ACTIVE
+  uint32_t layout{0};
+  std::string title;
+  std::string appid;
+  std::string layout_symbol;
+  bool active{false};
+};
+
+class StatusListener {
+ public:
+  virtual void handle_status(const OutputState &output, uint32_t changed) = 0;
+  virtual ~StatusListener() = default;
+};
+
+/*
+ * Process-wide owner of the dwl ipc objects.
+ * Every module shares one zdwl_ipc_output_v2 per output; events are accumulated until the
+ * compositor sends `frame` and then delivered to all modules of that output as one snapshot.
+ */
+class Status {
+ public:
+  // Binds the globals on first use per display, later calls return the same instance
+  static std::shared_ptr<Status> getInstance(struct wl_display *display);
+
+  Status(const Status &) = delete;
+  Status &operator=(const Status &) = delete;
+  ~Status();
+
+  bool available() const { return ipc_manager_ != nullptr; }
+  struct wl_seat *seat() const { return seat_; }
+
+  void addListener(struct wl_output *output, StatusListener *listener);
+  void removeListener(StatusListener *listener);
+
+  void set_tags(struct wl_output *output, uint32_t tagmask, uint32_t toggle_tagset);
+
+  // Handlers for wayland events
+  void handle_active(struct zdwl_ipc_output_v2 *ipc_output, uint32_t active);
+  void handle_tag(struct zdwl_ipc_output_v2 *ipc_output, uint32_t tag, uint32_t state,
+                  uint32_t clients, uint32_t focused);
+  void handle_layout(struct zdwl_ipc_output_v2 *ipc_output, uint32_t layout);
+  void handle_title(struct zdwl_ipc_output_v2 *ipc_output, const char *title);
+  void handle_appid(struct zdwl_ipc_output_v2 *ipc_output, const char *appid);
+  void handle_layout_symbol(struct zdwl_ipc_output_v2 *ipc_output, const char *layout_symbol);
+  void handle_frame(struct zdwl_ipc_output_v2 *ipc_output);
+
+  struct zdwl_ipc_manager_v2 *ipc_manager_;
+  struct wl_seat *seat_;
+
+ private:
+  struct Output {
+    struct wl_output *output;
+    struct zdwl_ipc_output_v2 *ipc_output;
+    OutputState state;
+    uint32_t changed;  // accumulated since the last frame
+    size_t refs;
+  };
+
+  struct Subscriber {
+    struct wl_output *output;
+    StatusListener *listener;
+    uint32_t pending;
+  };
+
+  explicit Status(struct wl_display *display);
+
+  Output *findOutput(struct zdwl_ipc_output_v2 *ipc_output);
+  void scheduleDispatch();
+  void dispatch();
+
+  std::map<struct wl_output *, Output> outputs_;
+  std::list<Subscriber> subscribers_;
+  sigc::connection dispatch_conn_;
+};
+
+}  // namespace waybar::modules::dwl
@@ -5,30 +5,28 @@
 
 #include "AModule.hpp"
 #include "bar.hpp"
-#include "dwl-ipc-unstable-v2-client-protocol.h"
+#include "modules/dwl/status.hpp"
 #include "xdg-output-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::dwl {
 
-class Tags : public waybar::AModule {
+class Tags : public waybar::AModule, public StatusListener {
  public:
   Tags(const std::string &, const waybar::Bar &, const Json::Value &);
   virtual ~Tags();
 
-  // Handlers for wayland events
-  void handle_view_tags(uint32_t tag, uint32_t state, uint32_t clients, uint32_t focused);
+  void handle_status(const OutputState &output, uint32_t changed) override;
 
   void handle_primary_clicked(uint32_t tag);
   bool handle_button_press(GdkEventButton *event_button, uint32_t tag);
 
-  struct zdwl_ipc_manager_v2 *status_manager_;
-  struct wl_seat *seat_;
-
  private:
   const waybar::Bar &bar_;
   Gtk::Box box_;
   std::vector<Gtk::Button> buttons_;
-  struct zdwl_ipc_output_v2 *output_status_;
+  struct wl_output *output_;
+  uint32_t active_tags_;
+  std::shared_ptr<Status> status_;
 };
 
 } /* namespace waybar::modules::dwl */
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include "util/json.hpp"
+#include "util/thread.hpp"
 
 namespace waybar::modules::hyprland {
 
@@ -20,24 +25,45 @@ class EventHandler {
 class IPC {
  public:
   IPC() { startIPC(); }
+  ~IPC();
 
   void registerForIPC(const std::string& ev, EventHandler* ev_handler);
   void unregisterForIPC(EventHandler* handler);
 
   static std::string getSocket1Reply(const std::string& rq);
+  // Send a request without waiting for the reply. Requests are sent in order from a worker
+  // thread, so input handlers don't block on the compositor.
+  void dispatch(const std::string& rq);
   Json::Value getSocket1JsonReply(const std::string& rq);
   static std::filesystem::path getSocketFolder(const char* instanceSig);
 
+  // Current submap, empty for the default one. Queried once by the IPC thread when it connects,
+  // then kept up to date by events, so this never waits on the compositor.
+  std::string getSubmap();
+
  protected:
   static std::filesystem::path socketFolder_;
 
+  void parseIPC(const std::string&);
+  // Query the current submap, a failed query counts as the default submap
+  void seedSubmap();
+
  private:
   void startIPC();
-  void parseIPC(const std::string&);
+  void dispatchWorker();
+  bool updateSubmap(const std::string& ev);
 
   std::mutex callbackMutex_;
+  std::mutex submapMutex_;
+  std::optional<std::string> submap_;
   util::JsonParser parser_;
   std::list<std::pair<std::string, EventHandler*>> callbacks_;
+
+  std::mutex dispatchMutex_;
+  std::condition_variable dispatchCv_;
+  std::deque<std::string> dispatchQueue_;
+  util::Thread dispatchThread_;
+  bool dispatchStop_ = false;
 };
 
 inline std::unique_ptr<IPC> gIPC;
@@ -26,6 +26,7 @@ class Submap : public waybar::ALabel, public EventHandler {
   const Bar& bar_;
   util::JsonParser parser_;
   std::string submap_;
+  bool rendered_ = false;
   bool always_on_ = false;
   std::string default_submap_ = "Default";
 };
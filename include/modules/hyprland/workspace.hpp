@@ -45,7 +45,7 @@ class Workspace {
   bool isEmpty() const { return m_windows == 0; };
   bool isUrgent() const { return m_isUrgent; };
 
-  bool handleClicked(GdkEventButton* bt) const;
+  bool handleClicked(GdkEventButton* bt);
   void setActive(bool value = true) { m_isActive = value; };
   void setPersistentRule(bool value = true) { m_isPersistentRule = value; };
   void setPersistentConfig(bool value = true) { m_isPersistentConfig = value; };
@@ -63,6 +63,8 @@ class Workspace {
   std::optional<std::string> closeWindow(WindowAddress const& addr);
 
   void update(const std::string& format, const std::string& icon);
+  // Refresh only the "active" class, for state changes that don't need a full update
+  void updateActiveClass();
 
  private:
   Workspaces& m_workspaceManager;
@@ -47,6 +47,9 @@ class Workspaces : public AModule, public EventHandler {
   std::string& getWindowSeparator() { return m_formatWindowSeparator; }
   bool isWorkspaceIgnored(std::string const& workspace_name);
 
+  // Mark a workspace active before Hyprland reports the switch
+  void activateWorkspace(std::string const& workspace_name);
+
   bool windowRewriteConfigUsesTitle() const { return m_anyWindowRewriteRuleUsesTitle; }
 
  private:
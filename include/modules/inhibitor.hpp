@@ -1,11 +1,10 @@
 #pragma once
 
-#include <gio/gio.h>
-
 #include <memory>
 
 #include "ALabel.hpp"
 #include "bar.hpp"
+#include "util/logind_inhibitor.hpp"
 
 namespace waybar::modules {
 
@@ -19,9 +18,9 @@ class Inhibitor : public ALabel {
  private:
   auto handleToggle(::GdkEventButton* const& e) -> bool override;
 
-  const std::unique_ptr<::GDBusConnection, void (*)(::GDBusConnection*)> dbus_;
+  const std::shared_ptr<util::LogindInhibitor> inhibitor_;
   const std::string inhibitors_;
-  int handle_ = -1;
+  sigc::connection changed_;
 };
 
 }  // namespace waybar::modules
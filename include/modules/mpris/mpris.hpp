@@ -45,9 +45,10 @@ class Mpris : public ALabel {
 
   auto getPlayerInfo() -> std::optional<PlayerInfo>;
   auto getIconFromJson(const Json::Value&, const std::string&) -> std::string;
-  auto getArtistStr(const PlayerInfo&, bool) -> std::string;
-  auto getAlbumStr(const PlayerInfo&, bool) -> std::string;
-  auto getTitleStr(const PlayerInfo&, bool) -> std::string;
+  auto truncateText(const std::string&, int, bool) -> std::string;
+  auto getArtistStr(const PlayerInfo&, bool, bool = false) -> std::string;
+  auto getAlbumStr(const PlayerInfo&, bool, bool = false) -> std::string;
+  auto getTitleStr(const PlayerInfo&, bool, bool = false) -> std::string;
   auto getLengthStr(const PlayerInfo&, bool) -> std::string;
   auto getPositionStr(const PlayerInfo&, bool) -> std::string;
   auto getDynamicStr(const PlayerInfo&, bool, bool) -> std::string;
@@ -8,9 +8,11 @@
 #include <netlink/netlink.h>
 #include <sys/epoll.h>
 
+#include <map>
 #include <optional>
 
 #include "ALabel.hpp"
+#include "util/netdev.hpp"
 #include "util/sleeper_thread.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
@@ -28,7 +30,20 @@ class Network : public ALabel {
   static const uint8_t MAX_RETRY = 5;
   static const uint8_t EPOLL_MAX = 200;
 
+  /* An interface tracked when "interface" lists several names or patterns */
+  struct Interface {
+    std::string ifname;
+    size_t pattern = 0;  // first pattern matching ifname, orders the interfaces
+    bool up = false;
+    bool carrier = false;
+    bool is_p2p = false;
+    std::string ipaddr;
+    std::string netmask;
+    int cidr = 0;
+  };
+
   static int handleEvents(struct nl_msg*, void*);
+  int handleInterfacesEvent(struct nlmsghdr*);
   static int handleEventsDone(struct nl_msg*, void*);
   static int handleScan(struct nl_msg*, void*);
 
@@ -42,11 +57,14 @@ class Network : public ALabel {
   void parseFreq(struct nlattr**);
   bool associatedOrJoined(struct nlattr**);
   bool checkInterface(std::string name);
+  std::optional<size_t> matchInterface(const std::string& name) const;
+  void selectPrimaryInterface();
+  std::string formatInterfaces() const;
+  static std::string formatNetmask(int family, int prefixlen);
   auto getInfo() -> void;
   const std::string getNetworkState() const;
   void clearIface();
   bool wildcardMatch(const std::string& pattern, const std::string& text) const;
-  std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
 
   int ifid_;
   sa_family_t family_;
@@ -64,8 +82,12 @@ class Network : public ALabel {
   bool dump_in_progress_;
   bool is_p2p_;
 
-  unsigned long long bandwidth_down_total_;
-  unsigned long long bandwidth_up_total_;
+  util::BandwidthMeter bandwidth_;
+
+  // "interface" is a list: every matching interface is tracked from the one event socket and
+  // the best connected one fills the single interface fields below
+  bool multi_;
+  std::map<int, Interface> interfaces_;  // by interface index
 
   std::string state_;
   std::string essid_;
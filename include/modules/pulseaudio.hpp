@@ -14,14 +14,15 @@ namespace waybar::modules {
 class Pulseaudio : public ALabel {
  public:
   Pulseaudio(const std::string&, const Json::Value&);
-  virtual ~Pulseaudio() = default;
+  virtual ~Pulseaudio();
   auto update() -> void override;
 
  private:
-  bool handleScroll(GdkEventScroll* e) override;
+  void handleScrollSteps(SCROLL_DIR dir, unsigned steps) override;
   const std::vector<std::string> getPulseIcon() const;
 
   std::shared_ptr<util::AudioBackend> backend = nullptr;
+  uint64_t listener_ = 0;
 };
 
 }  // namespace waybar::modules
@@ -4,30 +4,21 @@
 
 #include "ALabel.hpp"
 #include "bar.hpp"
-#include "river-status-unstable-v1-client-protocol.h"
+#include "modules/river/status.hpp"
 
 namespace waybar::modules::river {
 
-class Layout : public waybar::ALabel {
+class Layout : public waybar::ALabel, public StatusListener {
  public:
   Layout(const std::string &, const waybar::Bar &, const Json::Value &);
   virtual ~Layout();
 
-  // Handlers for wayland events
-  void handle_name(const char *name);
-  void handle_clear();
-  void handle_focused_output(struct wl_output *output);
-  void handle_unfocused_output(struct wl_output *output);
-
-  struct zriver_status_manager_v1 *status_manager_;
-  struct wl_seat *seat_;
+  void handle_status(const OutputState &output, const SeatState &seat, uint32_t changed) override;
 
  private:
   const waybar::Bar &bar_;
-  struct wl_output *output_;          // stores the output this module belongs to
-  struct wl_output *focused_output_;  // stores the currently focused output
-  struct zriver_output_status_v1 *output_status_;
-  struct zriver_seat_status_v1 *seat_status_;
+  struct wl_output *output_;  // stores the output this module belongs to
+  std::shared_ptr<Status> status_;
 };
 
 } /* namespace waybar::modules::river */
@@ -4,25 +4,21 @@
 
 #include "ALabel.hpp"
 #include "bar.hpp"
-#include "river-status-unstable-v1-client-protocol.h"
+#include "modules/river/status.hpp"
 
 namespace waybar::modules::river {
 
-class Mode : public waybar::ALabel {
+class Mode : public waybar::ALabel, public StatusListener {
  public:
   Mode(const std::string &, const waybar::Bar &, const Json::Value &);
   virtual ~Mode();
 
-  // Handlers for wayland events
-  void handle_mode(const char *mode);
-
-  struct zriver_status_manager_v1 *status_manager_;
-  struct wl_seat *seat_;
+  void handle_status(const OutputState &output, const SeatState &seat, uint32_t changed) override;
 
  private:
   const waybar::Bar &bar_;
   std::string mode_;
-  struct zriver_seat_status_v1 *seat_status_;
+  std::shared_ptr<Status> status_;
 };
 
 } /* namespace waybar::modules::river */
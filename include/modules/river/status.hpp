@@ -0,0 +1,117 @@
+#pragma once
+
+#include <sigc++/connection.h>
+#include <wayland-client.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "river-control-unstable-v1-client-protocol.h"
+#include "river-status-unstable-v1-client-protocol.h"
+
+namespace waybar::modules::river {
+
+// Bits describing which parts of the state changed since the last notification
+enum StatusChange : uint32_t {
+  FOCUSED_TAGS = 1 << 0,
+  VIEW_TAGS = 1 << 1,
+  URGENT_TAGS = 1 << 2,
+  LAYOUT_NAME = 1 << 3,
+  OUTPUT_FOCUS = 1 << 4,
+  FOCUSED_VIEW = 1 << 5,
+  MODE = 1 << 6,
+  ALL = (1 << 7) - 1,
+};
+
+struct OutputState {
+  uint32_t focused_tags{0};
+  uint32_t view_tags{0};
+  uint32_t urgent_tags{0};
+  std::optional<std::string> layout_name;
+  bool focused{false};
+};
+
+struct SeatState {
+  struct wl_output *focused_output{nullptr};
+  std::string focused_view;
+  std::string mode;
+};
+
+class StatusListener {
+ public:
+  virtual void handle_status(const OutputState &output, const SeatState &seat,
+                             uint32_t changed) = 0;
+  virtual ~StatusListener() = default;
+};
+
+/*
+ * Process-wide owner of the river status and control objects.
+ * Every module shares one zriver_output_status_v1 per output and one zriver_seat_status_v1,
+ * events are demultiplexed in-process and delivered once per main loop iteration as a snapshot.
+ */
+class Status {
+ public:
+  // Binds the globals on first use per display, later calls return the same instance
+  static std::shared_ptr<Status> getInstance(struct wl_display *display);
+
+  Status(const Status &) = delete;
+  Status &operator=(const Status &) = delete;
+  ~Status();
+
+  void addListener(struct wl_output *output, StatusListener *listener);
+  void removeListener(StatusListener *listener);
+
+  uint32_t version() const { return version_; }
+  struct zriver_control_v1 *control() const { return control_; }
+  struct wl_seat *seat() const { return seat_; }
+
+  // Handlers for wayland events
+  void handle_focused_tags(struct zriver_output_status_v1 *status, uint32_t tags);
+  void handle_view_tags(struct zriver_output_status_v1 *status, struct wl_array *tags);
+  void handle_urgent_tags(struct zriver_output_status_v1 *status, uint32_t tags);
+  void handle_layout_name(struct zriver_output_status_v1 *status, const char *name);
+  void handle_layout_name_clear(struct zriver_output_status_v1 *status);
+  void handle_focused_output(struct wl_output *output);
+  void handle_unfocused_output(struct wl_output *output);
+  void handle_focused_view(const char *title);
+  void handle_mode(const char *mode);
+
+  struct zriver_status_manager_v1 *status_manager_;
+  struct zriver_control_v1 *control_;
+  struct wl_seat *seat_;
+  uint32_t version_;
+
+ private:
+  struct Output {
+    struct wl_output *output;
+    struct zriver_output_status_v1 *status;
+    OutputState state;
+    size_t refs;
+  };
+
+  struct Subscriber {
+    struct wl_output *output;
+    StatusListener *listener;
+    uint32_t pending;
+  };
+
+  explicit Status(struct wl_display *display);
+
+  Output *findOutput(struct zriver_output_status_v1 *status);
+  void markOutput(struct wl_output *output, uint32_t changed);
+  void markAll(uint32_t changed);
+  void scheduleDispatch();
+  void dispatch();
+
+  std::map<struct wl_output *, Output> outputs_;
+  std::list<Subscriber> subscribers_;
+  struct zriver_seat_status_v1 *seat_status_;
+  SeatState seat_state_;
+  sigc::connection dispatch_conn_;
+};
+
+} /* namespace waybar::modules::river */
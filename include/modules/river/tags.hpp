@@ -5,34 +5,28 @@
 
 #include "AModule.hpp"
 #include "bar.hpp"
-#include "river-control-unstable-v1-client-protocol.h"
-#include "river-status-unstable-v1-client-protocol.h"
+#include "modules/river/status.hpp"
 #include "xdg-output-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::river {
 
-class Tags : public waybar::AModule {
+class Tags : public waybar::AModule, public StatusListener {
  public:
   Tags(const std::string &, const waybar::Bar &, const Json::Value &);
   virtual ~Tags();
 
-  // Handlers for wayland events
-  void handle_focused_tags(uint32_t tags);
-  void handle_view_tags(struct wl_array *tags);
-  void handle_urgent_tags(uint32_t tags);
+  void handle_status(const OutputState &output, const SeatState &seat, uint32_t changed) override;
 
   void handle_primary_clicked(uint32_t tag);
   bool handle_button_press(GdkEventButton *event_button, uint32_t tag);
 
-  struct zriver_status_manager_v1 *status_manager_;
-  struct zriver_control_v1 *control_;
-  struct wl_seat *seat_;
-
  private:
+  void set_tag_class(const std::string &name, uint32_t tags);
+
   const waybar::Bar &bar_;
   Gtk::Box box_;
   std::vector<Gtk::Button> buttons_;
-  struct zriver_output_status_v1 *output_status_;
+  std::shared_ptr<Status> status_;
 };
 
 } /* namespace waybar::modules::river */
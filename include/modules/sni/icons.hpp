@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cairomm/surface.h>
+#include <gdkmm/pixbuf.h>
+#include <gtkmm/icontheme.h>
+#include <sigc++/connection.h>
+#include <sigc++/signal.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace waybar::modules::SNI {
+
+// Attention animation decoded once and played by the items of all bars
+struct Movie {
+  struct Frame {
+    Cairo::RefPtr<Cairo::Surface> surface;
+    int delay;  // milliseconds, negative for a still image
+  };
+  int scale;
+  std::vector<Frame> frames;
+};
+
+/*
+ * Icon themes and icon lookups shared by the tray items of all bars.
+ * Themes are interned by their search path, most items use the default theme or one of a few
+ * application paths. Resolved icons are kept until a theme reports a change, then the items
+ * are told through signal_invalidated to render again.
+ */
+class IconCache {
+ private:
+  IconCache();
+
+ public:
+  ~IconCache();
+
+  using singleton = std::shared_ptr<IconCache>;
+  static singleton getInstance() {
+    static std::weak_ptr<IconCache> weak;
+
+    std::shared_ptr<IconCache> strong = weak.lock();
+    if (!strong) {
+      strong = std::shared_ptr<IconCache>(new IconCache());
+      weak = strong;
+    }
+    return strong;
+  }
+
+  // Icon `name` at size * scale pixels, looked up in the theme path first if there is one.
+  // Returns an empty pointer if neither the path nor the default theme has the icon.
+  Glib::RefPtr<Gdk::Pixbuf> load(const std::string& name, int size, int scale,
+                                 const std::string& theme_path);
+
+  // Frames of an AttentionMovieName, a file path or an icon name, scaled to size * scale pixels
+  // high. Returns nullptr if the movie can not be loaded.
+  std::shared_ptr<const Movie> movie(const std::string& name, int size, int scale,
+                                     const std::string& theme_path);
+
+  // Decodes one loop of the animation in an image file, nullptr if it can not be loaded
+  static std::shared_ptr<const Movie> loadMovie(const std::string& file, int size, int scale);
+
+  // Scales a pixbuf to the given height, keeping the aspect ratio
+  static Glib::RefPtr<Gdk::Pixbuf> fitHeight(const Glib::RefPtr<Gdk::Pixbuf>& pixbuf, int height);
+
+  // Emitted with the theme path whose icons were dropped, an empty path when the default theme
+  // changed, which affects every item
+  sigc::signal<void(const std::string&)> signal_invalidated;
+
+ private:
+  // name, size, scale, theme path
+  using Key = std::tuple<std::string, int, int, std::string>;
+
+  struct Theme {
+    Glib::RefPtr<Gtk::IconTheme> theme;
+    sigc::connection changed;
+  };
+
+  Theme& theme(const std::string& path);
+  void invalidate(const std::string& path);
+
+  std::map<std::string, Theme> themes_;
+  std::map<Key, Glib::RefPtr<Gdk::Pixbuf>> icons_;
+  std::map<Key, std::weak_ptr<const Movie>> movies_;
+  sigc::connection default_changed_;
+};
+
+}  // namespace waybar::modules::SNI
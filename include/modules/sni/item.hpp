@@ -4,17 +4,17 @@
 #include <giomm/dbusproxy.h>
 #include <glibmm/refptr.h>
 #include <gtkmm/eventbox.h>
-#include <gtkmm/icontheme.h>
 #include <gtkmm/image.h>
 #include <gtkmm/menu.h>
 #include <json/json.h>
-#include <libdbusmenu-gtk/dbusmenu-gtk.h>
 #include <sigc++/trackable.h>
 
 #include <set>
 #include <string_view>
 
 #include "bar.hpp"
+#include "modules/sni/icons.hpp"
+#include "modules/sni/menu.hpp"
 
 namespace waybar::modules::SNI {
 
@@ -26,7 +26,7 @@ struct ToolTip {
 class Item : public sigc::trackable {
  public:
   Item(const std::string&, const std::string&, const Json::Value&, const Bar&);
-  ~Item() = default;
+  ~Item();
 
   std::string bus_name;
   std::string object_path;
@@ -41,15 +41,13 @@ class Item : public sigc::trackable {
   std::string title;
   std::string icon_name;
   Glib::RefPtr<Gdk::Pixbuf> icon_pixmap;
-  Glib::RefPtr<Gtk::IconTheme> icon_theme;
   std::string overlay_icon_name;
   std::string attention_icon_name;
+  Glib::RefPtr<Gdk::Pixbuf> attention_pixmap;
   std::string attention_movie_name;
   std::string icon_theme_path;
   std::string menu;
   ToolTip tooltip;
-  DbusmenuGtkMenu* dbus_menu = nullptr;
-  Gtk::Menu* gtk_menu = nullptr;
   /**
    * ItemIsMenu flag means that the item only supports the context menu.
    * Default value is true because libappindicator supports neither ItemIsMenu nor Activate method
@@ -63,17 +61,22 @@ class Item : public sigc::trackable {
   void setProperty(const Glib::ustring& name, Glib::VariantBase& value);
   void setStatus(const Glib::ustring& value);
   void getUpdatedProperties();
-  void processUpdatedProperties(Glib::RefPtr<Gio::AsyncResult>& result);
+  void processUpdatedProperty(Glib::RefPtr<Gio::AsyncResult>& result, const Glib::ustring& name);
   void onSignal(const Glib::ustring& sender_name, const Glib::ustring& signal_name,
                 const Glib::VariantContainerBase& arguments);
 
   void updateImage();
+  void onIconsInvalidated(const std::string& theme_path);
+  void playMovie();
+  void showMovieFrame(size_t index);
+  void stopMovie();
   Glib::RefPtr<Gdk::Pixbuf> extractPixBuf(GVariant* variant);
+  static size_t pixmapHash(const Glib::VariantBase& value);
   Glib::RefPtr<Gdk::Pixbuf> getIconPixbuf();
-  Glib::RefPtr<Gdk::Pixbuf> getIconByName(const std::string& name, int size);
+  Glib::RefPtr<Gdk::Pixbuf> getAttentionPixbuf();
+  Glib::RefPtr<Gdk::Pixbuf> getIconByName(const std::string& name);
   double getScaledIconSize();
-  static void onMenuDestroyed(Item* self, GObject* old_menu_pointer);
-  void makeMenu();
+  Gtk::Menu* getMenu();
   bool handleClick(GdkEventButton* const& /*ev*/);
   bool handleScroll(GdkEventScroll* const&);
   bool handleMouseEnter(GdkEventCrossing* const&);
@@ -85,8 +88,27 @@ class Item : public sigc::trackable {
   gdouble distance_scrolled_y_ = 0;
   // visibility of items with Status == Passive
   bool show_passive_ = false;
+  bool needs_attention_ = false;
+
+  // Icons ready to be shown, rebuilt when the icon properties or the scale change.
+  // Status changes only swap between them.
+  struct Rendered {
+    int scale = 0;
+    Cairo::RefPtr<Cairo::Surface> surface;
+  };
+  Rendered icon_surface_;
+  Rendered attention_surface_;
+  // content of the last decoded pixmaps
+  size_t icon_pixmap_hash_ = 0;
+  size_t attention_pixmap_hash_ = 0;
+  std::shared_ptr<const Movie> movie_;
+  size_t movie_frame_ = 0;
+  sigc::connection movie_timer_;
+  sigc::connection icons_invalidated_;
 
   const Bar& bar_;
+  IconCache::singleton icons_;
+  MenuCache::singleton menus_;
 
   Glib::RefPtr<Gio::DBus::Proxy> proxy_;
   Glib::RefPtr<Gio::Cancellable> cancellable_;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <gtkmm/menu.h>
+#include <gtkmm/widget.h>
+#include <libdbusmenu-gtk/dbusmenu-gtk.h>
+#include <sigc++/connection.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace waybar::modules::SNI {
+
+/*
+ * DBusMenu clients shared by the tray items of all bars.
+ * A client mirrors the whole menu layout of the service and follows its layout updates, so it
+ * is only created when the pointer enters the item and dropped after it was unused for a while.
+ * The layout arrives asynchronously, creating the client on hover has it ready for the click.
+ */
+class MenuCache {
+ private:
+  MenuCache() = default;
+
+ public:
+  ~MenuCache();
+
+  using singleton = std::shared_ptr<MenuCache>;
+  static singleton getInstance() {
+    static std::weak_ptr<MenuCache> weak;
+
+    std::shared_ptr<MenuCache> strong = weak.lock();
+    if (!strong) {
+      strong = std::shared_ptr<MenuCache>(new MenuCache());
+      weak = strong;
+    }
+    return strong;
+  }
+
+  // Create the client for bus_name/path so its layout is fetched before the menu is shown
+  void prefetch(const std::string& bus_name, const std::string& path);
+  // Menu for bus_name/path attached to widget, nullptr if the client could not be created
+  Gtk::Menu* get(const std::string& bus_name, const std::string& path, Gtk::Widget& widget);
+  // Detach any menu from a widget that is going away
+  void release(Gtk::Widget& widget);
+
+ private:
+  using Key = std::pair<std::string, std::string>;
+
+  struct Entry {
+    DbusmenuGtkMenu* dbus_menu;
+    Gtk::Menu* gtk_menu;
+    sigc::connection expire;
+  };
+
+  // Entry for the key, created if needed, its idle timeout restarted. nullptr on failure
+  Entry* lookup(const Key& key);
+  bool expire(Key key);
+  static void destroy(Entry& entry);
+
+  std::map<Key, Entry> menus_;
+};
+
+}  // namespace waybar::modules::SNI
@@ -3,6 +3,7 @@
 #include <string>
 
 #include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/prescan.hpp"
 #include "util/SafeSignal.hpp"
 #include "util/json.hpp"
 
@@ -32,19 +33,28 @@ class BarIpcClient {
   void onInitialConfig(const struct Ipc::ipc_response& res);
   void onIpcEvent(const struct Ipc::ipc_response&);
   void onCmd(const struct Ipc::ipc_response&);
+  void onReply(util::JsonParser& parser, const struct Ipc::ipc_response& res);
   void onConfigUpdate(const swaybar_config& config);
   void onVisibilityUpdate(bool visible_by_modifier);
   void onModeUpdate(bool visible_by_modifier);
   void onUrgencyUpdate(bool visible_by_urgency);
   void update();
+  void updateSubscriptions();
   bool isModuleEnabled(std::string name);
 
   Bar& bar_;
+  // parser_ runs on the event thread, reply_parser_ on the GTK thread for queued commands
   util::JsonParser parser_;
+  util::JsonParser reply_parser_;
   Ipc ipc_;
 
   swaybar_config bar_config_;
   std::string modifier_reset_;
+  bool has_mode_ = false;
+  bool has_workspaces_ = false;
+  bool subscribed_ = false;
+  // subscribed to the workspace, mode and binding events a hidden bar is shown by
+  bool tracking_visibility_ = false;
   bool visible_by_mode_ = false;
   bool visible_by_modifier_ = false;
   bool visible_by_urgency_ = false;
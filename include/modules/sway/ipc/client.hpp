@@ -1,15 +1,23 @@
 #pragma once
 
+#include <glibmm/dispatcher.h>
 #include <sigc++/sigc++.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "ipc.hpp"
 #include "util/sleeper_thread.hpp"
@@ -30,8 +38,17 @@ class Ipc {
   sigc::signal<void, const struct ipc_response &> signal_event;
   sigc::signal<void, const struct ipc_response &> signal_cmd;
 
+  using ReplyHandler = std::function<void(const struct ipc_response &)>;
+
   void sendCmd(uint32_t type, const std::string &payload = "");
+  // Queue a command without waiting for sway, queued commands are sent in order. The reply is
+  // not emitted on signal_cmd: it is passed to on_reply on the thread that created the Ipc, or
+  // dropped if there is no handler.
+  void sendCmdAsync(uint32_t type, const std::string &payload = "", ReplyHandler on_reply = {});
   void subscribe(const std::string &payload);
+  // Replace the subscriptions while the event worker runs. Sway can't drop a subscription, so
+  // this moves the events to a new connection and shuts the old one down
+  void resubscribe(const std::string &payload);
   void handleEvent();
   void setWorker(std::function<void()> &&func);
 
@@ -43,11 +60,34 @@ class Ipc {
   int open(const std::string &) const;
   struct ipc_response send(int fd, uint32_t type, const std::string &payload = "");
   struct ipc_response recv(int fd);
+  void commandWorker();
+  void handleReplies();
+  void closeRetired();
+
+  struct Command {
+    uint32_t type;
+    std::string payload;
+    ReplyHandler on_reply;
+  };
 
   int fd_;
-  int fd_event_;
+  std::atomic<int> fd_event_;
   std::mutex mutex_;
+  // event connections replaced by resubscribe(), closed by the event worker
+  std::mutex retired_mutex_;
+  std::vector<int> retired_fds_;
   util::SleeperThread thread_;
+
+  std::mutex cmd_mutex_;
+  std::condition_variable cmd_cv_;
+  std::deque<Command> cmd_queue_;
+  util::Thread cmd_thread_;
+  bool cmd_stop_ = false;
+
+  // replies of queued commands, handled on the thread that created the Ipc
+  std::mutex reply_mutex_;
+  std::deque<std::pair<ReplyHandler, struct ipc_response>> replies_;
+  Glib::Dispatcher reply_dp_;
 };
 
 }  // namespace waybar::modules::sway
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "ipc.hpp"
+
+namespace waybar::modules::sway {
+
+namespace prescan {
+
+inline size_t skipSpace(std::string_view json, size_t pos) {
+  while (pos < json.size() &&
+         (json[pos] == ' ' || json[pos] == '\n' || json[pos] == '\t' || json[pos] == '\r')) {
+    ++pos;
+  }
+  return pos;
+}
+
+// pos is on the opening quote, returns the position after the closing one
+inline size_t skipString(std::string_view json, size_t pos) {
+  for (++pos; pos < json.size(); ++pos) {
+    if (json[pos] == '\\') {
+      ++pos;
+    } else if (json[pos] == '"') {
+      return pos + 1;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Returns the position after the value starting at pos
+inline size_t skipValue(std::string_view json, size_t pos) {
+  if (pos >= json.size()) {
+    return std::string_view::npos;
+  }
+  if (json[pos] == '"') {
+    return skipString(json, pos);
+  }
+  if (json[pos] != '{' && json[pos] != '[') {
+    while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' &&
+           skipSpace(json, pos) == pos) {
+      ++pos;
+    }
+    return pos;
+  }
+  int depth = 0;
+  while (pos < json.size()) {
+    switch (json[pos]) {
+      case '"':
+        pos = skipString(json, pos);
+        if (pos == std::string_view::npos) {
+          return pos;
+        }
+        continue;
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        if (--depth == 0) {
+          return pos + 1;
+        }
+        break;
+    }
+    ++pos;
+  }
+  return std::string_view::npos;
+}
+
+}  // namespace prescan
+
+/*
+ * Raw text of a string member of a JSON object, without building a DOM.
+ * Members before it are skipped without being looked into, so a key sway sends first is found
+ * right away. nullopt if the member is missing, not a string or the text is malformed.
+ * Escape sequences are left as they are.
+ */
+inline std::optional<std::string_view> topLevelString(std::string_view json,
+                                                      std::string_view key) {
+  using namespace prescan;
+  auto pos = skipSpace(json, 0);
+  if (pos >= json.size() || json[pos] != '{') {
+    return std::nullopt;
+  }
+  ++pos;
+  while (true) {
+    pos = skipSpace(json, pos);
+    if (pos >= json.size() || json[pos] != '"') {
+      return std::nullopt;
+    }
+    auto name_end = skipString(json, pos);
+    if (name_end == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto name = json.substr(pos + 1, name_end - pos - 2);
+    pos = skipSpace(json, name_end);
+    if (pos >= json.size() || json[pos] != ':') {
+      return std::nullopt;
+    }
+    pos = skipSpace(json, pos + 1);
+    if (name == key) {
+      if (pos >= json.size() || json[pos] != '"') {
+        return std::nullopt;
+      }
+      auto end = skipString(json, pos);
+      if (end == std::string_view::npos) {
+        return std::nullopt;
+      }
+      return json.substr(pos + 1, end - pos - 2);
+    }
+    pos = skipSpace(json, skipValue(json, pos));
+    if (pos >= json.size() || json[pos] != ',') {
+      return std::nullopt;
+    }
+    ++pos;
+  }
+}
+
+/* What a sway event means for the bar visibility, decided before any parsing */
+enum class BarEvent {
+  IGNORED,       // nothing the visibility depends on
+  ACTION,        // a binding ran or workspaces changed, the modifier was not pressed alone
+  URGENT,        // workspace urgency changed, needs the full payload
+  MODE_DEFAULT,  // back to the default binding mode
+  MODE_OTHER,    // another binding mode was entered
+  BAR_STATE,     // bar_state_update or barconfig_update for this bar, needs the full payload
+};
+
+inline BarEvent classifyBarEvent(uint32_t type, std::string_view payload,
+                                 std::string_view bar_id) {
+  switch (type) {
+    case IPC_EVENT_BINDING:
+      return BarEvent::ACTION;
+    case IPC_EVENT_WORKSPACE:
+      if (auto change = topLevelString(payload, "change")) {
+        return *change == "urgent" ? BarEvent::URGENT : BarEvent::ACTION;
+      }
+      return BarEvent::IGNORED;
+    case IPC_EVENT_MODE:
+      if (auto change = topLevelString(payload, "change")) {
+        return *change == "default" ? BarEvent::MODE_DEFAULT : BarEvent::MODE_OTHER;
+      }
+      return BarEvent::IGNORED;
+    case IPC_EVENT_BAR_STATE_UPDATE:
+    case IPC_EVENT_BARCONFIG_UPDATE: {
+      // an escaped id can't be compared raw, the full parse decides then
+      auto id = topLevelString(payload, "id");
+      if (id && id->find('\\') == std::string_view::npos && *id != bar_id) {
+        return BarEvent::IGNORED;
+      }
+      return BarEvent::BAR_STATE;
+    }
+    default:
+      return BarEvent::IGNORED;
+  }
+}
+
+}  // namespace waybar::modules::sway
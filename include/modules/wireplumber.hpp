@@ -30,7 +30,7 @@ class Wireplumber : public ALabel {
   static void onMixerChanged(waybar::modules::Wireplumber* self, uint32_t id);
   static void onDefaultNodesApiChanged(waybar::modules::Wireplumber* self);
 
-  bool handleScroll(GdkEventScroll* e) override;
+  void handleScrollSteps(SCROLL_DIR dir, unsigned steps) override;
 
   WpCore* wp_core_;
   GPtrArray* apis_;
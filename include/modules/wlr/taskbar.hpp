@@ -20,6 +20,7 @@
 #include "client.hpp"
 #include "giomm/desktopappinfo.h"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
 
 namespace waybar::modules::wlr {
@@ -40,6 +41,14 @@ class Task {
     FULLSCREEN = (1 << 3),
     INVALID = (1 << 4)
   };
+  enum FormatField {
+    FIELD_TITLE = (1 << 0),
+    FIELD_NAME = (1 << 1),
+    FIELD_APP_ID = (1 << 2),
+    FIELD_STATE = (1 << 3),
+    FIELD_SHORT_STATE = (1 << 4)
+  };
+  static uint32_t format_fields(const std::string &format);
   // made public so TaskBar can reorder based on configuration.
   Gtk::Button button;
 
@@ -70,6 +79,14 @@ class Task {
 
   std::string format_tooltip_;
 
+  /* Placeholders referenced by any of the formats, see FormatField */
+  uint32_t format_fields_ = 0;
+
+  /* Last strings handed to GTK, to skip relayouts when nothing changed */
+  std::string text_before_str_;
+  std::string text_after_str_;
+  std::string tooltip_str_;
+
   std::string name_;
   std::string title_;
   std::string app_id_;
@@ -149,6 +166,7 @@ class Taskbar : public waybar::AModule {
   std::vector<Glib::RefPtr<Gtk::IconTheme>> icon_themes_;
   std::unordered_set<std::string> ignore_list_;
   std::map<std::string, std::string> app_ids_replace_map_;
+  util::RewriteRules rewrite_rules_;
 
   struct zwlr_foreign_toplevel_manager_v1 *manager_;
   struct wl_seat *seat_;
@@ -174,6 +192,7 @@ class Taskbar : public waybar::AModule {
   const std::vector<Glib::RefPtr<Gtk::IconTheme>> &icon_themes() const;
   const std::unordered_set<std::string> &ignore_list() const;
   const std::map<std::string, std::string> &app_ids_replace_map() const;
+  const util::RewriteRules &rewrite_rules() const;
 };
 
 } /* namespace waybar::modules::wlr */
@@ -6,23 +6,65 @@
 #include <pulse/thread-mainloop.h>
 #include <pulse/volume.h>
 
+#include <pulse/subscribe.h>
+
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "util/backend_common.hpp"
 
 namespace waybar::util {
 
+// Fields of the tracked sink the modules render
+struct SinkState {
+  uint32_t index{0};
+  uint16_t volume{0};
+  bool muted{false};
+  std::string port_name;
+  std::string form_factor;
+  std::string desc;
+  std::string monitor;
+
+  static SinkState from(const pa_sink_info& info);
+  bool operator==(const SinkState&) const = default;
+};
+
+// Fields of the default source the modules render
+struct SourceState {
+  uint32_t index{0};
+  uint16_t volume{0};
+  bool muted{false};
+  std::string port_name;
+  std::string desc;
+
+  static SourceState from(const pa_source_info& info);
+  bool operator==(const SourceState&) const = default;
+};
+
+// Introspection request answering a subscription event
+enum class AudioQuery { None, Server, Sink, SinkInput, Source, SourceOutput };
+AudioQuery audioQueryFor(pa_subscription_event_type_t type);
+
+// Receives the introspection requests in place of PulseAudio, PA_INVALID_INDEX lists them all
+using AudioQueryHook = std::function<void(AudioQuery query, uint32_t idx)>;
+
 class AudioBackend {
  private:
   static void subscribeCb(pa_context*, pa_subscription_event_type_t, uint32_t, void*);
   static void contextStateCb(pa_context*, void*);
   static void sinkInfoCb(pa_context*, const pa_sink_info*, int, void*);
+  static void sinkInputInfoCb(pa_context*, const pa_sink_input_info*, int, void*);
   static void sourceInfoCb(pa_context*, const pa_source_info* i, int, void* data);
+  static void sourceOutputInfoCb(pa_context*, const pa_source_output_info*, int, void*);
   static void serverInfoCb(pa_context*, const pa_server_info*, void*);
   static void volumeModifyCb(pa_context*, int, void*);
   void connectContext();
+  void request(AudioQuery query, uint32_t idx = PA_INVALID_INDEX);
+  void notify();
 
   pa_threaded_mainloop* mainloop_;
   pa_mainloop_api* mainloop_api_;
@@ -30,26 +72,19 @@ class AudioBackend {
   pa_cvolume pa_volume_;
 
   // SINK
-  uint32_t sink_idx_{0};
-  uint16_t volume_;
-  bool muted_;
-  std::string port_name_;
-  std::string form_factor_;
-  std::string desc_;
-  std::string monitor_;
+  SinkState sink_;
   std::string current_sink_name_;
   bool current_sink_running_;
   // SOURCE
-  uint32_t source_idx_{0};
-  uint16_t source_volume_;
-  bool source_muted_;
-  std::string source_port_name_;
-  std::string source_desc_;
+  SourceState source_;
   std::string default_source_name_;
 
-  std::vector<std::string> ignored_sinks_;
+  const std::vector<std::string> ignored_sinks_;
+  const AudioQueryHook query_hook_;
 
-  std::function<void()> on_updated_cb_ = NOOP;
+  // called on the PulseAudio thread, guarded by the mainloop lock
+  std::map<uint64_t, std::function<void()>> listeners_;
+  uint64_t next_listener_{1};
 
   /* Hack to keep constructor inaccessible but still public.
    * This is required to be able to use std::make_shared.
@@ -60,28 +95,47 @@ class AudioBackend {
   struct private_constructor_tag {};
 
  public:
-  static std::shared_ptr<AudioBackend> getInstance(std::function<void()> on_updated_cb = NOOP);
+  // One PulseAudio client for all modules configured with the same ignored sinks
+  static std::shared_ptr<AudioBackend> getInstance(const Json::Value& ignored_sinks = {});
+
+  /* Backend without a PulseAudio connection, used by the tests.
+   * Requests go to query_hook, subscription events and the answers to the requests are passed
+   * in through replay() and run the same callbacks as with a server.
+   */
+  static std::shared_ptr<AudioBackend> create(std::vector<std::string> ignored_sinks,
+                                              AudioQueryHook query_hook);
 
-  AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag);
+  AudioBackend(std::vector<std::string> ignored_sinks, private_constructor_tag tag);
+  AudioBackend(std::vector<std::string> ignored_sinks, AudioQueryHook query_hook,
+               private_constructor_tag tag);
   ~AudioBackend();
 
+  void replay(pa_subscription_event_type_t type, uint32_t idx);
+  void replay(const pa_server_info& i);
+  void replay(const pa_sink_info& i);
+  void replay(const pa_sink_input_info& i);
+  void replay(const pa_source_info& i);
+  void replay(const pa_source_output_info& i);
+
+  // on_updated_cb runs on the PulseAudio thread when the tracked sink or source changed
+  uint64_t addListener(std::function<void()> on_updated_cb);
+  void removeListener(uint64_t id);
+
   void changeVolume(uint16_t volume, uint16_t min_volume = 0, uint16_t max_volume = 100);
   void changeVolume(ChangeType change_type, double step = 1, uint16_t max_volume = 100);
 
-  void setIgnoredSinks(const Json::Value& config);
-
-  std::string getSinkPortName() const { return port_name_; }
-  std::string getFormFactor() const { return form_factor_; }
-  std::string getSinkDesc() const { return desc_; }
-  std::string getMonitor() const { return monitor_; }
+  std::string getSinkPortName() const { return sink_.port_name; }
+  std::string getFormFactor() const { return sink_.form_factor; }
+  std::string getSinkDesc() const { return sink_.desc; }
+  std::string getMonitor() const { return sink_.monitor; }
   std::string getCurrentSinkName() const { return current_sink_name_; }
   bool getCurrentSinkRunning() const { return current_sink_running_; }
-  uint16_t getSinkVolume() const { return volume_; }
-  bool getSinkMuted() const { return muted_; }
-  uint16_t getSourceVolume() const { return source_volume_; }
-  bool getSourceMuted() const { return source_muted_; }
-  std::string getSourcePortName() const { return source_port_name_; }
-  std::string getSourceDesc() const { return source_desc_; }
+  uint16_t getSinkVolume() const { return sink_.volume; }
+  bool getSinkMuted() const { return sink_.muted; }
+  uint16_t getSourceVolume() const { return source_.volume; }
+  bool getSourceMuted() const { return source_.muted; }
+  std::string getSourcePortName() const { return source_.port_name; }
+  std::string getSourceDesc() const { return source_.desc; }
   std::string getDefaultSourceName() const { return default_source_name_; }
 
   void toggleSinkMute();
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace waybar::util {
+
+/*
+ * Process-wide registry of the children spawned by command::forkExec.
+ *
+ * Entries are dropped as soon as the child is reaped, so the registry only ever holds
+ * running (or not yet reaped) children. A pid stays reserved until it is reaped, which
+ * makes signalling the registered process groups safe from pid reuse.
+ */
+class ChildRegistry {
+ public:
+  using Owner = const void *;
+  // Runs on the reaping thread once the child has exited
+  using ExitCallback = std::function<void()>;
+
+  static ChildRegistry &inst();
+
+  ChildRegistry() = default;
+  ChildRegistry(const ChildRegistry &) = delete;
+  ChildRegistry &operator=(const ChildRegistry &) = delete;
+
+  // Reaps the child right away if it has already exited
+  void add(pid_t pid, Owner owner = nullptr, ExitCallback on_exit = {});
+
+  // Reap every registered child that has exited, called on SIGCHLD
+  void reap();
+
+  // SIGTERM the process groups of the owner's running children and stop tracking the owner
+  void terminate(Owner owner);
+
+  // True until the child has been reaped
+  bool contains(pid_t pid);
+
+  size_t size();
+  size_t size(Owner owner);
+
+ private:
+  struct Child {
+    Owner owner;
+    ExitCallback on_exit;
+  };
+
+  // Returns the exit callback of the child
+  ExitCallback erase(pid_t pid);
+
+  std::mutex mutex_;
+  std::unordered_map<pid_t, Child> children_;
+  std::unordered_map<Owner, std::unordered_set<pid_t>> owners_;
+};
+
+}  // namespace waybar::util
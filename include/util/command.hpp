@@ -14,9 +14,11 @@
 #endif
 
 #include <array>
+#include <string>
+#include <utility>
+#include <vector>
 
-extern std::mutex reap_mtx;
-extern std::list<pid_t> reap;
+#include "util/child_registry.hpp"
 
 namespace waybar::util::command {
 
@@ -138,7 +140,11 @@ inline struct res execNoRead(const std::string& cmd) {
   return {WEXITSTATUS(stat), ""};
 }
 
-inline int32_t forkExec(const std::string& cmd) {
+// The child is reaped by the signal thread; pass an owner to be able to terminate it later.
+// on_exit runs on the reaping thread once the child is gone.
+inline int32_t forkExec(const std::string& cmd, ChildRegistry::Owner owner = nullptr,
+                        const std::vector<std::pair<std::string, std::string>>& env = {},
+                        ChildRegistry::ExitCallback on_exit = {}) {
   if (cmd == "") return -1;
 
   pid_t pid = fork();
@@ -157,13 +163,13 @@ inline int32_t forkExec(const std::string& cmd) {
     err = pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
     if (err != 0) spdlog::error("pthread_sigmask in forkExec failed: {}", strerror(err));
     setpgid(pid, pid);
+    for (const auto& [name, value] : env) {
+      setenv(name.c_str(), value.c_str(), 1);
+    }
     execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)0);
     exit(0);
   } else {
-    reap_mtx.lock();
-    reap.push_back(pid);
-    reap_mtx.unlock();
-    spdlog::debug("Added child to reap list: {}", pid);
+    ChildRegistry::inst().add(pid, owner, std::move(on_exit));
   }
 
   return pid;
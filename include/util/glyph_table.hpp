@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace waybar::util {
+
+/*
+ * Turns a row of levels into text, one glyph per level.
+ *
+ * Glyphs are resolved once, each frame is appended into a buffer that keeps its capacity,
+ * and a frame equal to the previous one is reported as unchanged without being rebuilt.
+ */
+class GlyphTable {
+ public:
+  GlyphTable() = default;
+  // glyphs[i] is shown for level i, a non-zero delimiter follows every glyph
+  GlyphTable(const std::vector<std::string> &glyphs, char delimiter) {
+    entries_.reserve(glyphs.size());
+    for (const auto &glyph : glyphs) {
+      entries_.push_back(delimiter != 0 ? glyph + delimiter : glyph);
+    }
+  }
+
+  size_t size() const { return entries_.size(); }
+  const std::string &text() const { return buffer_; }
+
+  // Render a frame into text(), returns false if it matches the last one
+  bool render(const std::vector<int> &levels) {
+    if (rendered_ && levels == last_) {
+      return false;
+    }
+    rendered_ = true;
+    last_ = levels;
+    buffer_.clear();
+    if (entries_.empty()) {
+      return true;
+    }
+    const int top = static_cast<int>(entries_.size()) - 1;
+    for (auto level : levels) {
+      buffer_.append(entries_[std::clamp(level, 0, top)]);
+    }
+    return true;
+  }
+
+ private:
+  std::vector<std::string> entries_;
+  std::vector<int> last_;
+  std::string buffer_;
+  bool rendered_ = false;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <gio/gio.h>
+#include <sigc++/signal.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace waybar::util {
+
+/*
+ * Process-wide owner of the logind inhibitor locks.
+ * Locks are keyed by the set of inhibitors they cover, so modules with the same `what` on
+ * different bars share one lock. Inhibit is called asynchronously, the result is announced on
+ * signal_changed() from the GLib main loop.
+ */
+class LogindInhibitor : public std::enable_shared_from_this<LogindInhibitor> {
+ public:
+  // Uses the system bus on first use, later calls return the same instance
+  static std::shared_ptr<LogindInhibitor> getInstance();
+  // Instance talking to logind on a given connection, used by the tests
+  static std::shared_ptr<LogindInhibitor> create(GDBusConnection* bus);
+
+  LogindInhibitor(const LogindInhibitor&) = delete;
+  LogindInhibitor& operator=(const LogindInhibitor&) = delete;
+  ~LogindInhibitor();
+
+  // Sorted and deduplicated form of a `what` string, e.g. "sleep:idle:sleep" -> "idle:sleep"
+  static std::string normalize(const std::string& what);
+
+  bool active(const std::string& what) const;
+  bool pending(const std::string& what) const;
+
+  // Takes the lock if it is not held or requested, releases it otherwise
+  void toggle(const std::string& what);
+
+  sigc::signal<void(const std::string&)>& signal_changed() { return signal_changed_; }
+
+ private:
+  struct Lock {
+    int fd = -1;
+    bool wanted = false;
+    GCancellable* request = nullptr;  // set while an Inhibit call is in flight
+  };
+
+  explicit LogindInhibitor(GDBusConnection* bus);
+
+  void inhibit(const std::string& what);
+  void handleReply(const std::string& what, int fd);
+  void release(Lock& lock);
+
+  GDBusConnection* bus_;
+  std::map<std::string, Lock> locks_;
+  sigc::signal<void(const std::string&)> signal_changed_;
+};
+
+}  // namespace waybar::util
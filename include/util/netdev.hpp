@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace waybar::util {
+
+struct NetDevBytes {
+  unsigned long long down = 0;
+  unsigned long long up = 0;
+
+  NetDevBytes &operator+=(const NetDevBytes &other) {
+    down += other.down;
+    up += other.up;
+    return *this;
+  }
+  bool operator==(const NetDevBytes &) const = default;
+};
+
+using NetDevSnapshot = std::unordered_map<std::string, NetDevBytes>;
+
+/*
+ * Byte counters of every interface in the text of /proc/net/dev.
+ * Each line is "name: rx_bytes rx_packets ... tx_bytes ...", receive and transmit having eight
+ * columns each. Large counters can follow the colon without a space, so the name ends there.
+ */
+inline NetDevSnapshot parseNetDev(std::string_view text) {
+  NetDevSnapshot snapshot;
+  while (!text.empty()) {
+    auto eol = text.find('\n');
+    auto line = text.substr(0, eol);
+    text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;  // the two header lines
+    }
+    auto name = line.substr(0, colon);
+    name.remove_prefix(std::min(name.find_first_not_of(' '), name.size()));
+
+    // columns 0 and 8 are the received and transmitted bytes
+    unsigned long long columns[9] = {};
+    const char *pos = line.data() + colon + 1;
+    const char *end = line.data() + line.size();
+    int column = 0;
+    for (; column < 9; ++column) {
+      while (pos < end && *pos == ' ') {
+        ++pos;
+      }
+      auto [next, ec] = std::from_chars(pos, end, columns[column]);
+      if (ec != std::errc()) {
+        break;
+      }
+      pos = next;
+    }
+    if (column == 9 && !name.empty()) {
+      snapshot[std::string(name)] = {.down = columns[0], .up = columns[8]};
+    }
+  }
+  return snapshot;
+}
+
+inline NetDevSnapshot readNetDev(const char *path = "/proc/net/dev") {
+  std::ifstream file(path);
+  std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return parseNetDev(text);
+}
+
+/*
+ * Bytes every interface moved between the last two snapshots.
+ * One snapshot serves any number of interfaces. An interface seen for the first time moved
+ * nothing, counters that went backwards belong to a recreated interface and count from zero.
+ */
+class BandwidthMeter {
+ public:
+  void sample(NetDevSnapshot snapshot) {
+    moved_.clear();
+    for (const auto &[name, bytes] : snapshot) {
+      auto previous = previous_.find(name);
+      if (previous == previous_.end()) {
+        continue;
+      }
+      const auto &before = previous->second;
+      moved_[name] = {.down = bytes.down >= before.down ? bytes.down - before.down : bytes.down,
+                      .up = bytes.up >= before.up ? bytes.up - before.up : bytes.up};
+    }
+    previous_ = std::move(snapshot);
+  }
+
+  NetDevBytes moved(const std::string &ifname) const {
+    auto it = moved_.find(ifname);
+    return it != moved_.end() ? it->second : NetDevBytes{};
+  }
+
+ private:
+  NetDevSnapshot previous_;
+  NetDevSnapshot moved_;
+};
+
+}  // namespace waybar::util
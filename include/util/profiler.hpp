@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace waybar::util {
+
+/*
+ * Optional accounting of CPU time, wall time and heap allocations, enabled by --profile.
+ *
+ * Work is attributed to an account (a module instance or a backend thread) while a Scope for it
+ * is alive on the running thread. Nested scopes are exclusive, the outer account is charged only
+ * for the time and allocations outside the inner one. Allocations are counted by the global
+ * operator new, allocations made by C libraries through malloc are not seen.
+ */
+class Profiler {
+ public:
+  struct Account {
+    explicit Account(std::string name) : name(std::move(name)) {}
+
+    const std::string name;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> wall_ns{0};
+    std::atomic<uint64_t> cpu_ns{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+  };
+
+  struct Totals {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t wall_ns = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+  };
+
+  // Charges the account for the work done on this thread until destruction
+  class Scope {
+   public:
+    // wall = false for worker loops whose iterations include sleeping
+    explicit Scope(Account *account, bool wall = true);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Account *account_;
+    Scope *parent_ = nullptr;
+    bool wall_;
+    uint64_t wall_start_ = 0;
+    uint64_t cpu_start_ = 0;
+    uint64_t allocations_start_ = 0;
+    uint64_t bytes_start_ = 0;
+    // consumed by nested scopes, not charged to this one
+    uint64_t child_wall_ = 0;
+    uint64_t child_cpu_ = 0;
+    uint64_t child_allocations_ = 0;
+    uint64_t child_bytes_ = 0;
+  };
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  static void enable() { enabled_ = true; }
+
+  // Account with this name, created on first use and kept for the process lifetime.
+  // nullptr while profiling is disabled, scopes for it are then free.
+  static Account *account(const std::string &name);
+  // Account of the innermost scope on this thread, inherited by the threads it starts
+  static Account *current();
+
+  // Totals of every account, sorted by CPU time
+  static std::vector<Totals> snapshot();
+  // Per-account growth from `before` to `now`, accounts without CPU time or allocations dropped
+  static std::vector<Totals> difference(const std::vector<Totals> &now,
+                                        const std::vector<Totals> &before);
+  static std::string report(const std::vector<Totals> &totals);
+
+  // Operator new calls and bytes requested on this thread so far
+  static uint64_t threadAllocations();
+  static uint64_t threadAllocatedBytes();
+
+ private:
+  static inline std::atomic<bool> enabled_{false};
+};
+
+}  // namespace waybar::util
@@ -1,10 +1,29 @@
 #pragma once
 #include <json/json.h>
 
+#include <regex>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace waybar::util {
 std::string rewriteString(const std::string&, const Json::Value&);
 std::string rewriteStringOnce(const std::string& value, const Json::Value& rules,
                               bool& matched_any);
+
+/* The rules of a `rewrite` config object, compiled once.
+ * apply() gives the same result as rewriteString() without building a std::regex
+ * for every rule on every call.
+ */
+class RewriteRules {
+ public:
+  RewriteRules() = default;
+  explicit RewriteRules(const Json::Value& rules);
+
+  std::string apply(const std::string& value) const;
+  bool empty() const { return rules_.empty(); }
+
+ private:
+  std::vector<std::pair<std::regex, std::string>> rules_;
+};
 }  // namespace waybar::util
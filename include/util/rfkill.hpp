@@ -2,14 +2,59 @@
 
 #include <glibmm/iochannel.h>
 #include <linux/rfkill.h>
+#include <sigc++/connection.h>
 #include <sigc++/signal.h>
 #include <sigc++/trackable.h>
 
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+
 namespace waybar::util {
 
+/*
+ * Process-wide reader of /dev/rfkill.
+ * The device is read once and folded into a per-index table, the summary per type can be
+ * queried from any thread. Changes are announced per type from the GLib main loop.
+ */
+class RfkillMonitor : public sigc::trackable {
+ public:
+  // Opens /dev/rfkill on first use, later calls return the same instance
+  static std::shared_ptr<RfkillMonitor> getInstance();
+  // Monitor reading events from an already open fd and taking ownership of it, used by the tests
+  static std::shared_ptr<RfkillMonitor> create(int fd);
+
+  RfkillMonitor(const RfkillMonitor&) = delete;
+  RfkillMonitor& operator=(const RfkillMonitor&) = delete;
+  ~RfkillMonitor();
+
+  // True when there is at least one device of the type and all of them are blocked
+  bool blocked(enum rfkill_type type) const;
+  size_t devices(enum rfkill_type type) const;
+
+  sigc::signal<void(const struct rfkill_event&)>& signal_changed(enum rfkill_type type);
+
+ private:
+  explicit RfkillMonitor(int fd);
+
+  bool on_event(Glib::IOCondition cond);
+  void handleEvent(const struct rfkill_event& event);
+  void updateSummary(uint8_t type);
+
+  int fd_;
+  sigc::connection watch_;
+  std::map<uint32_t, struct rfkill_event> devices_;
+  std::array<std::atomic<size_t>, NUM_RFKILL_TYPES> count_{};
+  std::array<std::atomic<bool>, NUM_RFKILL_TYPES> blocked_{};
+  std::array<sigc::signal<void(const struct rfkill_event&)>, NUM_RFKILL_TYPES> signals_;
+};
+
+// Subscription of one module to the devices of one type
 class Rfkill : public sigc::trackable {
  public:
   Rfkill(enum rfkill_type rfkill_type);
+  Rfkill(enum rfkill_type rfkill_type, std::shared_ptr<RfkillMonitor> monitor);
   ~Rfkill();
   bool getState() const;
 
@@ -17,10 +62,8 @@ class Rfkill : public sigc::trackable {
 
  private:
   enum rfkill_type rfkill_type_;
-  bool state_ = false;
-  int fd_ = -1;
-
-  bool on_event(Glib::IOCondition cond);
+  std::shared_ptr<RfkillMonitor> monitor_;
+  sigc::connection connection_;
 };
 
 }  // namespace waybar::util
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cmath>
+#include <optional>
+
+namespace waybar::util {
+
+/*
+ * Collects the scroll steps of one frame so a burst from a smooth-scrolling touchpad
+ * is handled once, with its step count, instead of once per threshold crossing.
+ *
+ * Steps are counted per direction: a step in a different direction closes the running
+ * burst, keeping the order of opposite scrolls intact.
+ */
+template <typename Dir>
+class ScrollBurst {
+ public:
+  struct Burst {
+    Dir dir;
+    unsigned steps;
+
+    bool operator==(const Burst &) const = default;
+  };
+
+  // Add steps; returns the previous burst if it has to be handled first
+  std::optional<Burst> add(Dir dir, unsigned steps = 1) {
+    std::optional<Burst> done;
+    if (pending_ && pending_->dir != dir) {
+      done = take();
+    }
+    if (pending_) {
+      pending_->steps += steps;
+    } else {
+      pending_ = Burst{dir, steps};
+    }
+    return done;
+  }
+
+  // End of frame: returns the running burst, if any
+  std::optional<Burst> take() {
+    auto burst = pending_;
+    pending_.reset();
+    return burst;
+  }
+
+  bool empty() const { return !pending_; }
+
+ private:
+  std::optional<Burst> pending_;
+};
+
+/*
+ * Smooth scroll distance along one axis.
+ * A step is taken each time the distance goes past the threshold, reaching it exactly is not
+ * enough. The remainder carries over to the next event, so a large delta gives several steps.
+ * With a threshold of 0 any distance is one step.
+ */
+class ScrollDistance {
+ public:
+  void add(double delta) { distance_ += delta; }
+
+  // Steps scrolled so far, negative towards up or left
+  int take(double threshold) {
+    if (threshold <= 0) {
+      int steps = distance_ < 0 ? -1 : distance_ > 0 ? 1 : 0;
+      distance_ = 0;
+      return steps;
+    }
+    auto steps = std::ceil(std::abs(distance_) / threshold) - 1;
+    if (steps <= 0) {
+      return 0;
+    }
+    steps = std::copysign(steps, distance_);
+    distance_ -= steps * threshold;
+    return static_cast<int>(steps);
+  }
+
+ private:
+  double distance_ = 0;
+};
+
+}  // namespace waybar::util
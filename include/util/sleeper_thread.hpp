@@ -4,9 +4,11 @@
 #include <condition_variable>
 #include <ctime>
 #include <functional>
-#include <thread>
+#include <mutex>
 
 #include "prepare_for_sleep.h"
+#include "util/profiler.hpp"
+#include "util/thread.hpp"
 
 namespace waybar::util {
 
@@ -30,9 +32,10 @@ class SleeperThread {
   SleeperThread() = default;
 
   SleeperThread(std::function<void()> func)
-      : thread_{[this, func] {
+      : thread_{Thread::owner(), [this, func, account = Profiler::current()] {
           while (do_run_) {
             signal_ = false;
+            Profiler::Scope scope(account, false);
             func();
           }
         }} {
@@ -42,9 +45,11 @@ class SleeperThread {
   }
 
   SleeperThread& operator=(std::function<void()> func) {
-    thread_ = std::thread([this, func] {
+    // iterations are charged to the module or backend that started the thread
+    thread_ = Thread(Thread::owner(), [this, func, account = Profiler::current()] {
       while (do_run_) {
         signal_ = false;
+        Profiler::Scope scope(account, false);
         func();
       }
     });
@@ -115,7 +120,7 @@ class SleeperThread {
   }
 
  private:
-  std::thread thread_;
+  Thread thread_;
   std::condition_variable condvar_;
   std::mutex mutex_;
   bool do_run_ = true;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace waybar::util {
+
+/* Single-pass text kernel for labels.
+ *
+ * Widths are terminal-style columns: wide (CJK, most emoji) characters count as two,
+ * zero-width characters (combining marks, ZWJ, soft hyphen) count as zero.
+ * Runs of plain ASCII are handled eight bytes at a time.
+ */
+struct TextOptions {
+  // escape <>&"' and control characters for Pango markup
+  bool escape = false;
+  // truncate to this many columns, std::string::npos for no limit
+  size_t max_width = std::string::npos;
+  // appended when the text was truncated, counted in max_width
+  std::string_view ellipsis = "…";
+};
+
+struct Text {
+  std::string str;
+  size_t width = 0;  // display width of str
+  bool truncated = false;
+};
+
+// Escape, measure and truncate in one pass over the input
+Text process_text(std::string_view str, const TextOptions& options = {});
+
+// Equivalent to g_markup_escape_text
+std::string escape_markup(std::string_view str);
+
+size_t text_width(std::string_view str);
+
+// Truncate to max_width columns (including the ellipsis), returns the resulting width
+size_t truncate_text(std::string& str, size_t max_width, std::string_view ellipsis = "…");
+
+}  // namespace waybar::util
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace waybar::util {
+
+/*
+ * std::thread replacement with a name visible in top, ps and gdb.
+ *
+ * Threads get the system's default stack unless told otherwise: module workers run user
+ * regexes, and std::regex recurses once per character. Threads that only shuffle bytes over a
+ * socket can ask for SHALLOW_STACK_SIZE instead of the 8 MiB glibc reserves.
+ * Live threads are counted per name for the thread report.
+ */
+class Thread {
+ public:
+  // keep the default stack size of the process
+  static constexpr size_t DEFAULT_STACK_SIZE = 0;
+  // for threads known to stay shallow
+  static constexpr size_t SHALLOW_STACK_SIZE = 512 * 1024;
+
+  Thread() = default;
+  // Names longer than 15 bytes are truncated by the kernel, the report keeps the full name
+  Thread(std::string name, std::function<void()> func, size_t stack_size = DEFAULT_STACK_SIZE);
+  Thread(Thread&& other) noexcept;
+  // Like std::thread, replacing or destroying a joinable thread terminates the process
+  Thread& operator=(Thread&& other) noexcept;
+  ~Thread();
+
+  bool joinable() const { return handle_ != 0; }
+  void join();
+  void detach();
+  pthread_t native_handle() const { return handle_; }
+
+  // Name for threads started on this thread, set while a module or backend is constructed
+  static const std::string& owner();
+  class Owner {
+   public:
+    explicit Owner(std::string name);
+    ~Owner();
+    Owner(const Owner&) = delete;
+    Owner& operator=(const Owner&) = delete;
+
+   private:
+    std::string previous_;
+  };
+
+  // Live threads per name
+  static std::map<std::string, size_t> census();
+  // One line summary of census(), busiest names first
+  static std::string report();
+
+ private:
+  pthread_t handle_ = 0;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+namespace waybar::util {
+
+/*
+ * Decides when a module's on-update hook runs.
+ *
+ * The hook runs only for output that differs from what it was last given, at most one
+ * invocation is in flight, and consecutive runs are at least min_interval apart. Output
+ * produced while the hook is held back replaces the pending output, so a burst of updates
+ * ends in a single run with the latest state.
+ */
+class UpdateHook {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Output {
+    std::string text;
+    std::string classes;
+    // false for modules without a single label, their text and classes are not passed on
+    bool rendered = true;
+
+    bool operator==(const Output &) const = default;
+  };
+
+  explicit UpdateHook(Clock::duration min_interval = {}) : min_interval_(min_interval) {}
+
+  // Record freshly rendered output, returns false if it matches the last one
+  bool update(Output output) {
+    if (delivered_ && *delivered_ == output) {
+      // changed back before the hook could run
+      pending_.reset();
+      return false;
+    }
+    if (pending_ && *pending_ == output) {
+      return false;
+    }
+    pending_ = std::move(output);
+    return true;
+  }
+
+  // Modules without a comparable output: run the hook for every update
+  void touch() {
+    if (!pending_) {
+      pending_ = Output{"", "", false};
+    }
+  }
+
+  // Time to wait before the pending output can be delivered, nullopt when there is none
+  std::optional<Clock::duration> due(Clock::time_point now) const {
+    if (!pending_) {
+      return std::nullopt;
+    }
+    if (last_run_ && now < *last_run_ + min_interval_) {
+      return *last_run_ + min_interval_ - now;
+    }
+    return Clock::duration::zero();
+  }
+
+  // Hand the pending output to a new invocation
+  Output start(Clock::time_point now) {
+    delivered_ = std::move(pending_);
+    pending_.reset();
+    last_run_ = now;
+    return *delivered_;
+  }
+
+ private:
+  Clock::duration min_interval_;
+  std::optional<Output> pending_;
+  std::optional<Output> delivered_;
+  std::optional<Clock::time_point> last_run_;
+};
+
+}  // namespace waybar::util
@@ -1,8 +1,18 @@
 
+#include <string.h>
+
 #include "waybar_cffi_module.h"
 
+// State shared by the module instances of all bars
 typedef struct {
+  const wbcffi_init_info* init_info;
   wbcffi_module* waybar_module;
+  int dice;
+} ExampleShared;
+
+typedef struct {
+  wbcffi_module* waybar_module;
+  ExampleShared* shared;
   GtkBox* container;
   GtkButton* button;
 } ExampleMod;
@@ -10,14 +20,53 @@ typedef struct {
 // This static variable is shared between all instances of this module
 static int instance_count = 0;
 
-void onclicked(GtkButton* button) {
-  char text[256];
-  snprintf(text, 256, "Dice throw result: %d", rand() % 6 + 1);
-  gtk_button_set_label(button, text);
+static void roll(ExampleShared* shared) {
+  shared->dice = rand() % 6 + 1;
+  // Updates every bar showing the module
+  shared->init_info->queue_update(shared->waybar_module);
+}
+
+static bool ontimer(void* user_data) {
+  roll(user_data);
+  return true;
+}
+
+void onclicked(GtkButton* button, ExampleMod* inst) { roll(inst->shared); }
+
+// Reads an unsigned integer from the top level of the module config
+static uint64_t config_uint(const wbcffi_config_node* config, const char* key, uint64_t def) {
+  for (size_t i = 0; i < config->as.children.len; i++) {
+    const wbcffi_config_node* node = &config->as.children.items[i];
+    if (strcmp(node->key, key) == 0 && node->type == WBCFFI_CONFIG_UINT) {
+      return node->as.uinteger;
+    }
+  }
+  return def;
 }
 
 // You must
-const size_t wbcffi_version = 1;
+const size_t wbcffi_version = 2;
+
+void* wbcffi_shared_init(const wbcffi_init_info* init_info) {
+  ExampleShared* shared = malloc(sizeof(ExampleShared));
+  // init_info stays valid until wbcffi_shared_deinit
+  shared->init_info = init_info;
+  shared->waybar_module = init_info->obj;
+  shared->dice = 1;
+
+  // Roll the dice on the Waybar main loop, no thread needed
+  uint64_t interval = config_uint(init_info->config, "interval", 5);
+  init_info->add_timer(init_info->obj, interval * 1000, ontimer, shared);
+
+  printf("cffi_example shared=%p: init success !\n", shared);
+  return shared;
+}
+
+void wbcffi_shared_deinit(void* shared) {
+  // The timer is removed by Waybar
+  printf("cffi_example shared=%p: free memory\n", shared);
+  free(shared);
+}
 
 void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry* config_entries,
                   size_t config_entries_len) {
@@ -29,6 +78,7 @@ void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry*
   // Allocate the instance object
   ExampleMod* inst = malloc(sizeof(ExampleMod));
   inst->waybar_module = init_info->obj;
+  inst->shared = init_info->shared;
 
   GtkContainer* root = init_info->get_root_widget(init_info->obj);
 
@@ -42,7 +92,7 @@ void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry*
 
   // Add a button
   inst->button = GTK_BUTTON(gtk_button_new_with_label("click me !"));
-  g_signal_connect(inst->button, "clicked", G_CALLBACK(onclicked), NULL);
+  g_signal_connect(inst->button, "clicked", G_CALLBACK(onclicked), inst);
   gtk_container_add(GTK_CONTAINER(inst->container), GTK_WIDGET(inst->button));
 
   // Add a label
@@ -59,7 +109,12 @@ void wbcffi_deinit(void* instance) {
   free(instance);
 }
 
-void wbcffi_update(void* instance) { printf("cffi_example inst=%p: Update request\n", instance); }
+void wbcffi_update(void* instance) {
+  ExampleMod* inst = instance;
+  char text[256];
+  snprintf(text, 256, "Dice throw result: %d", inst->shared->dice);
+  gtk_button_set_label(inst->button, text);
+}
 
 void wbcffi_refresh(void* instance, int signal) {
   printf("cffi_example inst=%p: Received refresh signal %d\n", instance, signal);
@@ -67,4 +122,4 @@ void wbcffi_refresh(void* instance, int signal) {
 
 void wbcffi_doaction(void* instance, const char* name) {
   printf("cffi_example inst=%p: doAction(%s)\n", instance, name);
-}
\ No newline at end of file
+}
@@ -1,18 +1,75 @@
 #pragma once
 
 #include <gtk/gtk.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/// Waybar ABI version. 1 is the latest version
+/// Waybar ABI version. 2 is the latest version, 1 is still supported
 extern const size_t wbcffi_version;
 
 /// Private Waybar CFFI module
 typedef struct wbcffi_module wbcffi_module;
 
+/// Type of a config node
+typedef enum {
+  WBCFFI_CONFIG_NULL,
+  WBCFFI_CONFIG_BOOL,
+  WBCFFI_CONFIG_INT,
+  WBCFFI_CONFIG_UINT,
+  WBCFFI_CONFIG_DOUBLE,
+  WBCFFI_CONFIG_STRING,
+  WBCFFI_CONFIG_ARRAY,
+  WBCFFI_CONFIG_OBJECT,
+} wbcffi_config_type;
+
+/// Parsed module JSON config (ABI version 2)
+typedef struct wbcffi_config_node wbcffi_config_node;
+struct wbcffi_config_node {
+  /// Node type, selects the member of `as`
+  wbcffi_config_type type;
+  /// Member name if the parent node is an object, NULL otherwise
+  const char* key;
+  union {
+    bool boolean;
+    int64_t integer;
+    uint64_t uinteger;
+    double real;
+    const char* string;
+    /// Elements of an array or members of an object, in config order
+    struct {
+      const wbcffi_config_node* items;
+      size_t len;
+    } children;
+  } as;
+};
+
+/// Event source registered on the Waybar main loop, 0 is never a valid source
+typedef uint64_t wbcffi_source;
+
+/// File descriptor events
+enum {
+  WBCFFI_FD_READABLE = 1 << 0,
+  WBCFFI_FD_WRITABLE = 1 << 1,
+  /// Hang up or error, always reported
+  WBCFFI_FD_HANGUP = 1 << 2,
+};
+
+/// Called from the GTK main event loop when the file descriptor is ready
+/// @param user_data Pointer given to add_fd()
+/// @param fd        Watched file descriptor
+/// @param events    WBCFFI_FD_* flags that are set
+/// @return false to remove the source
+typedef bool (*wbcffi_fd_callback)(void* user_data, int fd, uint32_t events);
+
+/// Called from the GTK main event loop when the timer expires
+/// @param user_data Pointer given to add_timer()
+/// @return false to remove the source
+typedef bool (*wbcffi_timer_callback)(void* user_data);
+
 /// Waybar module information
 typedef struct {
   /// Waybar CFFI object pointer
@@ -29,6 +86,40 @@ typedef struct {
   /// loop iteration
   /// @param obj Waybar CFFI object pointer
   void (*queue_update)(wbcffi_module*);
+
+  /* The following members are only available with ABI version 2. From this version on, the
+   * wbcffi_init_info structure itself stays valid until the module is deinitialized. */
+
+  /// Parsed module JSON config. Valid until wbcffi_deinit() or wbcffi_shared_deinit() returns.
+  const wbcffi_config_node* config;
+
+  /// Instance returned by wbcffi_shared_init(), NULL if the module does not export it
+  void* shared;
+
+  /// Watches a file descriptor on the GTK main event loop
+  /// @param obj       Waybar CFFI object pointer
+  /// @param fd        File descriptor to watch, not closed by Waybar
+  /// @param events    WBCFFI_FD_* flags to watch for
+  /// @param callback  Called on events, on the GTK main thread
+  /// @param user_data Passed to `callback`
+  /// @return The source ID
+  wbcffi_source (*add_fd)(wbcffi_module* obj, int fd, uint32_t events,
+                          wbcffi_fd_callback callback, void* user_data);
+
+  /// Runs a callback periodically on the GTK main event loop
+  /// @param obj         Waybar CFFI object pointer
+  /// @param interval_ms Interval in milliseconds
+  /// @param callback    Called on expiry, on the GTK main thread
+  /// @param user_data   Passed to `callback`
+  /// @return The source ID
+  wbcffi_source (*add_timer)(wbcffi_module* obj, uint32_t interval_ms,
+                             wbcffi_timer_callback callback, void* user_data);
+
+  /// Removes a file descriptor watch or timer. Sources still registered when the module is
+  /// deinitialized are removed by Waybar.
+  /// @param obj    Waybar CFFI object pointer
+  /// @param source Source ID returned by add_fd() or add_timer()
+  void (*remove_source)(wbcffi_module* obj, wbcffi_source source);
 } wbcffi_init_info;
 
 /// Config key-value pair
@@ -48,10 +139,33 @@ typedef struct {
 ///                           during wbcffi_init call.
 /// @param config_entries_len Number of entries in `config_entries`
 ///
+/// With ABI version 2, `init_info->config` holds the same config as a parsed tree.
+///
 /// @return A untyped pointer to module data, NULL if the module failed to load.
 void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry* config_entries,
                   size_t config_entries_len);
 
+/// Shared backend init function, called once before the first wbcffi_init() of all the modules
+/// created from the same config, i.e. the same module shown on several outputs. The returned
+/// pointer is given to these modules in `init_info->shared`.
+///
+/// `init_info->get_root_widget` returns NULL for the shared backend and
+/// `init_info->queue_update` requests an update of every module using it.
+///
+/// Optional CFFI function (ABI version 2), must be exported together with wbcffi_shared_deinit
+///
+/// @param init_info Waybar module information
+///
+/// @return A untyped pointer to the backend data, NULL if the backend failed to load.
+void* wbcffi_shared_init(const wbcffi_init_info* init_info);
+
+/// Shared backend deinit function, called after the last module using it was deinitialized
+///
+/// Optional CFFI function (ABI version 2)
+///
+/// @param shared Backend data (as returned by `wbcffi_shared_init`)
+void wbcffi_shared_deinit(void* shared);
+
 /// Module deinit/delete function, called when Waybar is closed or when the module is removed
 ///
 /// MANDATORY CFFI function
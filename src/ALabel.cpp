@@ -66,49 +66,52 @@ ALabel::ALabel(const Json::Value& config, const std::string& name, const std::st
 auto ALabel::update() -> void { AModule::update(); }
 
 std::string ALabel::getIcon(uint16_t percentage, const std::string& alt, uint16_t max) {
-  auto format_icons = config_["format-icons"];
-  if (format_icons.isObject()) {
-    if (!alt.empty() && (format_icons[alt].isString() || format_icons[alt].isArray())) {
-      format_icons = format_icons[alt];
+  // walk the config through a pointer, format-icons can be a large array
+  const Json::Value* format_icons = &config_["format-icons"];
+  if (format_icons->isObject()) {
+    const auto& alt_icons = (*format_icons)[alt];
+    if (!alt.empty() && (alt_icons.isString() || alt_icons.isArray())) {
+      format_icons = &alt_icons;
     } else {
-      format_icons = format_icons["default"];
+      format_icons = &(*format_icons)["default"];
     }
   }
-  if (format_icons.isArray()) {
-    auto size = format_icons.size();
+  if (format_icons->isArray()) {
+    auto size = format_icons->size();
     if (size) {
       auto idx = std::clamp(percentage / ((max == 0 ? 100 : max) / size), 0U, size - 1);
-      format_icons = format_icons[idx];
+      format_icons = &(*format_icons)[idx];
     }
   }
-  if (format_icons.isString()) {
-    return format_icons.asString();
+  if (format_icons->isString()) {
+    return format_icons->asString();
   }
   return "";
 }
 
 std::string ALabel::getIcon(uint16_t percentage, const std::vector<std::string>& alts,
                             uint16_t max) {
-  auto format_icons = config_["format-icons"];
-  if (format_icons.isObject()) {
+  const Json::Value* format_icons = &config_["format-icons"];
+  if (format_icons->isObject()) {
     std::string _alt = "default";
     for (const auto& alt : alts) {
-      if (!alt.empty() && (format_icons[alt].isString() || format_icons[alt].isArray())) {
+      const auto& alt_icons = (*format_icons)[alt];
+      if (!alt.empty() && (alt_icons.isString() || alt_icons.isArray())) {
         _alt = alt;
         break;
       }
     }
-    format_icons = format_icons[_alt];
+    format_icons = &(*format_icons)[_alt];
   }
-  if (format_icons.isArray()) {
-    auto size = format_icons.size();
+  if (format_icons->isArray()) {
+    auto size = format_icons->size();
     if (size) {
       auto idx = std::clamp(percentage / ((max == 0 ? 100 : max) / size), 0U, size - 1);
-      format_icons = format_icons[idx];
+      format_icons = &(*format_icons)[idx];
     }
   }
-  if (format_icons.isString()) {
-    return format_icons.asString();
+  if (format_icons->isString()) {
+    return format_icons->asString();
   }
   return "";
 }
@@ -1,18 +1,22 @@
 #include "AModule.hpp"
 
 #include <fmt/format.h>
+#include <glibmm/main.h>
+
+#include <algorithm>
 
 #include <util/command.hpp>
 
 namespace waybar {
 
+// milliseconds smooth scroll steps are collected for, one frame at 60 Hz
+static const unsigned SCROLL_FLUSH_INTERVAL = 16;
+
 AModule::AModule(const Json::Value& config, const std::string& name, const std::string& id,
                  bool enable_click, bool enable_scroll)
     : name_(std::move(name)),
       config_(std::move(config)),
-      isTooltip{config_["tooltip"].isBool() ? config_["tooltip"].asBool() : true},
-      distance_scrolled_y_(0.0),
-      distance_scrolled_x_(0.0) {
+      isTooltip{config_["tooltip"].isBool() ? config_["tooltip"].asBool() : true} {
   // Configure module action Map
   const Json::Value actions{config_["actions"]};
 
@@ -58,6 +62,11 @@ AModule::AModule(const Json::Value& config, const std::string& name, const std::
     event_box_.add_events(Gdk::BUTTON_RELEASE_MASK);
     event_box_.signal_button_release_event().connect(sigc::mem_fun(*this, &AModule::handleRelease));
   }
+  if (config_["on-update-interval"].isNumeric()) {
+    update_hook_ = util::UpdateHook(std::chrono::duration_cast<util::UpdateHook::Clock::duration>(
+        std::chrono::duration<double>(config_["on-update-interval"].asDouble())));
+  }
+
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString() ||
       config_["on-scroll-left"].isString() || config_["on-scroll-right"].isString() ||
       enable_scroll) {
@@ -67,17 +76,80 @@ AModule::AModule(const Json::Value& config, const std::string& name, const std::
 }
 
 AModule::~AModule() {
-  for (const auto& pid : pid_) {
-    if (pid != -1) {
-      killpg(pid, SIGTERM);
-    }
-  }
+  scroll_flush_.disconnect();
+  update_hook_timer_.disconnect();
+  util::ChildRegistry::inst().terminate(this);
 }
 
 auto AModule::update() -> void {
   // Run user-provided update handler if configured
-  if (config_["on-update"].isString()) {
-    pid_.push_back(util::command::forkExec(config_["on-update"].asString()));
+  if (!config_["on-update"].isString()) {
+    return;
+  }
+  if (auto text = getRenderedText()) {
+    if (!update_hook_.update({std::move(*text), getRenderedClasses()})) {
+      return;
+    }
+  } else {
+    update_hook_.touch();
+  }
+  scheduleUpdateHook();
+}
+
+std::string AModule::getRenderedClasses() {
+  auto* widget = event_box_.get_child() != nullptr ? event_box_.get_child() : &event_box_;
+  GList* list = gtk_style_context_list_classes(widget->get_style_context()->gobj());
+  std::vector<std::string> classes;
+  for (GList* it = list; it != nullptr; it = it->next) {
+    classes.emplace_back(static_cast<const char*>(it->data));
+  }
+  g_list_free(list);
+  std::sort(classes.begin(), classes.end());
+  std::string res;
+  for (const auto& name : classes) {
+    if (!res.empty()) {
+      res += ' ';
+    }
+    res += name;
+  }
+  return res;
+}
+
+void AModule::scheduleUpdateHook() {
+  if (update_hook_timer_.connected()) {
+    return;
+  }
+  auto now = util::UpdateHook::Clock::now();
+  auto due = update_hook_.due(now);
+  if (!due) {
+    return;
+  }
+  // at most one invocation at a time, check again once the running one is reaped
+  if (*update_hook_running_) {
+    due = std::max<util::UpdateHook::Clock::duration>(*due, std::chrono::milliseconds(50));
+  }
+  if (*due > util::UpdateHook::Clock::duration::zero()) {
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(*due).count();
+    update_hook_timer_ = Glib::signal_timeout().connect(
+        [this] {
+          update_hook_timer_.disconnect();
+          scheduleUpdateHook();
+          return false;
+        },
+        ms);
+    return;
+  }
+
+  auto output = update_hook_.start(now);
+  std::vector<std::pair<std::string, std::string>> env;
+  if (output.rendered) {
+    env = {{"WAYBAR_UPDATE_TEXT", output.text}, {"WAYBAR_UPDATE_CLASS", output.classes}};
+  }
+  *update_hook_running_ = true;
+  auto pid = util::command::forkExec(config_["on-update"].asString(), this, env,
+                                     [running = update_hook_running_] { *running = false; });
+  if (pid <= 0) {
+    *update_hook_running_ = false;
   }
 }
 // Get mapping between event name and module action name
@@ -141,13 +213,15 @@ bool AModule::handleUserEvent(GdkEventButton* const& e) {
       format.clear();
   }
   if (!format.empty()) {
-    pid_.push_back(util::command::forkExec(format));
+    util::command::forkExec(format, this);
   }
   dp.emit();
   return true;
 }
 
-AModule::SCROLL_DIR AModule::getScrollDir(GdkEventScroll* e) {
+AModule::SCROLL_DIR AModule::getScrollDir(GdkEventScroll* e) { return getScrollSteps(e).first; }
+
+std::pair<AModule::SCROLL_DIR, unsigned> AModule::getScrollSteps(GdkEventScroll* e) {
   // only affects up/down
   bool reverse = config_["reverse-scrolling"].asBool();
   bool reverse_mouse = config_["reverse-mouse-scrolling"].asBool();
@@ -160,57 +234,78 @@ AModule::SCROLL_DIR AModule::getScrollDir(GdkEventScroll* e) {
 
   switch (e->direction) {
     case GDK_SCROLL_UP:
-      return reverse ? SCROLL_DIR::DOWN : SCROLL_DIR::UP;
+      return {reverse ? SCROLL_DIR::DOWN : SCROLL_DIR::UP, 1};
     case GDK_SCROLL_DOWN:
-      return reverse ? SCROLL_DIR::UP : SCROLL_DIR::DOWN;
+      return {reverse ? SCROLL_DIR::UP : SCROLL_DIR::DOWN, 1};
     case GDK_SCROLL_LEFT:
-      return SCROLL_DIR::LEFT;
+      return {SCROLL_DIR::LEFT, 1};
     case GDK_SCROLL_RIGHT:
-      return SCROLL_DIR::RIGHT;
+      return {SCROLL_DIR::RIGHT, 1};
     case GDK_SCROLL_SMOOTH: {
-      SCROLL_DIR dir{SCROLL_DIR::NONE};
-
-      distance_scrolled_y_ += e->delta_y;
-      distance_scrolled_x_ += e->delta_x;
+      distance_scrolled_y_.add(e->delta_y);
+      distance_scrolled_x_.add(e->delta_x);
 
       gdouble threshold = 0;
       if (config_["smooth-scrolling-threshold"].isNumeric()) {
         threshold = config_["smooth-scrolling-threshold"].asDouble();
       }
 
-      if (distance_scrolled_y_ < -threshold) {
-        dir = reverse ? SCROLL_DIR::DOWN : SCROLL_DIR::UP;
-      } else if (distance_scrolled_y_ > threshold) {
-        dir = reverse ? SCROLL_DIR::UP : SCROLL_DIR::DOWN;
-      } else if (distance_scrolled_x_ > threshold) {
-        dir = SCROLL_DIR::RIGHT;
-      } else if (distance_scrolled_x_ < -threshold) {
-        dir = SCROLL_DIR::LEFT;
+      // vertical steps first, the horizontal distance is kept for a later event
+      if (int steps = distance_scrolled_y_.take(threshold); steps < 0) {
+        return {reverse ? SCROLL_DIR::DOWN : SCROLL_DIR::UP, static_cast<unsigned>(-steps)};
+      } else if (steps > 0) {
+        return {reverse ? SCROLL_DIR::UP : SCROLL_DIR::DOWN, static_cast<unsigned>(steps)};
       }
-
-      switch (dir) {
-        case SCROLL_DIR::UP:
-        case SCROLL_DIR::DOWN:
-          distance_scrolled_y_ = 0;
-          break;
-        case SCROLL_DIR::LEFT:
-        case SCROLL_DIR::RIGHT:
-          distance_scrolled_x_ = 0;
-          break;
-        case SCROLL_DIR::NONE:
-          break;
+      if (int steps = distance_scrolled_x_.take(threshold); steps < 0) {
+        return {SCROLL_DIR::LEFT, static_cast<unsigned>(-steps)};
+      } else if (steps > 0) {
+        return {SCROLL_DIR::RIGHT, static_cast<unsigned>(steps)};
       }
-
-      return dir;
+      return {SCROLL_DIR::NONE, 0};
     }
     // Silence -Wreturn-type:
     default:
-      return SCROLL_DIR::NONE;
+      return {SCROLL_DIR::NONE, 0};
   }
 }
 
 bool AModule::handleScroll(GdkEventScroll* e) {
-  auto dir = getScrollDir(e);
+  auto [dir, steps] = getScrollSteps(e);
+  if (dir == SCROLL_DIR::NONE) {
+    return true;
+  }
+
+  // a wheel click is a step of its own, only smooth deltas are worth coalescing
+  if (e->direction != GDK_SCROLL_SMOOTH) {
+    scroll_flush_.disconnect();
+    flushScroll();
+    handleScrollSteps(dir, steps);
+    return true;
+  }
+
+  if (auto burst = scroll_burst_.add(dir, steps)) {
+    handleScrollSteps(burst->dir, burst->steps);
+  }
+  // Handle the burst a frame after its first step. Input events of a flick arrive spread over
+  // the frame, the main loop goes idle between them
+  if (!scroll_flush_.connected()) {
+    scroll_flush_ = Glib::signal_timeout().connect(
+        [this] {
+          flushScroll();
+          return false;
+        },
+        SCROLL_FLUSH_INTERVAL);
+  }
+  return true;
+}
+
+void AModule::flushScroll() {
+  if (auto burst = scroll_burst_.take()) {
+    handleScrollSteps(burst->dir, burst->steps);
+  }
+}
+
+void AModule::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
   std::string eventName{};
 
   if (dir == SCROLL_DIR::UP)
@@ -223,13 +318,15 @@ bool AModule::handleScroll(GdkEventScroll* e) {
     eventName = "on-scroll-right";
 
   // First call module actions
-  this->AModule::doAction(eventName);
-  // Second call user scripts
+  for (unsigned i = 0; i < steps; ++i) {
+    this->AModule::doAction(eventName);
+  }
+  // Second call user scripts, once for the whole burst
   if (config_[eventName].isString())
-    pid_.push_back(util::command::forkExec(config_[eventName].asString()));
+    util::command::forkExec(config_[eventName].asString(), this,
+                            {{"WAYBAR_SCROLL_STEPS", std::to_string(steps)}});
 
   dp.emit();
-  return true;
 }
 
 bool AModule::tooltipEnabled() { return isTooltip; }
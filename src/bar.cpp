@@ -8,6 +8,8 @@
 #include "client.hpp"
 #include "factory.hpp"
 #include "group.hpp"
+#include "util/profiler.hpp"
+#include "util/thread.hpp"
 
 #ifdef HAVE_SWAY
 #include "modules/sway/bar.hpp"
@@ -240,15 +242,15 @@ waybar::Bar::Bar(struct waybar_output* w_output, const Json::Value& w_config)
   setPosition(position);
 
   /* Read custom modes if available */
-  if (auto modes = config.get("modes", {}); modes.isObject()) {
+  if (const auto& modes = config["modes"]; modes.isObject()) {
     from_json(modes, configured_modes);
   }
 
   /* Update "default" mode with the global bar options */
   from_json(config, configured_modes[MODE_DEFAULT]);
 
-  if (auto mode = config.get("mode", {}); mode.isString()) {
-    setMode(config["mode"].asString());
+  if (const auto& mode = config["mode"]; mode.isString()) {
+    setMode(mode.asString());
   } else {
     setMode(MODE_DEFAULT);
   }
@@ -415,56 +417,6 @@ void waybar::Bar::setVisible(bool value) {
 
 void waybar::Bar::toggle() { setVisible(!visible); }
 
-// Converting string to button code rn as to avoid doing it later
-void waybar::Bar::setupAltFormatKeyForModule(const std::string& module_name) {
-  if (config.isMember(module_name)) {
-    Json::Value& module = config[module_name];
-    if (module.isMember("format-alt")) {
-      if (module.isMember("format-alt-click")) {
-        Json::Value& click = module["format-alt-click"];
-        if (click.isString()) {
-          if (click == "click-right") {
-            module["format-alt-click"] = 3U;
-          } else if (click == "click-middle") {
-            module["format-alt-click"] = 2U;
-          } else if (click == "click-backward") {
-            module["format-alt-click"] = 8U;
-          } else if (click == "click-forward") {
-            module["format-alt-click"] = 9U;
-          } else {
-            module["format-alt-click"] = 1U;  // default click-left
-          }
-        } else {
-          module["format-alt-click"] = 1U;
-        }
-      } else {
-        module["format-alt-click"] = 1U;
-      }
-    }
-  }
-}
-
-void waybar::Bar::setupAltFormatKeyForModuleList(const char* module_list_name) {
-  if (config.isMember(module_list_name)) {
-    Json::Value& modules = config[module_list_name];
-    for (const Json::Value& module_name : modules) {
-      if (module_name.isString()) {
-        auto ref = module_name.asString();
-        if (ref.compare(0, 6, "group/") == 0 && ref.size() > 6) {
-          Json::Value& group_modules = config[ref]["modules"];
-          for (const Json::Value& module_name : group_modules) {
-            if (module_name.isString()) {
-              setupAltFormatKeyForModule(module_name.asString());
-            }
-          }
-        } else {
-          setupAltFormatKeyForModule(ref);
-        }
-      }
-    }
-  }
-}
-
 void waybar::Bar::handleSignal(int signal) {
   for (auto& module : modules_all_) {
     module->refresh(signal);
@@ -473,12 +425,17 @@ void waybar::Bar::handleSignal(int signal) {
 
 void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
                              waybar::Group* group = nullptr) {
-  auto module_list = group ? config[pos]["modules"] : config[pos];
+  const auto& module_list = group ? config[pos]["modules"] : config[pos];
   if (module_list.isArray()) {
     for (const auto& name : module_list) {
       try {
         auto ref = name.asString();
         AModule* module;
+        // construction and updates of this instance, including the threads it starts
+        auto* account = util::Profiler::account(fmt::format("{}@{}", ref, output->name));
+        util::Profiler::Scope scope(account);
+        // threads the module starts are named and counted by module type
+        util::Thread::Owner owner(ref.substr(0, ref.find('#')));
 
         if (ref.compare(0, 6, "group/") == 0 && ref.size() > 6) {
           auto hash_pos = ref.find('#');
@@ -510,8 +467,9 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
             modules_right_.emplace_back(module_sp);
           }
         }
-        module->dp.connect([module, ref] {
+        module->dp.connect([module, ref, account] {
           try {
+            util::Profiler::Scope scope(account);
             module->update();
           } catch (const std::exception& e) {
             spdlog::error("{}: {}", ref, e.what());
@@ -534,11 +492,6 @@ auto waybar::Bar::setupWidgets() -> void {
   }
   box_.pack_end(right_, false, false);
 
-  // Convert to button code for every module that is used.
-  setupAltFormatKeyForModuleList("modules-left");
-  setupAltFormatKeyForModuleList("modules-right");
-  setupAltFormatKeyForModuleList("modules-center");
-
   Factory factory(*this, config);
   getModules(factory, "modules-left");
   getModules(factory, "modules-center");
@@ -1,20 +1,27 @@
 #include "client.hpp"
 
+#include <glibmm/main.h>
 #include <gtk-layer-shell.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include "gtkmm/icontheme.h"
 #include "idle-inhibit-unstable-v1-client-protocol.h"
 #include "util/clara.hpp"
 #include "util/format.hpp"
+#include "util/profiler.hpp"
+#include "util/thread.hpp"
 
 waybar::Client *waybar::Client::inst() {
   static auto c = new Client();
   return c;
 }
 
+// seconds between the live summaries of --profile
+static const unsigned PROFILE_SUMMARY_INTERVAL = 10;
+
 void waybar::Client::handleGlobal(void *data, struct wl_registry *registry, uint32_t name,
                                   const char *interface, uint32_t version) {
   auto client = static_cast<Client *>(data);
@@ -56,7 +63,8 @@ struct waybar::waybar_output &waybar::Client::getOutput(void *addr) {
   return *it;
 }
 
-std::vector<Json::Value> waybar::Client::getOutputConfigs(struct waybar_output &output) {
+std::vector<std::reference_wrapper<const Json::Value>> waybar::Client::getOutputConfigs(
+    struct waybar_output &output) {
   return config.getOutputConfigs(output.name, output.identifier);
 }
 
@@ -82,6 +90,7 @@ void waybar::Client::handleOutputDone(void *data, struct zxdg_output_v1 * /*xdg_
         for (const auto &config : configs) {
           client->bars.emplace_back(std::make_unique<Bar>(&output, config));
         }
+        spdlog::debug("Bars on {} ready, {}", output.name, util::Thread::report());
       }
     }
   } catch (const std::exception &e) {
@@ -216,6 +225,7 @@ void waybar::Client::bindInterfaces() {
 int waybar::Client::main(int argc, char *argv[]) {
   bool show_help = false;
   bool show_version = false;
+  bool profile = false;
   std::string config_opt;
   std::string style_opt;
   std::string log_level;
@@ -226,7 +236,9 @@ int waybar::Client::main(int argc, char *argv[]) {
              clara::detail::Opt(
                  log_level,
                  "trace|debug|info|warning|error|critical|off")["-l"]["--log-level"]("Log level") |
-             clara::detail::Opt(bar_id, "id")["-b"]["--bar"]("Bar id");
+             clara::detail::Opt(bar_id, "id")["-b"]["--bar"]("Bar id") |
+             clara::detail::Opt(profile)["-p"]["--profile"](
+                 "Account CPU time and allocations per module, dumped on exit");
   auto res = cli.parse(clara::detail::Args(argc, argv));
   if (!res) {
     spdlog::error("Error in command line: {}", res.errorMessage());
@@ -243,6 +255,10 @@ int waybar::Client::main(int argc, char *argv[]) {
   if (!log_level.empty()) {
     spdlog::set_level(spdlog::level::from_str(log_level));
   }
+  if (profile) {
+    // before any module or backend exists, accounts are created on first use
+    util::Profiler::enable();
+  }
   gtk_app = Gtk::Application::create(argc, argv, "fr.arouillard.waybar",
                                      Gio::APPLICATION_HANDLES_COMMAND_LINE);
 
@@ -270,7 +286,7 @@ int waybar::Client::main(int argc, char *argv[]) {
     setupCss(css_file);
   });
 
-  auto m_config = config.getConfig();
+  const auto &m_config = config.getConfig();
   if (m_config.isObject() && m_config["reload_style_on_change"].asBool()) {
     m_cssReloadHelper->monitorChanges();
   } else if (m_config.isArray()) {
@@ -283,10 +299,29 @@ int waybar::Client::main(int argc, char *argv[]) {
   }
 
   bindInterfaces();
+  if (profile) {
+    // live summary of the busiest accounts since the previous one
+    Glib::signal_timeout().connect_seconds(
+        [previous = util::Profiler::snapshot()]() mutable {
+          auto now = util::Profiler::snapshot();
+          auto busiest = util::Profiler::difference(now, previous);
+          busiest.resize(std::min<size_t>(busiest.size(), 5));
+          for (const auto &account : busiest) {
+            spdlog::info("profile: {}: {} calls, {:.1f} ms CPU, {} allocations", account.name,
+                         account.calls, account.cpu_ns / 1e6, account.allocations);
+          }
+          previous = std::move(now);
+          return true;
+        },
+        PROFILE_SUMMARY_INTERVAL);
+  }
   gtk_app->hold();
   gtk_app->run();
   m_cssReloadHelper.reset();  // stop watching css file
   bars.clear();
+  if (profile) {
+    std::cout << util::Profiler::report(util::Profiler::snapshot());
+  }
   return 0;
 }
 
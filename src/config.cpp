@@ -1,12 +1,16 @@
 #include "config.hpp"
 
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <wordexp.h>
 
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <stdexcept>
+#include <string_view>
 
 #include "util/json.hpp"
 
@@ -21,6 +25,199 @@ const std::vector<std::string> Config::CONFIG_DIRS = {
 
 const char *Config::CONFIG_PATH_ENV = "WAYBAR_CONFIG_DIR";
 
+namespace {
+
+/*
+ * The cache file is the magic, the format version, the sources and the merged config.
+ * Values are a type tag followed by the payload, integers and lengths are LEB128 varints.
+ * Bump CACHE_VERSION whenever the layout or what load() does to the parsed config changes.
+ */
+constexpr std::string_view CACHE_MAGIC = "WBCC";
+constexpr uint64_t CACHE_VERSION = 1;
+constexpr int CACHE_MAX_DEPTH = 256;
+
+enum CacheTag : uint8_t {
+  TAG_NULL,
+  TAG_FALSE,
+  TAG_TRUE,
+  TAG_INT,
+  TAG_UINT,
+  TAG_REAL,
+  TAG_STRING,
+  TAG_ARRAY,
+  TAG_OBJECT,
+};
+
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class CacheWriter {
+ public:
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      data.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data.push_back(static_cast<char>(value));
+  }
+
+  void string(std::string_view value) {
+    varint(value.size());
+    data.append(value);
+  }
+
+  void value(const Json::Value &value) {
+    switch (value.type()) {
+      case Json::nullValue:
+        data.push_back(TAG_NULL);
+        break;
+      case Json::booleanValue:
+        data.push_back(value.asBool() ? TAG_TRUE : TAG_FALSE);
+        break;
+      case Json::intValue:
+        data.push_back(TAG_INT);
+        varint(zigzag(value.asInt64()));
+        break;
+      case Json::uintValue:
+        data.push_back(TAG_UINT);
+        varint(value.asUInt64());
+        break;
+      case Json::realValue: {
+        data.push_back(TAG_REAL);
+        double real = value.asDouble();
+        uint64_t bits;
+        std::memcpy(&bits, &real, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+          data.push_back(static_cast<char>(bits >> (i * 8)));
+        }
+        break;
+      }
+      case Json::stringValue: {
+        data.push_back(TAG_STRING);
+        const char *begin = nullptr;
+        const char *end = nullptr;
+        value.getString(&begin, &end);
+        string(std::string_view(begin, end - begin));
+        break;
+      }
+      case Json::arrayValue:
+        data.push_back(TAG_ARRAY);
+        varint(value.size());
+        for (const auto &item : value) {
+          this->value(item);
+        }
+        break;
+      case Json::objectValue:
+        data.push_back(TAG_OBJECT);
+        varint(value.size());
+        for (auto it = value.begin(); it != value.end(); ++it) {
+          string(it.name());
+          this->value(*it);
+        }
+        break;
+    }
+  }
+
+  std::string data;
+};
+
+// Throws std::runtime_error on truncated or malformed input
+class CacheReader {
+ public:
+  explicit CacheReader(std::string_view data) : data_(data) {}
+
+  bool atEnd() const { return pos_ == data_.size(); }
+
+  uint8_t byte() {
+    if (pos_ >= data_.size()) {
+      throw std::runtime_error("truncated cache");
+    }
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto b = byte();
+      value |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw std::runtime_error("invalid varint in cache");
+  }
+
+  std::string_view bytes(uint64_t size) {
+    if (size > data_.size() - pos_) {
+      throw std::runtime_error("truncated cache");
+    }
+    auto view = data_.substr(pos_, size);
+    pos_ += size;
+    return view;
+  }
+
+  std::string string() { return std::string(bytes(varint())); }
+
+  Json::Value value(int depth = 0) {
+    if (depth > CACHE_MAX_DEPTH) {
+      throw std::runtime_error("cache nested too deep");
+    }
+    switch (byte()) {
+      case TAG_NULL:
+        return Json::Value();
+      case TAG_FALSE:
+        return Json::Value(false);
+      case TAG_TRUE:
+        return Json::Value(true);
+      case TAG_INT:
+        return Json::Value(static_cast<Json::Int64>(unzigzag(varint())));
+      case TAG_UINT:
+        return Json::Value(static_cast<Json::UInt64>(varint()));
+      case TAG_REAL: {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+          bits |= static_cast<uint64_t>(byte()) << (i * 8);
+        }
+        double real;
+        std::memcpy(&real, &bits, sizeof(real));
+        return Json::Value(real);
+      }
+      case TAG_STRING: {
+        auto view = bytes(varint());
+        return Json::Value(view.data(), view.data() + view.size());
+      }
+      case TAG_ARRAY: {
+        Json::Value array(Json::arrayValue);
+        for (auto count = varint(); count > 0; --count) {
+          array.append(value(depth + 1));
+        }
+        return array;
+      }
+      case TAG_OBJECT: {
+        Json::Value object(Json::objectValue);
+        for (auto count = varint(); count > 0; --count) {
+          auto key = string();
+          object[key] = value(depth + 1);
+        }
+        return object;
+      }
+      default:
+        throw std::runtime_error("unknown value in cache");
+    }
+  }
+
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
 std::optional<std::string> tryExpandPath(const std::string base, const std::string filename) {
   fs::path path;
 
@@ -65,14 +262,148 @@ std::optional<std::string> Config::findConfigPath(const std::vector<std::string>
   return std::nullopt;
 }
 
-void Config::setupConfig(Json::Value &dst, const std::string &config_file, int depth) {
+std::string Config::cachePath(const std::string &config_file) {
+  fs::path dir;
+  if (const char *cache = std::getenv("XDG_CACHE_HOME"); cache != nullptr && *cache != '\0') {
+    dir = cache;
+  } else if (const char *home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+    dir = fs::path(home) / ".cache";
+  } else {
+    return "";
+  }
+  std::error_code ec;
+  auto path = fs::absolute(config_file, ec);
+  const auto key = ec ? config_file : path.string();
+  // FNV-1a, stable across builds unlike std::hash
+  uint64_t hash = 0xcbf29ce484222325;
+  for (unsigned char c : key) {
+    hash = (hash ^ c) * 0x100000001b3;
+  }
+  return (dir / "waybar" / fmt::format("config-{:016x}.bin", hash)).string();
+}
+
+std::optional<Config::Source> Config::statSource(const std::string &include,
+                                                 const std::string &path) {
+  struct stat st;
+  if (path.empty() || ::stat(path.c_str(), &st) != 0) {
+    return std::nullopt;
+  }
+  return Source{
+      .include = include,
+      .path = path,
+      .device = static_cast<uint64_t>(st.st_dev),
+      .inode = static_cast<uint64_t>(st.st_ino),
+      .size = static_cast<uint64_t>(st.st_size),
+      .mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec,
+      .ctime_ns = st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec,
+  };
+}
+
+bool Config::sourcesUnchanged(const std::vector<Source> &sources) {
+  for (const auto &source : sources) {
+    // includes are expanded again, they may point elsewhere after an environment change
+    if (!source.include.empty() && tryExpandPath(source.include, "") != source.path) {
+      return false;
+    }
+    if (statSource(source.include, source.path) != source) {
+      return false;
+    }
+  }
+  return !sources.empty();
+}
+
+bool Config::loadCache() {
+  const auto path = cachePath(config_file_);
+  if (path.empty()) {
+    return false;
+  }
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  try {
+    CacheReader reader(data);
+    if (reader.bytes(CACHE_MAGIC.size()) != CACHE_MAGIC || reader.varint() != CACHE_VERSION) {
+      return false;
+    }
+    std::vector<Source> sources(reader.varint());
+    for (auto &source : sources) {
+      source.include = reader.string();
+      source.path = reader.string();
+      source.device = reader.varint();
+      source.inode = reader.varint();
+      source.size = reader.varint();
+      source.mtime_ns = unzigzag(reader.varint());
+      source.ctime_ns = unzigzag(reader.varint());
+    }
+    if (sources.empty() || sources.front().path != config_file_ || !sourcesUnchanged(sources)) {
+      return false;
+    }
+    auto config = reader.value();
+    if (!reader.atEnd()) {
+      return false;
+    }
+    cached_ = std::move(config);
+    sources_ = std::move(sources);
+    return true;
+  } catch (const std::exception &e) {
+    spdlog::debug("Ignoring config cache {}: {}", path, e.what());
+    return false;
+  }
+}
+
+void Config::saveCache() const {
+  const auto path = cachePath(config_file_);
+  if (path.empty()) {
+    return;
+  }
+  CacheWriter writer;
+  writer.data.append(CACHE_MAGIC);
+  writer.varint(CACHE_VERSION);
+  writer.varint(sources_.size());
+  for (const auto &source : sources_) {
+    writer.string(source.include);
+    writer.string(source.path);
+    writer.varint(source.device);
+    writer.varint(source.inode);
+    writer.varint(source.size);
+    writer.varint(zigzag(source.mtime_ns));
+    writer.varint(zigzag(source.ctime_ns));
+  }
+  writer.value(cached_);
+
+  // written aside and renamed, so a concurrent load never sees a partial file
+  std::error_code ec;
+  fs::create_directories(fs::path(path).parent_path(), ec);
+  const auto tmp = fmt::format("{}.{}", path, getpid());
+  {
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    if (!file.write(writer.data.data(), writer.data.size()) || !file.flush()) {
+      spdlog::debug("Can't write config cache {}", tmp);
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+  fs::rename(tmp, path, ec);
+  if (ec) {
+    spdlog::debug("Can't write config cache {}: {}", path, ec.message());
+    fs::remove(tmp, ec);
+  }
+}
+
+void Config::setupConfig(Json::Value &dst, const std::string &config_file, int depth,
+                         const std::string &include) {
   if (depth > 100) {
     throw std::runtime_error("Aborting due to likely recursive include in config files");
   }
+  // stat before reading, an edit racing with the read then invalidates the cache next time
+  auto source = statSource(include, config_file);
   std::ifstream file(config_file);
-  if (!file.is_open()) {
+  if (!source || !file.is_open()) {
     throw std::runtime_error("Can't open config file");
   }
+  reading_.push_back(std::move(*source));
   std::string str((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
   util::JsonParser parser;
   Json::Value tmp_config = parser.parse(str);
@@ -91,11 +422,13 @@ void Config::resolveConfigIncludes(Json::Value &config, int depth) {
   if (includes.isArray()) {
     for (const auto &include : includes) {
       spdlog::info("Including resource file: {}", include.asString());
-      setupConfig(config, tryExpandPath(include.asString(), "").value_or(""), ++depth);
+      setupConfig(config, tryExpandPath(include.asString(), "").value_or(""), ++depth,
+                  include.asString());
     }
   } else if (includes.isString()) {
     spdlog::info("Including resource file: {}", includes.asString());
-    setupConfig(config, tryExpandPath(includes.asString(), "").value_or(""), ++depth);
+    setupConfig(config, tryExpandPath(includes.asString(), "").value_or(""), ++depth,
+                includes.asString());
   }
 }
 
@@ -162,21 +495,111 @@ void Config::load(const std::string &config) {
   }
   config_file_ = file.value();
   spdlog::info("Using configuration file {}", config_file_);
+
+  from_cache_ = (!sources_.empty() && sources_.front().path == config_file_ &&
+                 sourcesUnchanged(sources_)) ||
+                loadCache();
+  if (from_cache_) {
+    spdlog::debug("Config files unchanged, using the cached config");
+    config_ = cached_;
+    return;
+  }
+
+  sources_.clear();
+  cached_ = Json::Value();
+  reading_.clear();
   config_ = Json::Value();
   setupConfig(config_, config_file_, 0);
+
+  // Bars only get const views of their config, so the one-time rewrites happen here
+  auto setupBar = [this](Json::Value &bar_config) {
+    setupAltFormatKeyForModuleList(bar_config, "modules-left");
+    setupAltFormatKeyForModuleList(bar_config, "modules-right");
+    setupAltFormatKeyForModuleList(bar_config, "modules-center");
+  };
+  if (config_.isArray()) {
+    for (auto &bar_config : config_) {
+      if (bar_config.isObject()) {
+        setupBar(bar_config);
+      }
+    }
+  } else if (config_.isObject()) {
+    setupBar(config_);
+  }
+
+  cached_ = config_;
+  sources_ = std::move(reading_);
+  reading_.clear();
+  saveCache();
+}
+
+// Converting string to button code rn as to avoid doing it later
+void Config::setupAltFormatKeyForModule(Json::Value &bar_config, const std::string &module_name) {
+  if (!bar_config.isMember(module_name)) {
+    return;
+  }
+  Json::Value &module = bar_config[module_name];
+  if (!module.isObject() || !module.isMember("format-alt")) {
+    return;
+  }
+  if (module.isMember("format-alt-click")) {
+    Json::Value &click = module["format-alt-click"];
+    if (click.isString()) {
+      if (click == "click-right") {
+        module["format-alt-click"] = 3U;
+      } else if (click == "click-middle") {
+        module["format-alt-click"] = 2U;
+      } else if (click == "click-backward") {
+        module["format-alt-click"] = 8U;
+      } else if (click == "click-forward") {
+        module["format-alt-click"] = 9U;
+      } else {
+        module["format-alt-click"] = 1U;  // default click-left
+      }
+    } else if (!click.isUInt()) {
+      // a module can be listed more than once, keep codes converted earlier
+      module["format-alt-click"] = 1U;
+    }
+  } else {
+    module["format-alt-click"] = 1U;
+  }
+}
+
+void Config::setupAltFormatKeyForModuleList(Json::Value &bar_config,
+                                            const char *module_list_name) {
+  if (!bar_config.isMember(module_list_name)) {
+    return;
+  }
+  // look up through a const view, operator[] would add missing groups to the config
+  const Json::Value &bar = bar_config;
+  for (const Json::Value &module_name : bar[module_list_name]) {
+    if (module_name.isString()) {
+      auto ref = module_name.asString();
+      if (ref.compare(0, 6, "group/") == 0 && ref.size() > 6) {
+        const Json::Value &group_modules = bar[ref]["modules"];
+        for (const Json::Value &module_name : group_modules) {
+          if (module_name.isString()) {
+            setupAltFormatKeyForModule(bar_config, module_name.asString());
+          }
+        }
+      } else {
+        setupAltFormatKeyForModule(bar_config, ref);
+      }
+    }
+  }
 }
 
-std::vector<Json::Value> Config::getOutputConfigs(const std::string &name,
-                                                  const std::string &identifier) {
-  std::vector<Json::Value> configs;
+std::vector<std::reference_wrapper<const Json::Value>> Config::getOutputConfigs(
+    const std::string &name, const std::string &identifier) const {
+  std::vector<std::reference_wrapper<const Json::Value>> configs;
   if (config_.isArray()) {
     for (auto const &config : config_) {
       if (config.isObject() && isValidOutput(config, name, identifier)) {
-        configs.push_back(config);
+        configs.emplace_back(config);
       }
     }
   } else if (isValidOutput(config_, name, identifier)) {
-    configs.push_back(config_);
+    configs.emplace_back(config_);
   }
   return configs;
 }
@@ -3,13 +3,10 @@
 #include <sys/wait.h>
 
 #include <csignal>
-#include <list>
-#include <mutex>
 
 #include "client.hpp"
+#include "util/child_registry.hpp"
 
-std::mutex reap_mtx;
-std::list<pid_t> reap;
 volatile bool reload;
 
 void* signalThread(void* args) {
@@ -28,16 +25,7 @@ void* signalThread(void* args) {
     switch (signum) {
       case SIGCHLD:
         spdlog::debug("Received SIGCHLD in signalThread");
-        if (!reap.empty()) {
-          reap_mtx.lock();
-          for (auto it = reap.begin(); it != reap.end(); ++it) {
-            if (waitpid(*it, nullptr, WNOHANG) == *it) {
-              spdlog::debug("Reaped child with PID: {}", *it);
-              it = reap.erase(it);
-            }
-          }
-          reap_mtx.unlock();
-        }
+        waybar::util::ChildRegistry::inst().reap();
         break;
       default:
         spdlog::debug("Received signal with number {}, but not handling", signum);
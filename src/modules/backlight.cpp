@@ -69,20 +69,18 @@ auto waybar::modules::Backlight::update() -> void {
   ALabel::update();
 }
 
-bool waybar::modules::Backlight::handleScroll(GdkEventScroll *e) {
+void waybar::modules::Backlight::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
   // Check if the user has set a custom command for scrolling
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
-    return AModule::handleScroll(e);
+    AModule::handleScrollSteps(dir, steps);
+    return;
   }
 
   // Fail fast if the proxy could not be initialized
   if (!backend.is_login_proxy_initialized()) {
-    return true;
+    return;
   }
 
-  // Check scroll direction
-  auto dir = AModule::getScrollDir(e);
-
   // No worries, it will always be set because of the switch below. This is purely to suppress a
   // warning
   util::ChangeType ct = util::ChangeType::Increase;
@@ -101,8 +99,7 @@ bool waybar::modules::Backlight::handleScroll(GdkEventScroll *e) {
       break;
 
     case SCROLL_DIR::NONE:
-      return true;
-      break;
+      return;
   }
 
   // Get scroll step
@@ -112,7 +109,5 @@ bool waybar::modules::Backlight::handleScroll(GdkEventScroll *e) {
     step = config_["scroll-step"].asDouble();
   }
 
-  backend.set_brightness(preferred_device_, ct, step);
-
-  return true;
+  backend.set_brightness(preferred_device_, ct, step * steps);
 }
@@ -0,0 +1,291 @@
+#include "modules/cava_engine.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace waybar::modules {
+
+namespace {
+
+// Options changing the captured audio or the computed bars, the rest only changes the markup
+const char* const ENGINE_KEYS[] = {
+    "cava_config",
+    "framerate",
+    "autosens",
+    "sensitivity",
+    "bars",
+    "lower_cutoff_freq",
+    "higher_cutoff_freq",
+    "sleep_timer",
+    "method",
+    "source",
+    "sample_rate",
+    "sample_bits",
+    "stereo",
+    "reverse",
+    "monstercat",
+    "waves",
+    "noise_reduction",
+    "input_delay",
+};
+
+void upThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
+  if (delta == std::chrono::seconds{0}) {
+    delta += std::chrono::seconds{1};
+    delay += delta;
+  }
+}
+
+void downThreadDelay(std::chrono::milliseconds& delay, std::chrono::seconds& delta) {
+  if (delta > std::chrono::seconds{0}) {
+    delay -= delta;
+    delta -= std::chrono::seconds{1};
+  }
+}
+
+}  // namespace
+
+std::string CavaEngine::keyFor(const Json::Value& config) {
+  Json::Value key(Json::objectValue);
+  for (const auto* name : ENGINE_KEYS) {
+    if (config.isMember(name)) {
+      key[name] = config[name];
+    }
+  }
+  // the number of icons sets the height of the bars
+  key["format-icons"] = config["format-icons"].size();
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  return Json::writeString(builder, key);
+}
+
+std::shared_ptr<CavaEngine> CavaEngine::getInstance(const Json::Value& config) {
+  static std::map<std::string, std::weak_ptr<CavaEngine>> engines;
+  auto& weak = engines[keyFor(config)];
+  auto engine = weak.lock();
+  if (!engine) {
+    engine = std::make_shared<CavaEngine>(config, private_constructor_tag{});
+    weak = engine;
+  }
+  return engine;
+}
+
+CavaEngine::CavaEngine(const Json::Value& config, private_constructor_tag /*tag*/) {
+  // Load waybar module config
+  char cfgPath[PATH_MAX];
+  cfgPath[0] = '\0';
+
+  if (config["cava_config"].isString()) strcpy(cfgPath, config["cava_config"].asString().data());
+  // Load cava config
+  error_.length = 0;
+
+  if (!load_config(cfgPath, &prm_, false, &error_)) {
+    spdlog::error("Error loading config. {0}", error_.message);
+    exit(EXIT_FAILURE);
+  }
+
+  // Override cava parameters by the user config
+  prm_.inAtty = 0;
+  prm_.output = cava::output_method::OUTPUT_RAW;
+  strcpy(prm_.data_format, "ascii");
+  strcpy(prm_.raw_target, "/dev/stdout");
+  prm_.ascii_range = config["format-icons"].size() - 1;
+
+  prm_.bar_width = 2;
+  prm_.bar_spacing = 0;
+  prm_.bar_height = 32;
+  prm_.bar_width = 1;
+  prm_.orientation = cava::ORIENT_TOP;
+  prm_.xaxis = cava::xaxis_scale::NONE;
+  prm_.mono_opt = cava::AVERAGE;
+  prm_.autobars = 0;
+  prm_.gravity = 0;
+  prm_.integral = 1;
+
+  if (config["framerate"].isInt()) prm_.framerate = config["framerate"].asInt();
+  if (config["autosens"].isInt()) prm_.autosens = config["autosens"].asInt();
+  if (config["sensitivity"].isInt()) prm_.sens = config["sensitivity"].asInt();
+  if (config["bars"].isInt()) prm_.fixedbars = config["bars"].asInt();
+  if (config["lower_cutoff_freq"].isNumeric())
+    prm_.lower_cut_off = config["lower_cutoff_freq"].asLargestInt();
+  if (config["higher_cutoff_freq"].isNumeric())
+    prm_.upper_cut_off = config["higher_cutoff_freq"].asLargestInt();
+  if (config["sleep_timer"].isInt()) prm_.sleep_timer = config["sleep_timer"].asInt();
+  if (config["method"].isString())
+    prm_.input = cava::input_method_by_name(config["method"].asString().c_str());
+  if (config["source"].isString()) prm_.audio_source = config["source"].asString().data();
+  if (config["sample_rate"].isNumeric()) prm_.samplerate = config["sample_rate"].asLargestInt();
+  if (config["sample_bits"].isInt()) prm_.samplebits = config["sample_bits"].asInt();
+  if (config["stereo"].isBool()) prm_.stereo = config["stereo"].asBool();
+  if (config["reverse"].isBool()) prm_.reverse = config["reverse"].asBool();
+  if (config["monstercat"].isBool()) prm_.monstercat = config["monstercat"].asBool();
+  if (config["waves"].isBool()) prm_.waves = config["waves"].asBool();
+  if (config["noise_reduction"].isDouble())
+    prm_.noise_reduction = config["noise_reduction"].asDouble();
+  if (config["input_delay"].isInt())
+    fetch_input_delay_ = std::chrono::seconds(config["input_delay"].asInt());
+  // Make cava parameters configuration
+  plan_ = new cava::cava_plan{};
+
+  audio_raw_.height = prm_.ascii_range;
+  audio_data_.format = -1;
+  audio_data_.source = new char[1 + strlen(prm_.audio_source)];
+  audio_data_.source[0] = '\0';
+  strcpy(audio_data_.source, prm_.audio_source);
+
+  audio_data_.rate = 0;
+  audio_data_.samples_counter = 0;
+  audio_data_.channels = 2;
+  audio_data_.IEEE_FLOAT = 0;
+
+  audio_data_.input_buffer_size = BUFFER_SIZE * audio_data_.channels;
+  audio_data_.cava_buffer_size = audio_data_.input_buffer_size * 8;
+
+  audio_data_.cava_in = new double[audio_data_.cava_buffer_size]{0.0};
+
+  audio_data_.terminate = 0;
+  audio_data_.suspendFlag = false;
+  input_source_ = get_input(&audio_data_, &prm_);
+
+  if (!input_source_) {
+    spdlog::error("cava API didn't provide input audio source method");
+    exit(EXIT_FAILURE);
+  }
+  // Calculate delay for the computing thread
+  frame_time_milsec_ = std::chrono::milliseconds((int)(1e3 / prm_.framerate));
+
+  // Init cava plan, audio_raw structure
+  audio_raw_init(&audio_data_, &audio_raw_, &prm_, plan_);
+  if (!plan_) spdlog::error("cava plan is not provided");
+  audio_raw_.previous_frame[0] = -1;  // The first computed frame always repaints
+  // Read audio source trough cava API. Cava orginizes this process via infinity loop
+  thread_fetch_input_ = [this] {
+    thread_fetch_input_.sleep_for(fetch_input_delay_);
+    input_source_(&audio_data_);
+  };
+
+  thread_ = [this] {
+    tick();
+    thread_.sleep_for(frameTime());
+  };
+}
+
+CavaEngine::~CavaEngine() {
+  audio_data_.terminate = 1;
+  thread_fetch_input_.stop();
+  thread_.stop();
+  delete plan_;
+  plan_ = nullptr;
+}
+
+CavaEngine::Frame CavaEngine::frame() const {
+  std::lock_guard lock(mutex_);
+  return frame_;
+}
+
+uint64_t CavaEngine::addListener(std::function<void()> listener) {
+  std::lock_guard lock(mutex_);
+  auto id = next_listener_++;
+  listeners_.emplace(id, std::move(listener));
+  return id;
+}
+
+void CavaEngine::removeListener(uint64_t id) {
+  std::lock_guard lock(mutex_);
+  listeners_.erase(id);
+}
+
+void CavaEngine::notify() {
+  std::lock_guard lock(mutex_);
+  for (const auto& [id, listener] : listeners_) {
+    listener();
+  }
+}
+
+std::chrono::milliseconds CavaEngine::frameTime() {
+  pthread_mutex_lock(&audio_data_.lock);
+  auto frame_time = frame_time_milsec_;
+  pthread_mutex_unlock(&audio_data_.lock);
+  return frame_time;
+}
+
+// Runs once per frame on the engine thread
+void CavaEngine::tick() {
+  if (audio_data_.suspendFlag) return;
+  silence_ = true;
+
+  for (int i{0}; i < audio_data_.input_buffer_size; ++i) {
+    if (audio_data_.cava_in[i]) {
+      silence_ = false;
+      sleep_counter_ = 0;
+      break;
+    }
+  }
+
+  if (silence_ && prm_.sleep_timer) {
+    if (sleep_counter_ <=
+        (int)(std::chrono::milliseconds(prm_.sleep_timer * 1s) / frameTime())) {
+      ++sleep_counter_;
+      silence_ = false;
+    }
+  }
+
+  if (silence_) {
+    pthread_mutex_lock(&audio_data_.lock);
+    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+    pthread_mutex_unlock(&audio_data_.lock);
+    bool changed = false;
+    {
+      std::lock_guard lock(mutex_);
+      changed = !frame_.silence;
+      frame_.silence = true;
+    }
+    if (changed) notify();
+    return;
+  }
+
+  // Process: execute cava
+  pthread_mutex_lock(&audio_data_.lock);
+  downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  cava::cava_execute(audio_data_.cava_in, audio_data_.samples_counter, audio_raw_.cava_out, plan_);
+  if (audio_data_.samples_counter > 0) audio_data_.samples_counter = 0;
+  pthread_mutex_unlock(&audio_data_.lock);
+
+  // Do transformation under raw data
+  audio_raw_fetch(&audio_raw_, &prm_, &rePaint_, plan_);
+
+  if (rePaint_ == 1) {
+    {
+      std::lock_guard lock(mutex_);
+      frame_.silence = false;
+      frame_.bars.resize(audio_raw_.number_of_bars);
+      for (int i{0}; i < audio_raw_.number_of_bars; ++i) {
+        audio_raw_.previous_frame[i] = audio_raw_.bars[i];
+        frame_.bars[i] = std::min(audio_raw_.bars[i], prm_.ascii_range);
+      }
+    }
+    notify();
+  }
+}
+
+// Cava actions
+void CavaEngine::pauseResume() {
+  pthread_mutex_lock(&audio_data_.lock);
+  if (audio_data_.suspendFlag) {
+    audio_data_.suspendFlag = false;
+    pthread_cond_broadcast(&audio_data_.resumeCond);
+    downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  } else {
+    audio_data_.suspendFlag = true;
+    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  }
+  pthread_mutex_unlock(&audio_data_.lock);
+  {
+    std::lock_guard lock(mutex_);
+    frame_.suspended = audio_data_.suspendFlag;
+  }
+}
+
+}  // namespace waybar::modules
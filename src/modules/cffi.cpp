@@ -1,104 +1,177 @@
 #include "modules/cffi.hpp"
 
-#include <dlfcn.h>
+#include <glibmm/main.h>
 #include <json/value.h>
+#include <json/writer.h>
 
 #include <algorithm>
-#include <iostream>
-#include <type_traits>
+#include <utility>
 
 namespace waybar::modules {
 
-CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& config)
-    : AModule(config, name, id, true, true) {
-  const auto dynlib_path = config_["module_path"].asString();
-  if (dynlib_path.empty()) {
-    throw std::runtime_error{"Missing or empty 'module_path' in module config"};
+namespace ffi {
+
+static Glib::IOCondition to_io_condition(uint32_t events) {
+  Glib::IOCondition cond{};
+  if (events & WBCFFI_FD_READABLE) {
+    cond |= Glib::IO_IN | Glib::IO_PRI;
   }
+  if (events & WBCFFI_FD_WRITABLE) {
+    cond |= Glib::IO_OUT;
+  }
+  if (events & WBCFFI_FD_HANGUP) {
+    cond |= Glib::IO_HUP | Glib::IO_ERR;
+  }
+  return cond;
+}
 
-  void* handle = dlopen(dynlib_path.c_str(), RTLD_LAZY);
-  if (handle == nullptr) {
-    throw std::runtime_error{std::string{"Failed to load CFFI module: "} + dlerror()};
+static uint32_t from_io_condition(Glib::IOCondition cond) {
+  uint32_t events = 0;
+  if (cond & (Glib::IO_IN | Glib::IO_PRI)) {
+    events |= WBCFFI_FD_READABLE;
+  }
+  if (cond & Glib::IO_OUT) {
+    events |= WBCFFI_FD_WRITABLE;
   }
+  if (cond & (Glib::IO_HUP | Glib::IO_ERR | Glib::IO_NVAL)) {
+    events |= WBCFFI_FD_HANGUP;
+  }
+  return events;
+}
 
-  // Fetch ABI version
-  auto wbcffi_version = reinterpret_cast<size_t*>(dlsym(handle, "wbcffi_version"));
-  if (wbcffi_version == nullptr) {
-    throw std::runtime_error{std::string{"Missing wbcffi_version function: "} + dlerror()};
+wbcffi_module::~wbcffi_module() {
+  for (auto& [id, source] : sources) {
+    source.disconnect();
   }
+}
 
-  // Fetch functions
-  if (*wbcffi_version == 1) {
-    // Mandatory functions
-    hooks_.init = reinterpret_cast<InitFn*>(dlsym(handle, "wbcffi_init"));
-    if (!hooks_.init) {
-      throw std::runtime_error{std::string{"Missing wbcffi_init function: "} + dlerror()};
-    }
-    hooks_.deinit = reinterpret_cast<DenitFn*>(dlsym(handle, "wbcffi_deinit"));
-    if (!hooks_.init) {
-      throw std::runtime_error{std::string{"Missing wbcffi_deinit function: "} + dlerror()};
-    }
-    // Optional functions
-    if (auto fn = reinterpret_cast<UpdateFn*>(dlsym(handle, "wbcffi_update"))) {
-      hooks_.update = fn;
-    }
-    if (auto fn = reinterpret_cast<RefreshFn*>(dlsym(handle, "wbcffi_refresh"))) {
-      hooks_.refresh = fn;
-    }
-    if (auto fn = reinterpret_cast<DoActionFn*>(dlsym(handle, "wbcffi_doaction"))) {
-      hooks_.doAction = fn;
+const wbcffi_init_info& wbcffi_module::initInfo(const wbcffi_config_node* config,
+                                                 void* shared) {
+  info = {
+      .obj = this,
+      .waybar_version = VERSION,
+      .get_root_widget = [](wbcffi_module* obj) { return obj->root; },
+      .queue_update = [](wbcffi_module* obj) { obj->queue_update(); },
+      .config = config,
+      .shared = shared,
+      .add_fd = [](wbcffi_module* obj, int fd, uint32_t events, wbcffi_fd_callback callback,
+                   void* user_data) -> wbcffi_source {
+        const auto id = obj->next_source++;
+        obj->sources[id] = Glib::signal_io().connect(
+            [obj, id, fd, callback, user_data](Glib::IOCondition cond) {
+              if (callback(user_data, fd, from_io_condition(cond))) {
+                return true;
+              }
+              obj->sources.erase(id);
+              return false;
+            },
+            fd, to_io_condition(events));
+        return id;
+      },
+      .add_timer = [](wbcffi_module* obj, uint32_t interval_ms, wbcffi_timer_callback callback,
+                      void* user_data) -> wbcffi_source {
+        const auto id = obj->next_source++;
+        obj->sources[id] = Glib::signal_timeout().connect(
+            [obj, id, callback, user_data] {
+              if (callback(user_data)) {
+                return true;
+              }
+              obj->sources.erase(id);
+              return false;
+            },
+            interval_ms);
+        return id;
+      },
+      .remove_source = [](wbcffi_module* obj, wbcffi_source source) {
+        auto it = obj->sources.find(source);
+        if (it != obj->sources.end()) {
+          it->second.disconnect();
+          obj->sources.erase(it);
+        }
+      },
+  };
+  return info;
+}
+
+}  // namespace ffi
+
+CFFI::Shared::Shared(std::shared_ptr<ffi::Plugin> plugin, const Json::Value& config)
+    : plugin(std::move(plugin)), config(config) {
+  module.queue_update = [this] {
+    for (auto* view : views) {
+      view->dp.emit();
     }
-  } else {
-    throw std::runtime_error{"Unknown wbcffi_version " + std::to_string(*wbcffi_version)};
+  };
+  instance = this->plugin->sharedInit(module.initInfo(this->config.root(), nullptr));
+  if (instance == nullptr) {
+    throw std::runtime_error{"Failed to initialize shared C ABI module"};
   }
+}
 
-  // Prepare init() arguments
-  // Convert JSON values to string
-  std::vector<std::string> config_entries_stringstor;
-  const auto& keys = config.getMemberNames();
-  for (size_t i = 0; i < keys.size(); i++) {
-    const auto& value = config[keys[i]];
-    if (value.isConvertibleTo(Json::ValueType::stringValue)) {
-      config_entries_stringstor.push_back(config[keys[i]].asString());
-    } else {
-      config_entries_stringstor.push_back(config[keys[i]].toStyledString());
-    }
+CFFI::Shared::~Shared() { plugin->sharedDeinit(instance); }
+
+std::shared_ptr<CFFI::Shared> CFFI::getShared(const std::shared_ptr<ffi::Plugin>& plugin,
+                                              const Json::Value& config) {
+  // bars on different outputs load the same library with equal configs. The config's address
+  // can't tell them apart, a reload may place another config at the same address
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  auto key = std::make_pair(config["module_path"].asString(), Json::writeString(builder, config));
+
+  static std::map<std::pair<std::string, std::string>, std::weak_ptr<Shared>> instances;
+  std::erase_if(instances, [](const auto& entry) { return entry.second.expired(); });
+  auto& weak = instances[key];
+  auto shared = weak.lock();
+  if (!shared) {
+    shared = std::make_shared<Shared>(plugin, config);
+    weak = shared;
   }
+  return shared;
+}
 
-  // Prepare config_entries array
-  std::vector<ffi::wbcffi_config_entry> config_entries;
-  for (size_t i = 0; i < keys.size(); i++) {
-    config_entries.push_back({keys[i].c_str(), config_entries_stringstor[i].c_str()});
+CFFI::CFFI(const std::string& name, const std::string& id, const Json::Value& config)
+    : AModule(config, name, id, true, true), config_tree_(config) {
+  const auto dynlib_path = config_["module_path"].asString();
+  if (dynlib_path.empty()) {
+    throw std::runtime_error{"Missing or empty 'module_path' in module config"};
   }
 
-  ffi::wbcffi_init_info init_info = {
-      .obj = (ffi::wbcffi_module*)this,
-      .waybar_version = VERSION,
-      .get_root_widget =
-          [](ffi::wbcffi_module* obj) {
-            return dynamic_cast<Gtk::Container*>(&((CFFI*)obj)->event_box_)->gobj();
-          },
-      .queue_update = [](ffi::wbcffi_module* obj) { ((CFFI*)obj)->dp.emit(); },
-  };
+  plugin_ = ffi::Plugin::load(dynlib_path);
+
+  module_.root = dynamic_cast<Gtk::Container*>(&event_box_)->gobj();
+  module_.queue_update = [this] { dp.emit(); };
+
+  if (plugin_->hasShared()) {
+    shared_ = getShared(plugin_, config);
+    shared_->views.push_back(this);
+  }
 
   // Call init
-  cffi_instance_ = hooks_.init(&init_info, config_entries.data(), config_entries.size());
+  const auto& init_info =
+      module_.initInfo(config_tree_.root(), shared_ ? shared_->instance : nullptr);
+  cffi_instance_ = plugin_->init(init_info, config);
 
   // Handle init failures
   if (cffi_instance_ == nullptr) {
+    if (shared_) {
+      std::erase(shared_->views, this);
+    }
     throw std::runtime_error{"Failed to initialize C ABI module"};
   }
 }
 
 CFFI::~CFFI() {
   if (cffi_instance_ != nullptr) {
-    hooks_.deinit(cffi_instance_);
+    plugin_->deinit(cffi_instance_);
+  }
+  if (shared_) {
+    std::erase(shared_->views, this);
   }
 }
 
 auto CFFI::update() -> void {
   assert(cffi_instance_ != nullptr);
-  hooks_.update(cffi_instance_);
+  plugin_->update(cffi_instance_);
 
   // Execute the on-update command set in config
   AModule::update();
@@ -106,13 +179,13 @@ auto CFFI::update() -> void {
 
 auto CFFI::refresh(int signal) -> void {
   assert(cffi_instance_ != nullptr);
-  hooks_.refresh(cffi_instance_, signal);
+  plugin_->refresh(cffi_instance_, signal);
 }
 
 auto CFFI::doAction(const std::string& name) -> void {
   assert(cffi_instance_ != nullptr);
   if (!name.empty()) {
-    hooks_.doAction(cffi_instance_, name.c_str());
+    plugin_->doAction(cffi_instance_, name.c_str());
   }
 }
 
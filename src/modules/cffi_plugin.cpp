@@ -0,0 +1,161 @@
+#include "modules/cffi_plugin.hpp"
+
+#include <dlfcn.h>
+
+#include <map>
+#include <stdexcept>
+
+namespace waybar::modules::ffi {
+
+ConfigTree::ConfigTree(const Json::Value& config) : root_{} { fill(root_, config); }
+
+const char* ConfigTree::store(std::string str) {
+  return strings_.emplace_back(std::move(str)).c_str();
+}
+
+void ConfigTree::fill(wbcffi_config_node& node, const Json::Value& value) {
+  switch (value.type()) {
+    case Json::nullValue:
+      node.type = WBCFFI_CONFIG_NULL;
+      break;
+    case Json::booleanValue:
+      node.type = WBCFFI_CONFIG_BOOL;
+      node.as.boolean = value.asBool();
+      break;
+    case Json::intValue:
+      node.type = WBCFFI_CONFIG_INT;
+      node.as.integer = value.asInt64();
+      break;
+    case Json::uintValue:
+      node.type = WBCFFI_CONFIG_UINT;
+      node.as.uinteger = value.asUInt64();
+      break;
+    case Json::realValue:
+      node.type = WBCFFI_CONFIG_DOUBLE;
+      node.as.real = value.asDouble();
+      break;
+    case Json::stringValue:
+      node.type = WBCFFI_CONFIG_STRING;
+      node.as.string = store(value.asString());
+      break;
+    case Json::arrayValue:
+    case Json::objectValue: {
+      const bool is_object = value.isObject();
+      const auto size = value.size();
+      auto& items = children_.emplace_back(std::make_unique<wbcffi_config_node[]>(size));
+      node.type = is_object ? WBCFFI_CONFIG_OBJECT : WBCFFI_CONFIG_ARRAY;
+      node.as.children = {items.get(), size};
+      auto* child = items.get();
+      for (auto it = value.begin(); it != value.end(); ++it, ++child) {
+        child->key = is_object ? store(it.name()) : nullptr;
+        fill(*child, *it);
+      }
+      break;
+    }
+  }
+}
+
+std::shared_ptr<Plugin> Plugin::load(const std::string& path) {
+  static std::map<std::string, std::weak_ptr<Plugin>> plugins;
+  auto& weak = plugins[path];
+  auto plugin = weak.lock();
+  if (!plugin) {
+    plugin = std::shared_ptr<Plugin>(new Plugin(path));
+    weak = plugin;
+  }
+  return plugin;
+}
+
+Plugin::Plugin(const std::string& path) : handle_(dlopen(path.c_str(), RTLD_LAZY)) {
+  if (handle_ == nullptr) {
+    throw std::runtime_error{std::string{"Failed to load CFFI module: "} + dlerror()};
+  }
+
+  try {
+    // Fetch ABI version
+    auto* wbcffi_version = symbol<const size_t>("wbcffi_version", true);
+    version_ = *wbcffi_version;
+    if (version_ != 1 && version_ != 2) {
+      throw std::runtime_error{"Unknown wbcffi_version " + std::to_string(version_)};
+    }
+
+    // Mandatory functions
+    init_ = symbol<InitFn>("wbcffi_init", true);
+    deinit_ = symbol<DeinitFn>("wbcffi_deinit", true);
+    // Optional functions
+    update_ = symbol<UpdateFn>("wbcffi_update", false);
+    refresh_ = symbol<RefreshFn>("wbcffi_refresh", false);
+    do_action_ = symbol<DoActionFn>("wbcffi_doaction", false);
+
+    if (version_ >= 2) {
+      shared_init_ = symbol<SharedInitFn>("wbcffi_shared_init", false);
+      shared_deinit_ = symbol<SharedDeinitFn>("wbcffi_shared_deinit", shared_init_ != nullptr);
+      if (shared_init_ == nullptr && shared_deinit_ != nullptr) {
+        throw std::runtime_error{"Missing wbcffi_shared_init function"};
+      }
+    }
+  } catch (...) {
+    dlclose(handle_);
+    throw;
+  }
+}
+
+Plugin::~Plugin() { dlclose(handle_); }
+
+template <typename T>
+T* Plugin::symbol(const char* name, bool required) const {
+  dlerror();
+  auto* sym = reinterpret_cast<T*>(dlsym(handle_, name));
+  if (sym == nullptr && required) {
+    const char* err = dlerror();
+    throw std::runtime_error{std::string{"Missing "} + name + " symbol" +
+                             (err != nullptr ? std::string{": "} + err : "")};
+  }
+  return sym;
+}
+
+void* Plugin::init(const wbcffi_init_info& info, const Json::Value& config) const {
+  // Convert JSON values to string
+  std::vector<std::string> config_entries_stringstor;
+  const auto& keys = config.getMemberNames();
+  for (const auto& key : keys) {
+    const auto& value = config[key];
+    if (value.isConvertibleTo(Json::ValueType::stringValue)) {
+      config_entries_stringstor.push_back(value.asString());
+    } else {
+      config_entries_stringstor.push_back(value.toStyledString());
+    }
+  }
+
+  // Prepare config_entries array
+  std::vector<wbcffi_config_entry> config_entries;
+  for (size_t i = 0; i < keys.size(); i++) {
+    config_entries.push_back({keys[i].c_str(), config_entries_stringstor[i].c_str()});
+  }
+
+  return init_(&info, config_entries.data(), config_entries.size());
+}
+
+void Plugin::update(void* instance) const {
+  if (update_ != nullptr) {
+    update_(instance);
+  }
+}
+
+void Plugin::refresh(void* instance, int signal) const {
+  if (refresh_ != nullptr) {
+    refresh_(instance, signal);
+  }
+}
+
+void Plugin::doAction(void* instance, const char* name) const {
+  if (do_action_ != nullptr) {
+    do_action_(instance, name);
+  }
+}
+
+void* Plugin::sharedInit(const wbcffi_init_info& info) const {
+  return shared_init_ != nullptr ? shared_init_(&info) : nullptr;
+}
+
+}  // namespace waybar::modules::ffi
@@ -3,6 +3,7 @@
 #include <spdlog/spdlog.h>
 
 #include "util/scope_guard.hpp"
+#include "util/text.hpp"
 
 waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
                                 const Json::Value& config, const std::string& output_name)
@@ -135,10 +136,9 @@ void waybar::modules::Custom::handleEvent() {
   }
 }
 
-bool waybar::modules::Custom::handleScroll(GdkEventScroll* e) {
-  auto ret = ALabel::handleScroll(e);
+void waybar::modules::Custom::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
+  ALabel::handleScrollSteps(dir, steps);
   handleEvent();
-  return ret;
 }
 
 bool waybar::modules::Custom::handleToggle(GdkEventButton* const& e) {
@@ -214,8 +214,8 @@ void waybar::modules::Custom::parseOutputRaw() {
 
     if (i == 0) {
       if (config_["escape"].isBool() && config_["escape"].asBool()) {
-        text_ = Glib::Markup::escape_text(validated_line);
-        tooltip_ = Glib::Markup::escape_text(validated_line);
+        text_ = util::escape_markup(validated_line.raw());
+        tooltip_ = util::escape_markup(validated_line.raw());
       } else {
         text_ = validated_line;
         tooltip_ = validated_line;
@@ -224,7 +224,7 @@ void waybar::modules::Custom::parseOutputRaw() {
       class_.clear();
     } else if (i == 1) {
       if (config_["escape"].isBool() && config_["escape"].asBool()) {
-        tooltip_ = Glib::Markup::escape_text(validated_line);
+        tooltip_ = util::escape_markup(validated_line.raw());
       } else {
         tooltip_ = validated_line;
       }
@@ -244,17 +244,17 @@ void waybar::modules::Custom::parseOutputJson() {
   while (getline(output, line)) {
     auto parsed = parser_.parse(line);
     if (config_["escape"].isBool() && config_["escape"].asBool()) {
-      text_ = Glib::Markup::escape_text(parsed["text"].asString());
+      text_ = util::escape_markup(parsed["text"].asString());
     } else {
       text_ = parsed["text"].asString();
     }
     if (config_["escape"].isBool() && config_["escape"].asBool()) {
-      alt_ = Glib::Markup::escape_text(parsed["alt"].asString());
+      alt_ = util::escape_markup(parsed["alt"].asString());
     } else {
       alt_ = parsed["alt"].asString();
     }
     if (config_["escape"].isBool() && config_["escape"].asBool()) {
-      tooltip_ = Glib::Markup::escape_text(parsed["tooltip"].asString());
+      tooltip_ = util::escape_markup(parsed["tooltip"].asString());
     } else {
       tooltip_ = parsed["tooltip"].asString();
     }
@@ -0,0 +1,279 @@
+#include "modules/dwl/status.hpp"
+
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+#include <wayland-client.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace waybar::modules::dwl {
+
+static void toggle_visibility(void *data, zdwl_ipc_output_v2 *zdwl_output_v2) {
+  // Intentionally empty
+}
+
+static void active(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, uint32_t active) {
+  static_cast<Status *>(data)->handle_active(zdwl_output_v2, active);
+}
+
+static void set_tag(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, uint32_t tag, uint32_t state,
+                    uint32_t clients, uint32_t focused) {
+  static_cast<Status *>(data)->handle_tag(zdwl_output_v2, tag, state, clients, focused);
+}
+
+static void set_layout_symbol(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, const char *layout) {
+  static_cast<Status *>(data)->handle_layout_symbol(zdwl_output_v2, layout);
+}
+
+static void title(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, const char *title) {
+  static_cast<Status *>(data)->handle_title(zdwl_output_v2, title);
+}
+
+static void dwl_frame(void *data, zdwl_ipc_output_v2 *zdwl_output_v2) {
+  static_cast<Status *>(data)->handle_frame(zdwl_output_v2);
+}
+
+static void set_layout(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, uint32_t layout) {
+  static_cast<Status *>(data)->handle_layout(zdwl_output_v2, layout);
+}
+
+static void appid(void *data, zdwl_ipc_output_v2 *zdwl_output_v2, const char *appid) {
+  static_cast<Status *>(data)->handle_appid(zdwl_output_v2, appid);
+};
+
+static const zdwl_ipc_output_v2_listener output_status_listener_impl{
+    .toggle_visibility = toggle_visibility,
+    .active = active,
+    .tag = set_tag,
+    .layout = set_layout,
+    .title = title,
+    .appid = appid,
+    .layout_symbol = set_layout_symbol,
+    .frame = dwl_frame,
+};
+
+static void handle_global(void *data, struct wl_registry *registry, uint32_t name,
+                          const char *interface, uint32_t version) {
+  if (std::strcmp(interface, zdwl_ipc_manager_v2_interface.name) == 0) {
+    static_cast<Status *>(data)->ipc_manager_ = static_cast<struct zdwl_ipc_manager_v2 *>(
+        (zdwl_ipc_manager_v2 *)wl_registry_bind(registry, name, &zdwl_ipc_manager_v2_interface, 1));
+  }
+  if (std::strcmp(interface, wl_seat_interface.name) == 0) {
+    version = std::min<uint32_t>(version, 1);
+    static_cast<Status *>(data)->seat_ = static_cast<struct wl_seat *>(
+        wl_registry_bind(registry, name, &wl_seat_interface, version));
+  }
+}
+
+static void handle_global_remove(void *data, struct wl_registry *registry, uint32_t name) {
+  /* Ignore event */
+}
+
+static const wl_registry_listener registry_listener_impl = {.global = handle_global,
+                                                            .global_remove = handle_global_remove};
+
+std::shared_ptr<Status> Status::getInstance(struct wl_display *display) {
+  static std::map<struct wl_display *, std::weak_ptr<Status>> instances;
+  std::erase_if(instances, [](const auto &entry) { return entry.second.expired(); });
+  auto &instance = instances[display];
+  auto status = instance.lock();
+  if (!status) {
+    status = std::shared_ptr<Status>(new Status(display));
+    instance = status;
+  }
+  return status;
+}
+
+Status::Status(struct wl_display *display) : ipc_manager_{nullptr}, seat_{nullptr} {
+  struct wl_registry *registry = wl_display_get_registry(display);
+  wl_registry_add_listener(registry, &registry_listener_impl, this);
+  wl_display_roundtrip(display);
+  wl_registry_destroy(registry);
+
+  if (!ipc_manager_) {
+    spdlog::error("dwl_status_manager_v2 not advertised");
+  }
+}
+
+Status::~Status() {
+  dispatch_conn_.disconnect();
+  for (auto &[output, entry] : outputs_) {
+    zdwl_ipc_output_v2_destroy(entry.ipc_output);
+  }
+  if (ipc_manager_) {
+    zdwl_ipc_manager_v2_destroy(ipc_manager_);
+  }
+}
+
+void Status::addListener(struct wl_output *output, StatusListener *listener) {
+  if (!ipc_manager_) {
+    return;
+  }
+
+  auto [it, inserted] =
+      outputs_.try_emplace(output, Output{output, nullptr, {}, StatusChange::ALL, 0});
+  auto &entry = it->second;
+  if (inserted) {
+    entry.ipc_output = zdwl_ipc_manager_v2_get_output(ipc_manager_, output);
+    zdwl_ipc_output_v2_add_listener(entry.ipc_output, &output_status_listener_impl, this);
+  }
+  ++entry.refs;
+
+  if (inserted) {
+    // the compositor sends the full state followed by a frame on creation
+    subscribers_.push_back({output, listener, 0});
+  } else {
+    subscribers_.push_back({output, listener, StatusChange::ALL});
+    scheduleDispatch();
+  }
+}
+
+void Status::removeListener(StatusListener *listener) {
+  for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+    if (it->listener != listener) {
+      ++it;
+      continue;
+    }
+
+    auto entry = outputs_.find(it->output);
+    if (entry != outputs_.end() && --entry->second.refs == 0) {
+      zdwl_ipc_output_v2_destroy(entry->second.ipc_output);
+      outputs_.erase(entry);
+    }
+    it = subscribers_.erase(it);
+  }
+}
+
+void Status::set_tags(struct wl_output *output, uint32_t tagmask, uint32_t toggle_tagset) {
+  auto entry = outputs_.find(output);
+  if (entry == outputs_.end()) {
+    return;
+  }
+  zdwl_ipc_output_v2_set_tags(entry->second.ipc_output, tagmask, toggle_tagset);
+}
+
+Status::Output *Status::findOutput(struct zdwl_ipc_output_v2 *ipc_output) {
+  for (auto &[output, entry] : outputs_) {
+    if (entry.ipc_output == ipc_output) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void Status::scheduleDispatch() {
+  if (dispatch_conn_.connected()) {
+    return;
+  }
+  dispatch_conn_ = Glib::signal_idle().connect([this] {
+    dispatch();
+    return false;
+  });
+}
+
+void Status::dispatch() {
+  for (auto &subscriber : subscribers_) {
+    if (subscriber.pending == 0) {
+      continue;
+    }
+    auto entry = outputs_.find(subscriber.output);
+    if (entry == outputs_.end()) {
+      continue;
+    }
+    const auto changed = subscriber.pending;
+    subscriber.pending = 0;
+    subscriber.listener->handle_status(entry->second.state, changed);
+  }
+}
+
+void Status::handle_active(struct zdwl_ipc_output_v2 *ipc_output, uint32_t active) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || entry->state.active == (active != 0)) {
+    return;
+  }
+  entry->state.active = active != 0;
+  entry->changed |= StatusChange::ACTIVE;
+}
+
+void Status::handle_tag(struct zdwl_ipc_output_v2 *ipc_output, uint32_t tag, uint32_t state,
+                        uint32_t clients, uint32_t focused) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || tag >= 32) {
+    return;
+  }
+
+  auto &tags = entry->state.tags;
+  if (tags.size() <= tag) {
+    tags.resize(tag + 1);
+  }
+  const TagState tag_state{state, clients, focused};
+  if (tags[tag] == tag_state) {
+    return;
+  }
+  tags[tag] = tag_state;
+  entry->state.active_tags = (state & ZDWL_IPC_OUTPUT_V2_TAG_STATE_ACTIVE)
+                                 ? entry->state.active_tags | (1 << tag)
+                                 : entry->state.active_tags & ~(1 << tag);
+  entry->changed |= StatusChange::TAGS;
+}
+
+void Status::handle_layout(struct zdwl_ipc_output_v2 *ipc_output, uint32_t layout) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || entry->state.layout == layout) {
+    return;
+  }
+  entry->state.layout = layout;
+  entry->changed |= StatusChange::LAYOUT;
+}
+
+void Status::handle_title(struct zdwl_ipc_output_v2 *ipc_output, const char *title) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || entry->state.title == title) {
+    return;
+  }
+  entry->state.title = title;
+  entry->changed |= StatusChange::TITLE;
+}
+
+void Status::handle_appid(struct zdwl_ipc_output_v2 *ipc_output, const char *appid) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || entry->state.appid == appid) {
+    return;
+  }
+  entry->state.appid = appid;
+  entry->changed |= StatusChange::APPID;
+}
+
+void Status::handle_layout_symbol(struct zdwl_ipc_output_v2 *ipc_output,
+                                  const char *layout_symbol) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr || entry->state.layout_symbol == layout_symbol) {
+    return;
+  }
+  entry->state.layout_symbol = layout_symbol;
+  entry->changed |= StatusChange::LAYOUT_SYMBOL;
+}
+
+void Status::handle_frame(struct zdwl_ipc_output_v2 *ipc_output) {
+  auto *entry = findOutput(ipc_output);
+  if (entry == nullptr) {
+    return;
+  }
+  const auto changed = entry->changed;
+  entry->changed = 0;
+  if (changed == 0) {
+    return;
+  }
+
+  for (auto &subscriber : subscribers_) {
+    if (subscriber.output != entry->output) {
+      continue;
+    }
+    const auto pending = subscriber.pending | changed;
+    subscriber.pending = 0;
+    subscriber.listener->handle_status(entry->state, pending);
+  }
+}
+
+}  // namespace waybar::modules::dwl
@@ -13,6 +13,9 @@
 #include <string>
 #include <thread>
 
+#include "util/profiler.hpp"
+#include "util/thread.hpp"
+
 namespace waybar::modules::hyprland {
 
 std::filesystem::path IPC::socketFolder_;
@@ -45,7 +48,7 @@ std::filesystem::path IPC::getSocketFolder(const char* instanceSig) {
 void IPC::startIPC() {
   // will start IPC and relay events to parseIPC
 
-  std::thread([&]() {
+  util::Thread("hyprland-ipc", [&]() {
     // check for hyprland
     const char* his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
 
@@ -82,6 +85,9 @@ void IPC::startIPC() {
 
     auto* file = fdopen(socketfd, "r");
 
+    // events from now on are queued on the socket, so none is missed between the two
+    seedSubmap();
+
     while (true) {
       std::array<char, 1024> buffer;  // Hyprland socket2 events are max 1024 bytes
 
@@ -97,6 +103,7 @@ void IPC::startIPC() {
       spdlog::debug("hyprland IPC received {}", messageReceived);
 
       try {
+        util::Profiler::Scope scope(util::Profiler::account("hyprland-ipc"));
         parseIPC(messageReceived);
       } catch (std::exception& e) {
         spdlog::warn("Failed to parse IPC message: {}, reason: {}", messageReceived, e.what());
@@ -111,6 +118,12 @@ void IPC::startIPC() {
 
 void IPC::parseIPC(const std::string& ev) {
   std::string request = ev.substr(0, ev.find_first_of('>'));
+
+  // Hyprland re-emits the submap event when the same submap is entered again
+  if (request == "submap" && !updateSubmap(ev)) {
+    return;
+  }
+
   std::unique_lock lock(callbackMutex_);
 
   for (auto& [eventname, handler] : callbacks_) {
@@ -218,8 +231,82 @@ std::string IPC::getSocket1Reply(const std::string& rq) {
   return response;
 }
 
+IPC::~IPC() {
+  {
+    std::unique_lock lock(dispatchMutex_);
+    dispatchStop_ = true;
+  }
+  dispatchCv_.notify_all();
+  if (dispatchThread_.joinable()) {
+    dispatchThread_.join();
+  }
+}
+
+void IPC::dispatch(const std::string& rq) {
+  {
+    std::unique_lock lock(dispatchMutex_);
+    dispatchQueue_.push_back(rq);
+    if (!dispatchThread_.joinable()) {
+      dispatchThread_ = util::Thread("hyprland-dispatch", [this] { dispatchWorker(); },
+                                     util::Thread::SHALLOW_STACK_SIZE);
+    }
+  }
+  dispatchCv_.notify_one();
+}
+
+void IPC::dispatchWorker() {
+  std::unique_lock lock(dispatchMutex_);
+  while (true) {
+    dispatchCv_.wait(lock, [this] { return dispatchStop_ || !dispatchQueue_.empty(); });
+    if (dispatchStop_) {
+      return;
+    }
+    auto rq = std::move(dispatchQueue_.front());
+    dispatchQueue_.pop_front();
+
+    lock.unlock();
+    util::Profiler::Scope scope(util::Profiler::account("hyprland-dispatch"));
+    auto reply = getSocket1Reply(rq);
+    if (!reply.starts_with("ok")) {
+      spdlog::warn("Hyprland IPC: {} failed: {}", rq, reply);
+    }
+    lock.lock();
+  }
+}
+
 Json::Value IPC::getSocket1JsonReply(const std::string& rq) {
   return parser_.parse(getSocket1Reply("j/" + rq));
 }
 
+std::string IPC::getSubmap() {
+  std::unique_lock lock(submapMutex_);
+  return submap_.value_or("");
+}
+
+void IPC::seedSubmap() {
+  std::string submap;
+  try {
+    submap = getSocket1Reply("submap");
+    submap = submap.substr(0, submap.find_first_of('\n'));
+  } catch (const std::exception& e) {
+    spdlog::warn("Hyprland IPC: unable to query the submap: {}", e.what());
+  }
+  // "default" is reported for no active submap, older Hyprland versions don't know the request
+  if (submap == "default" || submap.starts_with("unknown request")) {
+    submap.clear();
+  }
+  // as if the submap had been entered, modules that rendered before now get the real one
+  parseIPC("submap>>" + submap);
+}
+
+bool IPC::updateSubmap(const std::string& ev) {
+  auto submap = ev.substr(ev.find_last_of('>') + 1);
+  std::unique_lock lock(submapMutex_);
+  if (submap_ == submap) {
+    return false;
+  }
+  submap_ = std::move(submap);
+  return true;
+}
+
 }  // namespace waybar::modules::hyprland
@@ -2,10 +2,24 @@
 
 #include <spdlog/spdlog.h>
 
+#include <unordered_map>
+
 #include "util/sanitize_str.hpp"
 
 namespace waybar::modules::hyprland {
 
+namespace {
+
+struct RenderedSubmap {
+  std::string submap;
+  std::string markup;
+};
+
+// Bars with the same format share the last rendering, all updates run on the GTK thread
+std::unordered_map<std::string, RenderedSubmap> renderedSubmaps;
+
+}  // namespace
+
 Submap::Submap(const std::string& id, const Bar& bar, const Json::Value& config)
     : ALabel(config, "submap", id, "{}", 0, true), bar_(bar) {
   modulesReady = true;
@@ -19,14 +33,7 @@ Submap::Submap(const std::string& id, const Bar& bar, const Json::Value& config)
   label_.hide();
   ALabel::update();
 
-  // Displays widget immediately if always_on_ assuming default submap
-  // Needs an actual way to retrive current submap on startup
-  if (always_on_) {
-    submap_ = default_submap_;
-    label_.get_style_context()->add_class(submap_);
-  }
-
-  // register for hyprland ipc
+  // register for hyprland ipc, the backend only forwards actual submap changes
   gIPC->registerForIPC("submap", this);
   dp.emit();
 }
@@ -52,43 +59,41 @@ auto Submap::parseConfig(const Json::Value& config) -> void {
 auto Submap::update() -> void {
   std::lock_guard<std::mutex> lg(mutex_);
 
-  if (submap_.empty()) {
-    event_box_.hide();
-  } else {
-    label_.set_markup(fmt::format(fmt::runtime(format_), submap_));
-    if (tooltipEnabled()) {
-      label_.set_tooltip_text(submap_);
-    }
-    event_box_.show();
+  auto submap = waybar::util::sanitize_string(gIPC->getSubmap());
+  if (submap.empty() && always_on_) {
+    submap = default_submap_;
   }
-  // Call parent update
-  ALabel::update();
-}
 
-void Submap::onEvent(const std::string& ev) {
-  std::lock_guard<std::mutex> lg(mutex_);
-
-  if (ev.find("submap") == std::string::npos) {
+  if (rendered_ && submap == submap_) {
     return;
   }
-
-  auto submapName = ev.substr(ev.find_last_of('>') + 1);
-  submapName = waybar::util::sanitize_string(submapName);
+  rendered_ = true;
 
   if (!submap_.empty()) {
     label_.get_style_context()->remove_class(submap_);
   }
+  submap_ = submap;
+  spdlog::debug("hyprland submap update with {}", submap_);
 
-  submap_ = submapName;
+  if (submap_.empty()) {
+    event_box_.hide();
+  } else {
+    label_.get_style_context()->add_class(submap_);
 
-  if (submap_.empty() && always_on_) {
-    submap_ = default_submap_;
+    auto& rendered = renderedSubmaps[format_];
+    if (rendered.markup.empty() || rendered.submap != submap_) {
+      rendered.submap = submap_;
+      rendered.markup = fmt::format(fmt::runtime(format_), submap_);
+    }
+    label_.set_markup(rendered.markup);
+    if (tooltipEnabled()) {
+      label_.set_tooltip_text(submap_);
+    }
+    event_box_.show();
   }
-
-  label_.get_style_context()->add_class(submap_);
-
-  spdlog::debug("hyprland submap onevent with {}", submap_);
-
-  dp.emit();
+  // Call parent update
+  ALabel::update();
 }
+
+void Submap::onEvent(const std::string& ev) { dp.emit(); }
 }  // namespace waybar::modules::hyprland
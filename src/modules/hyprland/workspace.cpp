@@ -56,25 +56,29 @@ std::optional<std::string> Workspace::closeWindow(WindowAddress const &addr) {
   return std::nullopt;
 }
 
-bool Workspace::handleClicked(GdkEventButton *bt) const {
+bool Workspace::handleClicked(GdkEventButton *bt) {
   if (bt->type == GDK_BUTTON_PRESS) {
     try {
       if (id() > 0) {  // normal
         if (m_workspaceManager.moveToMonitor()) {
-          gIPC->getSocket1Reply("dispatch focusworkspaceoncurrentmonitor " + std::to_string(id()));
+          gIPC->dispatch("dispatch focusworkspaceoncurrentmonitor " + std::to_string(id()));
         } else {
-          gIPC->getSocket1Reply("dispatch workspace " + std::to_string(id()));
+          gIPC->dispatch("dispatch workspace " + std::to_string(id()));
         }
       } else if (!isSpecial()) {  // named (this includes persistent)
         if (m_workspaceManager.moveToMonitor()) {
-          gIPC->getSocket1Reply("dispatch focusworkspaceoncurrentmonitor name:" + name());
+          gIPC->dispatch("dispatch focusworkspaceoncurrentmonitor name:" + name());
         } else {
-          gIPC->getSocket1Reply("dispatch workspace name:" + name());
+          gIPC->dispatch("dispatch workspace name:" + name());
         }
       } else if (id() != -99) {  // named special
-        gIPC->getSocket1Reply("dispatch togglespecialworkspace " + name());
+        gIPC->dispatch("dispatch togglespecialworkspace " + name());
       } else {  // special
-        gIPC->getSocket1Reply("dispatch togglespecialworkspace");
+        gIPC->dispatch("dispatch togglespecialworkspace");
+      }
+      if (!isSpecial()) {
+        // show the switch right away, the workspace event confirms it
+        m_workspaceManager.activateWorkspace(name());
       }
       return true;
     } catch (const std::exception &e) {
@@ -84,6 +88,10 @@ bool Workspace::handleClicked(GdkEventButton *bt) const {
   return false;
 }
 
+void Workspace::updateActiveClass() {
+  addOrRemoveClass(m_button.get_style_context(), isActive(), "active");
+}
+
 void Workspace::initializeWindowMap(const Json::Value &clients_data) {
   m_windowMap.clear();
   for (auto client : clients_data) {
@@ -348,6 +348,18 @@ void Workspaces::onEvent(const std::string &ev) {
   dp.emit();
 }
 
+void Workspaces::activateWorkspace(std::string const &workspace_name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_activeWorkspaceName = workspace_name;
+  for (auto &workspace : m_workspaces) {
+    if (workspace->isSpecial()) {
+      continue;
+    }
+    workspace->setActive(workspace->name() == m_activeWorkspaceName);
+    workspace->updateActiveClass();
+  }
+}
+
 void Workspaces::onWorkspaceActivated(std::string const &payload) {
   m_activeWorkspaceName = payload;
 }
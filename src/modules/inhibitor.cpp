@@ -1,60 +1,7 @@
 #include "modules/inhibitor.hpp"
 
-#include <gio/gio.h>
-#include <gio/gunixfdlist.h>
-#include <spdlog/spdlog.h>
-
 namespace {
 
-using DBus = std::unique_ptr<GDBusConnection, void (*)(GDBusConnection*)>;
-
-auto dbus() -> DBus {
-  GError* error = nullptr;
-  GDBusConnection* connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
-
-  if (error) {
-    spdlog::error("g_bus_get_sync() failed: {}", error->message);
-    g_error_free(error);
-    connection = nullptr;
-  }
-
-  auto destructor = [](GDBusConnection* connection) {
-    GError* error = nullptr;
-    g_dbus_connection_close_sync(connection, nullptr, &error);
-    if (error) {
-      spdlog::error("g_bus_connection_close_sync failed(): {}", error->message);
-      g_error_free(error);
-    }
-  };
-
-  return DBus{connection, destructor};
-}
-
-auto getLocks(const DBus& bus, const std::string& inhibitors) -> int {
-  GError* error = nullptr;
-  GUnixFDList* fd_list;
-  int handle;
-
-  auto reply = g_dbus_connection_call_with_unix_fd_list_sync(
-      bus.get(), "org.freedesktop.login1", "/org/freedesktop/login1",
-      "org.freedesktop.login1.Manager", "Inhibit",
-      g_variant_new("(ssss)", inhibitors.c_str(), "waybar", "Asked by user", "block"),
-      G_VARIANT_TYPE("(h)"), G_DBUS_CALL_FLAGS_NONE, -1, nullptr, &fd_list, nullptr, &error);
-  if (error) {
-    spdlog::error("g_dbus_connection_call_with_unix_fd_list_sync() failed: {}", error->message);
-    g_error_free(error);
-    handle = -1;
-  } else {
-    gint index;
-    g_variant_get(reply, "(h)", &index);
-    g_variant_unref(reply);
-    handle = g_unix_fd_list_get(fd_list, index, nullptr);
-    g_object_unref(fd_list);
-  }
-
-  return handle;
-}
-
 auto checkInhibitor(const std::string& inhibitor) -> const std::string& {
   static const auto inhibitors = std::array{"idle",
                                             "shutdown",
@@ -99,20 +46,22 @@ namespace waybar::modules {
 
 Inhibitor::Inhibitor(const std::string& id, const Bar& bar, const Json::Value& config)
     : ALabel(config, "inhibitor", id, "{status}", true),
-      dbus_(::dbus()),
-      inhibitors_(::getInhibitors(config)) {
+      inhibitor_(util::LogindInhibitor::getInstance()),
+      inhibitors_(util::LogindInhibitor::normalize(::getInhibitors(config))) {
+  // every bar renders from the shared lock state
+  changed_ = inhibitor_->signal_changed().connect([this](const std::string& what) {
+    if (what == inhibitors_) {
+      dp.emit();
+    }
+  });
   event_box_.add_events(Gdk::BUTTON_PRESS_MASK);
   event_box_.signal_button_press_event().connect(sigc::mem_fun(*this, &Inhibitor::handleToggle));
   dp.emit();
 }
 
-Inhibitor::~Inhibitor() {
-  if (handle_ != -1) {
-    ::close(handle_);
-  }
-}
+Inhibitor::~Inhibitor() { changed_.disconnect(); }
 
-auto Inhibitor::activated() -> bool { return handle_ != -1; }
+auto Inhibitor::activated() -> bool { return inhibitor_->active(inhibitors_); }
 
 auto Inhibitor::update() -> void {
   std::string status_text = activated() ? "activated" : "deactivated";
@@ -131,15 +80,8 @@ auto Inhibitor::update() -> void {
 
 auto Inhibitor::handleToggle(GdkEventButton* const& e) -> bool {
   if (e->button == 1) {
-    if (activated()) {
-      ::close(handle_);
-      handle_ = -1;
-    } else {
-      handle_ = ::getLocks(dbus_, inhibitors_);
-      if (handle_ == -1) {
-        spdlog::error("cannot get inhibitor locks");
-      }
-    }
+    // logind replies asynchronously, the label follows on signal_changed
+    inhibitor_->toggle(inhibitors_);
   }
 
   return ALabel::handleToggle(e);
@@ -143,7 +143,7 @@ waybar::modules::KeyboardState::KeyboardState(const std::string& id, const Bar&
     }
   }
 
-  auto keys = config_["binding-keys"];
+  const auto& keys = config_["binding-keys"];
   if (keys.isArray()) {
     for (const auto& key : keys) {
       if (key.isInt()) {
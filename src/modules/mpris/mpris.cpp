@@ -5,8 +5,10 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include "util/scope_guard.hpp"
+#include "util/text.hpp"
 
 extern "C" {
 #include <playerctl/playerctl.h>
@@ -191,73 +193,42 @@ auto Mpris::getIconFromJson(const Json::Value& icons, const std::string& key) ->
   return "";
 }
 
-// Wide characters count as two, zero-width characters count as zero
-// Modifies str in-place (unless width = std::string::npos)
-// Returns the total width of the string pre-truncating
-size_t utf8_truncate(std::string& str, size_t width = std::string::npos) {
-  if (str.length() == 0) return 0;
-
-  const gchar* trunc_end = nullptr;
-
-  size_t total_width = 0;
-
-  for (gchar *data = str.data(), *end = data + str.size(); data != nullptr;) {
-    gunichar c = g_utf8_get_char_validated(data, end - data);
-    if (c == -1U || c == -2U) {
-      // invalid unicode, treat string as ascii
-      if (width != std::string::npos && str.length() > width) str.resize(width);
-      return str.length();
-    } else if (g_unichar_iswide(c)) {
-      total_width += 2;
-    } else if (!g_unichar_iszerowidth(c) && c != 0xAD) {  // neither zero-width nor soft hyphen
-      total_width += 1;
-    }
-
-    data = g_utf8_find_next_char(data, end);
-    if (width != std::string::npos && total_width <= width && !g_unichar_isspace(c))
-      trunc_end = data;
-  }
-
-  if (trunc_end) str.resize(trunc_end - str.data());
-
-  return total_width;
+// Size of str without trailing whitespace, the full size for invalid UTF-8
+static size_t trimmedSize(const std::string& str) {
+  const gchar* begin = str.data();
+  const gchar* end = begin + str.size();
+  if (!g_utf8_validate(begin, str.size(), nullptr)) return str.size();
+  while (end != begin) {
+    const gchar* prev = g_utf8_find_prev_char(begin, end);
+    if (!g_unichar_isspace(g_utf8_get_char(prev))) break;
+    end = prev;
+  }
+  return end - begin;
 }
 
-size_t utf8_width(const std::string& str) { return utf8_truncate(const_cast<std::string&>(str)); }
-
-void truncate(std::string& s, const std::string& ellipsis, size_t max_len) {
-  if (max_len == 0) {
-    s.resize(0);
-    return;
-  }
-  size_t len = utf8_truncate(s, max_len);
-  if (len > max_len) {
-    size_t ellipsis_len = utf8_width(ellipsis);
-    if (max_len >= ellipsis_len) {
-      if (ellipsis_len) utf8_truncate(s, max_len - ellipsis_len);
-      s += ellipsis;
-    } else {
-      s.resize(0);
+auto Mpris::truncateText(const std::string& str, int max_len, bool html) -> std::string {
+  util::TextOptions options{.escape = html, .ellipsis = ellipsis_};
+  if (max_len >= 0) options.max_width = max_len;
+  auto res = util::process_text(str, options);
+  // with a length limit, text that fits is still cut after its last non-space character
+  if (max_len >= 0 && !res.truncated) {
+    if (auto size = trimmedSize(str); size < str.size()) {
+      res = util::process_text(std::string_view(str).substr(0, size), options);
     }
   }
+  return res.str;
 }
 
-auto Mpris::getArtistStr(const PlayerInfo& info, bool truncated) -> std::string {
-  auto artist = info.artist.value_or(std::string());
-  if (truncated && artist_len_ >= 0) truncate(artist, ellipsis_, artist_len_);
-  return artist;
+auto Mpris::getArtistStr(const PlayerInfo& info, bool truncated, bool html) -> std::string {
+  return truncateText(info.artist.value_or(std::string()), truncated ? artist_len_ : -1, html);
 }
 
-auto Mpris::getAlbumStr(const PlayerInfo& info, bool truncated) -> std::string {
-  auto album = info.album.value_or(std::string());
-  if (truncated && album_len_ >= 0) truncate(album, ellipsis_, album_len_);
-  return album;
+auto Mpris::getAlbumStr(const PlayerInfo& info, bool truncated, bool html) -> std::string {
+  return truncateText(info.album.value_or(std::string()), truncated ? album_len_ : -1, html);
 }
 
-auto Mpris::getTitleStr(const PlayerInfo& info, bool truncated) -> std::string {
-  auto title = info.title.value_or(std::string());
-  if (truncated && title_len_ >= 0) truncate(title, ellipsis_, title_len_);
-  return title;
+auto Mpris::getTitleStr(const PlayerInfo& info, bool truncated, bool html) -> std::string {
+  return truncateText(info.title.value_or(std::string()), truncated ? title_len_ : -1, html);
 }
 
 auto Mpris::getLengthStr(const PlayerInfo& info, bool truncated) -> std::string {
@@ -284,9 +255,9 @@ auto Mpris::getDynamicStr(const PlayerInfo& info, bool truncated, bool html) ->
   // keep position format same as length format
   auto position = getPositionStr(info, truncated && truncate_hours_ && length.length() < 6);
 
-  size_t artistLen = utf8_width(artist);
-  size_t albumLen = utf8_width(album);
-  size_t titleLen = utf8_width(title);
+  size_t artistLen = util::text_width(artist);
+  size_t albumLen = util::text_width(album);
+  size_t titleLen = util::text_width(title);
   size_t lengthLen = length.length();
   size_t posLen = position.length();
 
@@ -305,7 +276,7 @@ auto Mpris::getDynamicStr(const PlayerInfo& info, bool truncated, bool html) ->
     // Since the first element doesn't present a separator and we don't know a priori which one
     // it will be, we add a "virtual separatorLen" to the dynamicLen, since we are adding the
     // separatorLen to all the other lengths.
-    size_t separatorLen = utf8_width(dynamic_separator_);
+    size_t separatorLen = util::text_width(dynamic_separator_);
     size_t dynamicLen = dynamic_len_ + separatorLen;
     if (showArtist) artistLen += separatorLen;
     if (showAlbum) albumLen += separatorLen;
@@ -354,9 +325,9 @@ auto Mpris::getDynamicStr(const PlayerInfo& info, bool truncated, bool html) ->
 
   std::stringstream dynamic;
   if (html) {
-    artist = Glib::Markup::escape_text(artist);
-    album = Glib::Markup::escape_text(album);
-    title = Glib::Markup::escape_text(title);
+    artist = util::escape_markup(artist);
+    album = util::escape_markup(album);
+    title = util::escape_markup(title);
   }
 
   bool lengthOrPositionShown = false;
@@ -690,11 +661,10 @@ auto Mpris::update() -> void {
   try {
     auto label_format = fmt::format(
         fmt::runtime(formatstr),
-        fmt::arg("player", std::string(Glib::Markup::escape_text(info.name))),
-        fmt::arg("status", info.status_string),
-        fmt::arg("artist", std::string(Glib::Markup::escape_text(getArtistStr(info, true)))),
-        fmt::arg("title", std::string(Glib::Markup::escape_text(getTitleStr(info, true)))),
-        fmt::arg("album", std::string(Glib::Markup::escape_text(getAlbumStr(info, true)))),
+        fmt::arg("player", util::escape_markup(info.name)), fmt::arg("status", info.status_string),
+        fmt::arg("artist", getArtistStr(info, true, true)),
+        fmt::arg("title", getTitleStr(info, true, true)),
+        fmt::arg("album", getAlbumStr(info, true, true)),
         fmt::arg("length", length), fmt::arg("position", position),
         fmt::arg("dynamic", getDynamicStr(info, true, true)),
         fmt::arg("player_icon", getIconFromJson(config_["player-icons"], info.name)),
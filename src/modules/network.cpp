@@ -4,79 +4,27 @@
 #include <spdlog/spdlog.h>
 #include <sys/eventfd.h>
 
+// fmt::dynamic_format_arg_store moved to fmt/args.h in fmt 8
+#if (FMT_VERSION >= 80000)
+#include <fmt/args.h>
+#endif
+
+#include <algorithm>
 #include <cassert>
-#include <fstream>
 #include <optional>
-#include <sstream>
+#include <vector>
 
 #include "util/format.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
 #endif
+#include "util/text.hpp"
 
 namespace {
 using namespace waybar::util;
 constexpr const char *DEFAULT_FORMAT = "{ifname}";
 }  // namespace
 
-constexpr const char *NETDEV_FILE =
-    "/proc/net/dev";  // std::ifstream does not take std::string_view as param
-std::optional<std::pair<unsigned long long, unsigned long long>>
-waybar::modules::Network::readBandwidthUsage() {
-  std::ifstream netdev(NETDEV_FILE);
-  if (!netdev) {
-    spdlog::warn("Failed to open netdev file {}", NETDEV_FILE);
-    return {};
-  }
-
-  std::string line;
-  // skip the headers (first two lines)
-  std::getline(netdev, line);
-  std::getline(netdev, line);
-
-  unsigned long long receivedBytes = 0ull;
-  unsigned long long transmittedBytes = 0ull;
-  while (std::getline(netdev, line)) {
-    std::istringstream iss(line);
-
-    std::string ifacename;
-    iss >> ifacename;      // ifacename contains "eth0:"
-    ifacename.pop_back();  // remove trailing ':'
-    if (ifacename != ifname_) {
-      continue;
-    }
-
-    // The rest of the line consists of whitespace separated counts divided
-    // into two groups (receive and transmit). Each group has the following
-    // columns: bytes, packets, errs, drop, fifo, frame, compressed, multicast
-    //
-    // We only care about the bytes count, so we'll just ignore the 7 other
-    // columns.
-    unsigned long long r = 0ull;
-    unsigned long long t = 0ull;
-    // Read received bytes
-    iss >> r;
-    // Skip all the other columns in the received group
-    for (int colsToSkip = 7; colsToSkip > 0; colsToSkip--) {
-      // skip whitespace between columns
-      while (iss.peek() == ' ') {
-        iss.ignore();
-      }
-      // skip the irrelevant column
-      while (iss.peek() != ' ') {
-        iss.ignore();
-      }
-    }
-    // Read transmit bytes
-    iss >> t;
-
-    receivedBytes += r;
-    transmittedBytes += t;
-  }
-
-  return {{receivedBytes, transmittedBytes}};
-}
-
 waybar::modules::Network::Network(const std::string &id, const Json::Value &config)
     : ALabel(config, "network", id, DEFAULT_FORMAT, 60),
       ifid_(-1),
@@ -88,6 +36,7 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
       want_addr_dump_(false),
       dump_in_progress_(false),
       is_p2p_(false),
+      multi_(config["interface"].isArray()),
       cidr_(0),
       signal_strength_dbm_(0),
       signal_strength_(0),
@@ -102,16 +51,9 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
   // the module start with no text, but the event_box_ is shown.
   label_.set_markup("<s></s>");
 
-  auto bandwidth = readBandwidthUsage();
-  if (bandwidth.has_value()) {
-    bandwidth_down_total_ = (*bandwidth).first;
-    bandwidth_up_total_ = (*bandwidth).second;
-  } else {
-    bandwidth_down_total_ = 0;
-    bandwidth_up_total_ = 0;
-  }
+  bandwidth_.sample(readNetDev());
 
-  if (!config_["interface"].isString()) {
+  if (!config_["interface"].isString() && !multi_) {
     // "interface" isn't configured, then try to guess the external
     // interface currently used for internet.
     want_route_dump_ = true;
@@ -175,7 +117,7 @@ void waybar::modules::Network::createEventSocket() {
   } else {
     nl_socket_add_membership(ev_sock_, RTNLGRP_IPV6_IFADDR);
   }
-  if (!config_["interface"].isString()) {
+  if (!config_["interface"].isString() && !multi_) {
     if (family_ == AF_INET) {
       nl_socket_add_membership(ev_sock_, RTNLGRP_IPV4_ROUTE);
     } else {
@@ -294,19 +236,19 @@ auto waybar::modules::Network::update() -> void {
   std::lock_guard<std::mutex> lock(mutex_);
   std::string tooltip_format;
 
-  auto bandwidth = readBandwidthUsage();
-  auto bandwidth_down = 0ull;
-  auto bandwidth_up = 0ull;
-  if (bandwidth.has_value()) {
-    auto down_octets = (*bandwidth).first;
-    auto up_octets = (*bandwidth).second;
-
-    bandwidth_down = down_octets - bandwidth_down_total_;
-    bandwidth_down_total_ = down_octets;
-
-    bandwidth_up = up_octets - bandwidth_up_total_;
-    bandwidth_up_total_ = up_octets;
+  // one snapshot of the counters serves every tracked interface
+  bandwidth_.sample(readNetDev());
+  util::NetDevBytes moved;
+  if (multi_) {
+    for (const auto &[index, iface] : interfaces_) {
+      moved += bandwidth_.moved(iface.ifname);
+    }
+  } else {
+    moved = bandwidth_.moved(ifname_);
   }
+  auto bandwidth_down = moved.down;
+  auto bandwidth_up = moved.up;
+  const auto interfaces = multi_ ? formatInterfaces() : std::string();
 
   if (!alt_) {
     auto state = getNetworkState();
@@ -349,7 +291,8 @@ auto waybar::modules::Network::update() -> void {
       fmt::arg("bandwidthDownBytes", pow_format(bandwidth_down / interval_.count(), "B/s")),
       fmt::arg("bandwidthUpBytes", pow_format(bandwidth_up / interval_.count(), "B/s")),
       fmt::arg("bandwidthTotalBytes",
-               pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "B/s")));
+               pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "B/s")),
+      fmt::arg("interfaces", interfaces));
   if (text.compare(label_.get_label()) != 0) {
     label_.set_markup(text);
     if (text.empty()) {
@@ -382,7 +325,8 @@ auto waybar::modules::Network::update() -> void {
           fmt::arg("bandwidthDownBytes", pow_format(bandwidth_down / interval_.count(), "B/s")),
           fmt::arg("bandwidthUpBytes", pow_format(bandwidth_up / interval_.count(), "B/s")),
           fmt::arg("bandwidthTotalBytes",
-                   pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "B/s")));
+                   pow_format((bandwidth_up + bandwidth_down) / interval_.count(), "B/s")),
+          fmt::arg("interfaces", interfaces));
       if (label_.get_tooltip_text() != tooltip_text) {
         label_.set_tooltip_markup(tooltip_text);
       }
@@ -396,11 +340,129 @@ auto waybar::modules::Network::update() -> void {
 }
 
 bool waybar::modules::Network::checkInterface(std::string name) {
-  if (config_["interface"].isString()) {
-    return config_["interface"].asString() == name ||
-           wildcardMatch(config_["interface"].asString(), name);
+  return matchInterface(name).has_value();
+}
+
+// Index of the first "interface" entry naming or matching name
+std::optional<size_t> waybar::modules::Network::matchInterface(const std::string &name) const {
+  const auto &interface = config_["interface"];
+  if (interface.isString()) {
+    auto pattern = interface.asString();
+    if (pattern == name || wildcardMatch(pattern, name)) {
+      return 0;
+    }
+  } else if (interface.isArray()) {
+    for (Json::ArrayIndex i = 0; i < interface.size(); ++i) {
+      if (!interface[i].isString()) {
+        continue;
+      }
+      auto pattern = interface[i].asString();
+      if (pattern == name || wildcardMatch(pattern, name)) {
+        return i;
+      }
+    }
   }
-  return false;
+  return std::nullopt;
+}
+
+// Fills the single interface fields from the most connected interface, ties going to the one
+// listed first in "interface"
+void waybar::modules::Network::selectPrimaryInterface() {
+  auto rank = [](const Interface &iface) {
+    if (!iface.up || !iface.carrier) return 0;
+    return iface.ipaddr.empty() ? 1 : 2;
+  };
+  auto best = interfaces_.end();
+  for (auto it = interfaces_.begin(); it != interfaces_.end(); ++it) {
+    if (best == interfaces_.end() || rank(it->second) > rank(best->second) ||
+        (rank(it->second) == rank(best->second) && it->second.pattern < best->second.pattern)) {
+      best = it;
+    }
+  }
+  if (best == interfaces_.end()) {
+    clearIface();
+    return;
+  }
+
+  const auto &[index, iface] = *best;
+  const bool connected = iface.up && iface.carrier;
+  const bool refresh = connected && (index != ifid_ || !carrier_);
+  if (index != ifid_ || !connected) {
+    // drops the WiFi details of the previous interface or connection
+    clearIface();
+  }
+  ifid_ = index;
+  ifname_ = iface.ifname;
+  carrier_ = connected;
+  is_p2p_ = iface.is_p2p;
+  ipaddr_ = iface.ipaddr;
+  netmask_ = iface.netmask;
+  cidr_ = iface.cidr;
+  if (refresh) {
+    // Ask for WiFi information
+    thread_timer_.wake_up();
+  }
+}
+
+// Every tracked interface that is up through "format-interface", joined for {interfaces}
+std::string waybar::modules::Network::formatInterfaces() const {
+  auto format = config_["format-interface"].isString() ? config_["format-interface"].asString()
+                                                        : std::string("{ifname}");
+  auto separator = config_["interface-separator"].isString()
+                       ? config_["interface-separator"].asString()
+                       : std::string(", ");
+
+  std::vector<const Interface *> listed;
+  for (const auto &[index, iface] : interfaces_) {
+    if (iface.up) {
+      listed.push_back(&iface);
+    }
+  }
+  std::stable_sort(listed.begin(), listed.end(),
+                   [](auto *a, auto *b) { return a->pattern < b->pattern; });
+
+  std::string text;
+  const auto interval = interval_.count();
+  for (const auto *iface : listed) {
+    auto moved = bandwidth_.moved(iface->ifname);
+    const char *state = !iface->carrier        ? "disconnected"
+                        : iface->ipaddr.empty() ? "linked"
+                                                : "connected";
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    store.push_back(fmt::arg("ifname", iface->ifname));
+    store.push_back(fmt::arg("ipaddr", iface->ipaddr));
+    store.push_back(fmt::arg("netmask", iface->netmask));
+    store.push_back(fmt::arg("cidr", iface->cidr));
+    store.push_back(fmt::arg("state", state));
+    store.push_back(
+        fmt::arg("bandwidthDownBits", pow_format(moved.down * 8ull / interval, "b/s")));
+    store.push_back(fmt::arg("bandwidthUpBits", pow_format(moved.up * 8ull / interval, "b/s")));
+    store.push_back(fmt::arg("bandwidthTotalBits",
+                             pow_format((moved.up + moved.down) * 8ull / interval, "b/s")));
+    store.push_back(fmt::arg("bandwidthDownOctets", pow_format(moved.down / interval, "o/s")));
+    store.push_back(fmt::arg("bandwidthUpOctets", pow_format(moved.up / interval, "o/s")));
+    store.push_back(
+        fmt::arg("bandwidthTotalOctets", pow_format((moved.up + moved.down) / interval, "o/s")));
+    store.push_back(fmt::arg("bandwidthDownBytes", pow_format(moved.down / interval, "B/s")));
+    store.push_back(fmt::arg("bandwidthUpBytes", pow_format(moved.up / interval, "B/s")));
+    store.push_back(
+        fmt::arg("bandwidthTotalBytes", pow_format((moved.up + moved.down) / interval, "B/s")));
+    if (!text.empty()) {
+      text += separator;
+    }
+    text += fmt::vformat(format, store);
+  }
+  return text;
+}
+
+std::string waybar::modules::Network::formatNetmask(int family, int prefixlen) {
+  unsigned char netmask[16] = {};
+  const int len = family == AF_INET ? 4 : 16;
+  for (int i = 0; i < len; i++) {
+    netmask[i] = static_cast<unsigned char>(0xff00 >> std::clamp(prefixlen - i * 8, 0, 8));
+  }
+  char buf[INET6_ADDRSTRLEN];
+  return inet_ntop(family, netmask, buf, sizeof(buf));
 }
 
 void waybar::modules::Network::clearIface() {
@@ -424,6 +486,10 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
   auto nh = nlmsg_hdr(msg);
   bool is_del_event = false;
 
+  if (net->multi_) {
+    return net->handleInterfacesEvent(nh);
+  }
+
   switch (nh->nlmsg_type) {
     case RTM_DELLINK:
       is_del_event = true;
@@ -548,23 +614,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
             if (!is_del_event) {
               net->ipaddr_ = inet_ntop(ifa->ifa_family, RTA_DATA(ifa_rta), ipaddr, sizeof(ipaddr));
               net->cidr_ = ifa->ifa_prefixlen;
-              switch (ifa->ifa_family) {
-                case AF_INET: {
-                  struct in_addr netmask;
-                  netmask.s_addr = htonl(~0 << (32 - ifa->ifa_prefixlen));
-                  net->netmask_ = inet_ntop(ifa->ifa_family, &netmask, ipaddr, sizeof(ipaddr));
-                }
-                case AF_INET6: {
-                  struct in6_addr netmask;
-                  for (int i = 0; i < 16; i++) {
-                    int v = (i + 1) * 8 - ifa->ifa_prefixlen;
-                    if (v < 0) v = 0;
-                    if (v > 8) v = 8;
-                    netmask.s6_addr[i] = ~0 << v;
-                  }
-                  net->netmask_ = inet_ntop(ifa->ifa_family, &netmask, ipaddr, sizeof(ipaddr));
-                }
-              }
+              net->netmask_ = formatNetmask(ifa->ifa_family, ifa->ifa_prefixlen);
               spdlog::debug("network: {}, new addr {}/{}", net->ifname_, net->ipaddr_, net->cidr_);
             } else {
               net->ipaddr_.clear();
@@ -705,6 +755,83 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
   return NL_OK;
 }
 
+// Link and address events when several interfaces are tracked, routes are not followed
+int waybar::modules::Network::handleInterfacesEvent(struct nlmsghdr *nh) {
+  switch (nh->nlmsg_type) {
+    case RTM_NEWLINK:
+    case RTM_DELLINK: {
+      auto *ifi = static_cast<struct ifinfomsg *>(NLMSG_DATA(nh));
+      ssize_t attrlen = IFLA_PAYLOAD(nh);
+      std::string ifname;
+      std::optional<bool> carrier;
+      for (auto *ifla = IFLA_RTA(ifi); RTA_OK(ifla, attrlen); ifla = RTA_NEXT(ifla, attrlen)) {
+        if (ifla->rta_type == IFLA_IFNAME) {
+          ifname = static_cast<const char *>(RTA_DATA(ifla));
+        } else if (ifla->rta_type == IFLA_CARRIER) {
+          carrier = *static_cast<char *>(RTA_DATA(ifla)) == 1;
+        }
+      }
+
+      auto pattern = matchInterface(ifname);
+      if (nh->nlmsg_type == RTM_DELLINK || !pattern) {
+        // deleted, or renamed to something that is not listed
+        if (interfaces_.erase(ifi->ifi_index) == 0) {
+          return NL_OK;
+        }
+        spdlog::debug("network: interface {} no longer tracked", ifi->ifi_index);
+      } else {
+        auto &iface = interfaces_[ifi->ifi_index];
+        iface.ifname = ifname;
+        iface.pattern = *pattern;
+        iface.up = (ifi->ifi_flags & IFF_UP) != 0;
+        iface.is_p2p = (ifi->ifi_flags & IFF_POINTOPOINT) != 0;
+        if (carrier.has_value()) {
+          iface.carrier = *carrier;
+        }
+      }
+      break;
+    }
+
+    case RTM_NEWADDR:
+    case RTM_DELADDR: {
+      auto *ifa = static_cast<struct ifaddrmsg *>(NLMSG_DATA(nh));
+      auto it = interfaces_.find(ifa->ifa_index);
+      // Only scope global addresses of the family we display
+      if (it == interfaces_.end() || ifa->ifa_family != family_ ||
+          ifa->ifa_scope >= RT_SCOPE_LINK) {
+        return NL_OK;
+      }
+      auto &iface = it->second;
+      ssize_t attrlen = IFA_PAYLOAD(nh);
+      for (auto *rta = IFA_RTA(ifa); RTA_OK(rta, attrlen); rta = RTA_NEXT(rta, attrlen)) {
+        // IFA_ADDRESS is the peer address on point-to-point links
+        if (rta->rta_type != IFA_LOCAL && (rta->rta_type != IFA_ADDRESS || iface.is_p2p)) {
+          continue;
+        }
+        char ipaddr[INET6_ADDRSTRLEN];
+        std::string addr = inet_ntop(ifa->ifa_family, RTA_DATA(rta), ipaddr, sizeof(ipaddr));
+        if (nh->nlmsg_type == RTM_NEWADDR) {
+          iface.ipaddr = addr;
+          iface.cidr = ifa->ifa_prefixlen;
+          iface.netmask = formatNetmask(ifa->ifa_family, ifa->ifa_prefixlen);
+        } else if (addr == iface.ipaddr) {
+          iface.ipaddr.clear();
+          iface.cidr = 0;
+          iface.netmask.clear();
+        }
+      }
+      break;
+    }
+
+    default:
+      return NL_OK;
+  }
+
+  selectPrimaryInterface();
+  dp.emit();
+  return NL_OK;
+}
+
 void waybar::modules::Network::askForStateDump(void) {
   /* We need to wait until the current dump is done before sending new
    * messages. handleEventsDone() is called when a dump is done. */
@@ -789,7 +916,7 @@ void waybar::modules::Network::parseEssid(struct nlattr **bss) {
       auto essid_end = essid_begin + ies[1];
       std::string essid_raw;
       std::copy(essid_begin, essid_end, std::back_inserter(essid_raw));
-      essid_ = Glib::Markup::escape_text(essid_raw);
+      essid_ = util::escape_markup(essid_raw);
     }
   }
 }
@@ -5,19 +5,20 @@ waybar::modules::Pulseaudio::Pulseaudio(const std::string &id, const Json::Value
   event_box_.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
   event_box_.signal_scroll_event().connect(sigc::mem_fun(*this, &Pulseaudio::handleScroll));
 
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
-  backend->setIgnoredSinks(config_["ignored-sinks"]);
+  backend = util::AudioBackend::getInstance(config_["ignored-sinks"]);
+  listener_ = backend->addListener([this] { this->dp.emit(); });
+  // the backend may already be shared with another bar
+  dp.emit();
 }
 
-bool waybar::modules::Pulseaudio::handleScroll(GdkEventScroll *e) {
+waybar::modules::Pulseaudio::~Pulseaudio() { backend->removeListener(listener_); }
+
+void waybar::modules::Pulseaudio::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
   // change the pulse volume only when no user provided
   // events are configured
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
-    return AModule::handleScroll(e);
-  }
-  auto dir = AModule::getScrollDir(e);
-  if (dir == SCROLL_DIR::NONE) {
-    return true;
+    AModule::handleScrollSteps(dir, steps);
+    return;
   }
   int max_volume = 100;
   double step = 1;
@@ -33,8 +34,7 @@ bool waybar::modules::Pulseaudio::handleScroll(GdkEventScroll *e) {
                          ? util::ChangeType::Increase
                          : util::ChangeType::Decrease;
 
-  backend->changeVolume(change_type, step, max_volume);
-  return true;
+  backend->changeVolume(change_type, step * steps, max_volume);
 }
 
 static const std::array<std::string, 9> ports = {
@@ -4,8 +4,8 @@ namespace waybar::modules {
 
 PulseaudioSlider::PulseaudioSlider(const std::string& id, const Json::Value& config)
     : ASlider(config, "pulseaudio-slider", id) {
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
-  backend->setIgnoredSinks(config_["ignored-sinks"]);
+  backend = util::AudioBackend::getInstance(config_["ignored-sinks"]);
+  listener_ = backend->addListener([this] { this->dp.emit(); });
 
   if (config_["target"].isString()) {
     std::string target = config_["target"].asString();
@@ -15,8 +15,12 @@ PulseaudioSlider::PulseaudioSlider(const std::string& id, const Json::Value& con
       this->target = PulseaudioSliderTarget::Source;
     }
   }
+  // the backend may already be shared with another bar
+  dp.emit();
 }
 
+PulseaudioSlider::~PulseaudioSlider() { backend->removeListener(listener_); }
+
 void PulseaudioSlider::update() {
   switch (target) {
     case PulseaudioSliderTarget::Sink:
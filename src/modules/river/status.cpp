@@ -0,0 +1,337 @@
+#include "modules/river/status.hpp"
+
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+#include <wayland-client.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace waybar::modules::river {
+
+static void listen_focused_tags(void *data, struct zriver_output_status_v1 *zriver_output_status_v1,
+                                uint32_t tags) {
+  static_cast<Status *>(data)->handle_focused_tags(zriver_output_status_v1, tags);
+}
+
+static void listen_view_tags(void *data, struct zriver_output_status_v1 *zriver_output_status_v1,
+                             struct wl_array *tags) {
+  static_cast<Status *>(data)->handle_view_tags(zriver_output_status_v1, tags);
+}
+
+static void listen_urgent_tags(void *data, struct zriver_output_status_v1 *zriver_output_status_v1,
+                               uint32_t tags) {
+  static_cast<Status *>(data)->handle_urgent_tags(zriver_output_status_v1, tags);
+}
+
+static void listen_layout_name(void *data, struct zriver_output_status_v1 *zriver_output_status_v1,
+                               const char *layout) {
+  static_cast<Status *>(data)->handle_layout_name(zriver_output_status_v1, layout);
+}
+
+static void listen_layout_name_clear(void *data,
+                                     struct zriver_output_status_v1 *zriver_output_status_v1) {
+  static_cast<Status *>(data)->handle_layout_name_clear(zriver_output_status_v1);
+}
+
+static void listen_focused_output(void *data, struct zriver_seat_status_v1 *zriver_seat_status_v1,
+                                  struct wl_output *output) {
+  static_cast<Status *>(data)->handle_focused_output(output);
+}
+
+static void listen_unfocused_output(void *data, struct zriver_seat_status_v1 *zriver_seat_status_v1,
+                                    struct wl_output *output) {
+  static_cast<Status *>(data)->handle_unfocused_output(output);
+}
+
+static void listen_focused_view(void *data, struct zriver_seat_status_v1 *zriver_seat_status_v1,
+                                const char *title) {
+  static_cast<Status *>(data)->handle_focused_view(title);
+}
+
+static void listen_mode(void *data, struct zriver_seat_status_v1 *zriver_seat_status_v1,
+                        const char *mode) {
+  static_cast<Status *>(data)->handle_mode(mode);
+}
+
+static const zriver_output_status_v1_listener output_status_listener_impl{
+    .focused_tags = listen_focused_tags,
+    .view_tags = listen_view_tags,
+    .urgent_tags = listen_urgent_tags,
+    .layout_name = listen_layout_name,
+    .layout_name_clear = listen_layout_name_clear,
+};
+
+static const zriver_seat_status_v1_listener seat_status_listener_impl{
+    .focused_output = listen_focused_output,
+    .unfocused_output = listen_unfocused_output,
+    .focused_view = listen_focused_view,
+    .mode = listen_mode,
+};
+
+static void handle_global(void *data, struct wl_registry *registry, uint32_t name,
+                          const char *interface, uint32_t version) {
+  auto *status = static_cast<Status *>(data);
+  if (std::strcmp(interface, zriver_status_manager_v1_interface.name) == 0) {
+    // bind the highest version any of the river modules understands, modules check
+    // Status::version() for the events they depend on
+    status->version_ = std::min<uint32_t>(version, 4);
+    status->status_manager_ = static_cast<struct zriver_status_manager_v1 *>(
+        wl_registry_bind(registry, name, &zriver_status_manager_v1_interface, status->version_));
+  }
+
+  if (std::strcmp(interface, zriver_control_v1_interface.name) == 0) {
+    version = std::min<uint32_t>(version, 1);
+    status->control_ = static_cast<struct zriver_control_v1 *>(
+        wl_registry_bind(registry, name, &zriver_control_v1_interface, version));
+  }
+
+  if (std::strcmp(interface, wl_seat_interface.name) == 0) {
+    version = std::min<uint32_t>(version, 1);
+    status->seat_ = static_cast<struct wl_seat *>(
+        wl_registry_bind(registry, name, &wl_seat_interface, version));
+  }
+}
+
+static void handle_global_remove(void *data, struct wl_registry *registry, uint32_t name) {
+  /* Ignore event */
+}
+
+static const wl_registry_listener registry_listener_impl = {.global = handle_global,
+                                                            .global_remove = handle_global_remove};
+
+std::shared_ptr<Status> Status::getInstance(struct wl_display *display) {
+  static std::map<struct wl_display *, std::weak_ptr<Status>> instances;
+  std::erase_if(instances, [](const auto &entry) { return entry.second.expired(); });
+  auto &instance = instances[display];
+  auto status = instance.lock();
+  if (!status) {
+    status = std::shared_ptr<Status>(new Status(display));
+    instance = status;
+  }
+  return status;
+}
+
+Status::Status(struct wl_display *display)
+    : status_manager_{nullptr},
+      control_{nullptr},
+      seat_{nullptr},
+      version_{0},
+      seat_status_{nullptr} {
+  struct wl_registry *registry = wl_display_get_registry(display);
+  wl_registry_add_listener(registry, &registry_listener_impl, this);
+  wl_display_roundtrip(display);
+  wl_registry_destroy(registry);
+
+  if (!status_manager_) {
+    spdlog::error("river_status_manager_v1 not advertised");
+    return;
+  }
+
+  if (!control_) {
+    spdlog::error("river_control_v1 not advertised");
+  }
+
+  if (!seat_) {
+    spdlog::error("wl_seat not advertised");
+    return;
+  }
+
+  seat_status_ = zriver_status_manager_v1_get_river_seat_status(status_manager_, seat_);
+  zriver_seat_status_v1_add_listener(seat_status_, &seat_status_listener_impl, this);
+}
+
+Status::~Status() {
+  dispatch_conn_.disconnect();
+  for (auto &[output, entry] : outputs_) {
+    zriver_output_status_v1_destroy(entry.status);
+  }
+  if (seat_status_) {
+    zriver_seat_status_v1_destroy(seat_status_);
+  }
+  if (control_) {
+    zriver_control_v1_destroy(control_);
+  }
+  if (status_manager_) {
+    zriver_status_manager_v1_destroy(status_manager_);
+  }
+}
+
+void Status::addListener(struct wl_output *output, StatusListener *listener) {
+  if (!status_manager_) {
+    return;
+  }
+
+  auto [it, inserted] = outputs_.try_emplace(output, Output{output, nullptr, {}, 0});
+  auto &entry = it->second;
+  if (inserted) {
+    entry.status = zriver_status_manager_v1_get_river_output_status(status_manager_, output);
+    zriver_output_status_v1_add_listener(entry.status, &output_status_listener_impl, this);
+    entry.state.focused = seat_state_.focused_output == output;
+  }
+  ++entry.refs;
+
+  // late subscribers get the state accumulated so far, river only sends it on object creation
+  subscribers_.push_back({output, listener, StatusChange::ALL});
+  scheduleDispatch();
+}
+
+void Status::removeListener(StatusListener *listener) {
+  for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+    if (it->listener != listener) {
+      ++it;
+      continue;
+    }
+
+    auto entry = outputs_.find(it->output);
+    if (entry != outputs_.end() && --entry->second.refs == 0) {
+      zriver_output_status_v1_destroy(entry->second.status);
+      outputs_.erase(entry);
+    }
+    it = subscribers_.erase(it);
+  }
+}
+
+Status::Output *Status::findOutput(struct zriver_output_status_v1 *status) {
+  for (auto &[output, entry] : outputs_) {
+    if (entry.status == status) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void Status::markOutput(struct wl_output *output, uint32_t changed) {
+  for (auto &subscriber : subscribers_) {
+    if (subscriber.output == output) {
+      subscriber.pending |= changed;
+    }
+  }
+  scheduleDispatch();
+}
+
+void Status::markAll(uint32_t changed) {
+  for (auto &subscriber : subscribers_) {
+    subscriber.pending |= changed;
+  }
+  scheduleDispatch();
+}
+
+void Status::scheduleDispatch() {
+  // wayland events arrive in bursts, render once after the whole burst was read
+  if (dispatch_conn_.connected()) {
+    return;
+  }
+  dispatch_conn_ = Glib::signal_idle().connect([this] {
+    dispatch();
+    return false;
+  });
+}
+
+void Status::dispatch() {
+  for (auto &subscriber : subscribers_) {
+    if (subscriber.pending == 0) {
+      continue;
+    }
+    auto entry = outputs_.find(subscriber.output);
+    if (entry == outputs_.end()) {
+      continue;
+    }
+    const auto changed = subscriber.pending;
+    subscriber.pending = 0;
+    subscriber.listener->handle_status(entry->second.state, seat_state_, changed);
+  }
+}
+
+void Status::handle_focused_tags(struct zriver_output_status_v1 *status, uint32_t tags) {
+  auto *entry = findOutput(status);
+  if (entry == nullptr || entry->state.focused_tags == tags) {
+    return;
+  }
+  entry->state.focused_tags = tags;
+  markOutput(entry->output, StatusChange::FOCUSED_TAGS);
+}
+
+void Status::handle_view_tags(struct zriver_output_status_v1 *status, struct wl_array *view_tags) {
+  auto *entry = findOutput(status);
+  if (entry == nullptr) {
+    return;
+  }
+  uint32_t tags = 0;
+  auto view_tag = reinterpret_cast<uint32_t *>(view_tags->data);
+  auto end = view_tag + (view_tags->size / sizeof(uint32_t));
+  for (; view_tag < end; ++view_tag) {
+    tags |= *view_tag;
+  }
+  if (entry->state.view_tags == tags) {
+    return;
+  }
+  entry->state.view_tags = tags;
+  markOutput(entry->output, StatusChange::VIEW_TAGS);
+}
+
+void Status::handle_urgent_tags(struct zriver_output_status_v1 *status, uint32_t tags) {
+  auto *entry = findOutput(status);
+  if (entry == nullptr || entry->state.urgent_tags == tags) {
+    return;
+  }
+  entry->state.urgent_tags = tags;
+  markOutput(entry->output, StatusChange::URGENT_TAGS);
+}
+
+void Status::handle_layout_name(struct zriver_output_status_v1 *status, const char *name) {
+  auto *entry = findOutput(status);
+  if (entry == nullptr || entry->state.layout_name == name) {
+    return;
+  }
+  entry->state.layout_name = name;
+  markOutput(entry->output, StatusChange::LAYOUT_NAME);
+}
+
+void Status::handle_layout_name_clear(struct zriver_output_status_v1 *status) {
+  auto *entry = findOutput(status);
+  if (entry == nullptr || !entry->state.layout_name) {
+    return;
+  }
+  entry->state.layout_name.reset();
+  markOutput(entry->output, StatusChange::LAYOUT_NAME);
+}
+
+void Status::handle_focused_output(struct wl_output *output) {
+  seat_state_.focused_output = output;
+  auto entry = outputs_.find(output);
+  if (entry != outputs_.end() && !entry->second.state.focused) {
+    entry->second.state.focused = true;
+    markOutput(output, StatusChange::OUTPUT_FOCUS);
+  }
+}
+
+void Status::handle_unfocused_output(struct wl_output *output) {
+  // outputs added later must not start out focused
+  if (seat_state_.focused_output == output) {
+    seat_state_.focused_output = nullptr;
+  }
+  auto entry = outputs_.find(output);
+  if (entry != outputs_.end() && entry->second.state.focused) {
+    entry->second.state.focused = false;
+    markOutput(output, StatusChange::OUTPUT_FOCUS);
+  }
+}
+
+void Status::handle_focused_view(const char *title) {
+  if (seat_state_.focused_view == title) {
+    return;
+  }
+  seat_state_.focused_view = title;
+  markAll(StatusChange::FOCUSED_VIEW);
+}
+
+void Status::handle_mode(const char *mode) {
+  if (seat_state_.mode == mode) {
+    return;
+  }
+  seat_state_.mode = mode;
+  markAll(StatusChange::MODE);
+}
+
+} /* namespace waybar::modules::river */
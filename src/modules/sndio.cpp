@@ -140,25 +140,22 @@ auto Sndio::put_val(unsigned int addr, unsigned int val) -> void {
   }
 }
 
-bool Sndio::handleScroll(GdkEventScroll *e) {
+void Sndio::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
   // change the volume only when no user provided
   // events are configured
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
-    return AModule::handleScroll(e);
+    AModule::handleScrollSteps(dir, steps);
+    return;
   }
 
   // only try to talk to sndio if connected
-  if (hdl_ == nullptr) return true;
-
-  auto dir = AModule::getScrollDir(e);
-  if (dir == SCROLL_DIR::NONE) {
-    return true;
-  }
+  if (hdl_ == nullptr) return;
 
   int step = 5;
   if (config_["scroll-step"].isInt()) {
     step = config_["scroll-step"].asInt();
   }
+  step *= static_cast<int>(steps);
 
   int new_volume = volume_;
   if (muted_) {
@@ -176,8 +173,6 @@ bool Sndio::handleScroll(GdkEventScroll *e) {
   muted_ = false;
 
   sioctl_setval(hdl_, addr_, new_volume);
-
-  return true;
 }
 
 bool Sndio::handleToggle(GdkEventButton *const &e) {
@@ -0,0 +1,162 @@
+#include "modules/sni/icons.hpp"
+
+#include <gdkmm/general.h>
+#include <spdlog/spdlog.h>
+
+#include <filesystem>
+
+#include "util/gtk_icon.hpp"
+
+namespace waybar::modules::SNI {
+
+// Longer animations are cut, one loop of shorter ones is decoded
+static const size_t MAX_MOVIE_FRAMES = 64;
+
+IconCache::IconCache() {
+  // every lookup falls back to the default theme
+  default_changed_ =
+      Gtk::IconTheme::get_default()->signal_changed().connect([this] { invalidate(""); });
+}
+
+IconCache::~IconCache() {
+  default_changed_.disconnect();
+  for (auto& [path, theme] : themes_) {
+    theme.changed.disconnect();
+  }
+}
+
+IconCache::Theme& IconCache::theme(const std::string& path) {
+  auto it = themes_.find(path);
+  if (it == themes_.end()) {
+    auto theme = Gtk::IconTheme::create();
+    theme->set_search_path({path});
+    auto changed = theme->signal_changed().connect([this, path] { invalidate(path); });
+    it = themes_.emplace(path, Theme{theme, changed}).first;
+  }
+  return it->second;
+}
+
+void IconCache::invalidate(const std::string& path) {
+  if (path.empty()) {
+    icons_.clear();
+    movies_.clear();
+  } else {
+    auto in_path = [&path](const auto& entry) { return std::get<3>(entry.first) == path; };
+    std::erase_if(icons_, in_path);
+    std::erase_if(movies_, in_path);
+  }
+  signal_invalidated.emit(path);
+}
+
+Glib::RefPtr<Gdk::Pixbuf> IconCache::load(const std::string& name, int size, int scale,
+                                          const std::string& theme_path) {
+  const Key key{name, size, scale, theme_path};
+  if (auto it = icons_.find(key); it != icons_.end()) {
+    return it->second;
+  }
+
+  const auto flags = Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE;
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+  try {
+    if (!theme_path.empty()) {
+      auto& entry = theme(theme_path);
+      entry.theme->rescan_if_needed();
+      if (entry.theme->lookup_icon(name, size * scale, flags)) {
+        pixbuf = entry.theme->load_icon(name, size * scale, flags);
+      }
+    }
+    if (!pixbuf) {
+      pixbuf = DefaultGtkIconThemeWrapper::load_icon(name.c_str(), size * scale, flags);
+    }
+  } catch (const Glib::Error& e) {
+    spdlog::trace("Tray icon '{}': {}", name, static_cast<std::string>(e.what()));
+  }
+
+  // misses are cached too, the item falls back to its pixmap until the themes change
+  icons_.emplace(key, pixbuf);
+  return pixbuf;
+}
+
+Glib::RefPtr<Gdk::Pixbuf> IconCache::fitHeight(const Glib::RefPtr<Gdk::Pixbuf>& pixbuf,
+                                               int height) {
+  // If the loaded icon is not square, assume that the icon height should match the
+  // requested icon size, but the width is allowed to be different.
+  if (pixbuf->get_height() == height) {
+    return pixbuf;
+  }
+  int width = height * pixbuf->get_width() / pixbuf->get_height();
+  return pixbuf->scale_simple(width, height, Gdk::InterpType::INTERP_BILINEAR);
+}
+
+std::shared_ptr<const Movie> IconCache::movie(const std::string& name, int size, int scale,
+                                              const std::string& theme_path) {
+  const Key key{name, size, scale, theme_path};
+  if (auto it = movies_.find(key); it != movies_.end()) {
+    if (auto movie = it->second.lock()) {
+      return movie;
+    }
+  }
+
+  std::string file = name;
+  if (!std::filesystem::is_regular_file(file)) {
+    const auto flags = Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE;
+    Gtk::IconInfo info;
+    if (!theme_path.empty()) {
+      info = theme(theme_path).theme->lookup_icon(name, size * scale, flags);
+    }
+    if (!info) {
+      info = Gtk::IconTheme::get_default()->lookup_icon(name, size * scale, flags);
+    }
+    if (!info) {
+      spdlog::debug("Tray movie '{}' not found", name);
+      return nullptr;
+    }
+    file = info.get_filename();
+  }
+
+  auto movie = loadMovie(file, size, scale);
+  if (!movie) {
+    return nullptr;
+  }
+  std::erase_if(movies_, [](const auto& entry) { return entry.second.expired(); });
+  movies_[key] = movie;
+  return movie;
+}
+
+std::shared_ptr<const Movie> IconCache::loadMovie(const std::string& file, int size, int scale) {
+  GError* error = nullptr;
+  GdkPixbufAnimation* animation = gdk_pixbuf_animation_new_from_file(file.c_str(), &error);
+  if (animation == nullptr) {
+    spdlog::warn("Tray movie '{}': {}", file, error->message);
+    g_error_free(error);
+    return nullptr;
+  }
+
+  auto movie = std::make_shared<Movie>();
+  movie->scale = scale;
+  // the GTimeVal iterator API is the only one gdk-pixbuf has
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  GTimeVal time = {0, 0};
+  GdkPixbufAnimationIter* iter = gdk_pixbuf_animation_get_iter(animation, &time);
+  while (movie->frames.size() < MAX_MOVIE_FRAMES) {
+    // the GIF loader composites every frame into the same pixbuf, copy it before advancing
+    GdkPixbuf* frame = gdk_pixbuf_animation_iter_get_pixbuf(iter);
+    const int delay = gdk_pixbuf_animation_iter_get_delay_time(iter);
+    auto pixbuf = fitHeight(Glib::wrap(frame, true)->copy(), size * scale);
+    movie->frames.push_back(
+        {Gdk::Cairo::create_surface_from_pixbuf(pixbuf, scale, Glib::RefPtr<Gdk::Window>()),
+         delay});
+    // the animation is fully loaded, so the "loading" frame is the last one of the loop
+    if (delay < 0 || gdk_pixbuf_animation_iter_on_currently_loading_frame(iter)) {
+      break;
+    }
+    g_time_val_add(&time, delay * 1000L);
+    gdk_pixbuf_animation_iter_advance(iter, &time);
+  }
+  G_GNUC_END_IGNORE_DEPRECATIONS
+  g_object_unref(iter);
+  g_object_unref(animation);
+  return movie;
+}
+
+}  // namespace waybar::modules::SNI
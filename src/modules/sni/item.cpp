@@ -6,11 +6,12 @@
 #include <spdlog/spdlog.h>
 
 #include <fstream>
+#include <functional>
 #include <map>
+#include <string_view>
 
 #include "gdk/gdk.h"
 #include "util/format.hpp"
-#include "util/gtk_icon.hpp"
 
 template <>
 struct fmt::formatter<Glib::VariantBase> : formatter<std::string> {
@@ -40,8 +41,9 @@ Item::Item(const std::string& bn, const std::string& op, const Json::Value& conf
       object_path(op),
       icon_size(16),
       effective_icon_size(0),
-      icon_theme(Gtk::IconTheme::create()),
-      bar_(bar) {
+      bar_(bar),
+      icons_(IconCache::getInstance()),
+      menus_(MenuCache::getInstance()) {
   if (config["icon-size"].isUInt()) {
     icon_size = config["icon-size"].asUInt();
   }
@@ -64,6 +66,9 @@ Item::Item(const std::string& bn, const std::string& op, const Json::Value& conf
   event_box.show_all();
   event_box.set_visible(show_passive_);
 
+  icons_invalidated_ =
+      icons_->signal_invalidated.connect(sigc::mem_fun(*this, &Item::onIconsInvalidated));
+
   cancellable_ = Gio::Cancellable::create();
 
   auto interface = Glib::wrap(sn_item_interface_info(), true);
@@ -72,8 +77,18 @@ Item::Item(const std::string& bn, const std::string& op, const Json::Value& conf
                                    cancellable_, interface);
 }
 
+Item::~Item() {
+  movie_timer_.disconnect();
+  icons_invalidated_.disconnect();
+  menus_->release(event_box);
+}
+
 bool Item::handleMouseEnter(GdkEventCrossing* const& e) {
   event_box.set_state_flags(Gtk::StateFlags::STATE_FLAG_PRELIGHT);
+  // a click may follow, fetch the menu layout now so the popup is not empty
+  if (!menu.empty()) {
+    menus_->prefetch(bus_name, menu);
+  }
   return false;
 }
 
@@ -146,31 +161,44 @@ void Item::setProperty(const Glib::ustring& name, Glib::VariantBase& value) {
       setStatus(get_variant<Glib::ustring>(value));
     } else if (name == "IconName") {
       icon_name = get_variant<std::string>(value);
+      icon_surface_ = {};
     } else if (name == "IconPixmap") {
-      icon_pixmap = this->extractPixBuf(value.gobj());
+      // NewIcon resends the pixmap with every name change, decode it only when it differs
+      if (auto hash = pixmapHash(value); hash != icon_pixmap_hash_) {
+        icon_pixmap = this->extractPixBuf(value.gobj());
+        icon_pixmap_hash_ = hash;
+        icon_surface_ = {};
+      }
     } else if (name == "OverlayIconName") {
       overlay_icon_name = get_variant<std::string>(value);
     } else if (name == "OverlayIconPixmap") {
       // TODO: overlay_icon_pixmap
     } else if (name == "AttentionIconName") {
       attention_icon_name = get_variant<std::string>(value);
+      attention_surface_ = {};
     } else if (name == "AttentionIconPixmap") {
-      // TODO: attention_icon_pixmap
+      if (auto hash = pixmapHash(value); hash != attention_pixmap_hash_) {
+        attention_pixmap = this->extractPixBuf(value.gobj());
+        attention_pixmap_hash_ = hash;
+        attention_surface_ = {};
+      }
     } else if (name == "AttentionMovieName") {
       attention_movie_name = get_variant<std::string>(value);
+      movie_.reset();
     } else if (name == "ToolTip") {
       tooltip = get_variant<ToolTip>(value);
       if (!tooltip.text.empty()) {
         event_box.set_tooltip_markup(tooltip.text);
       }
     } else if (name == "IconThemePath") {
+      // the theme for this path is shared through icons_
       icon_theme_path = get_variant<std::string>(value);
-      if (!icon_theme_path.empty()) {
-        icon_theme->set_search_path({icon_theme_path});
-      }
+      icon_surface_ = {};
+      attention_surface_ = {};
+      movie_.reset();
     } else if (name == "Menu") {
+      // the DBusMenu client is created when the pointer enters the item
       menu = get_variant<std::string>(value);
-      makeMenu();
     } else if (name == "ItemIsMenu") {
       item_is_menu = get_variant<bool>(value);
     }
@@ -191,7 +219,8 @@ void Item::setStatus(const Glib::ustring& value) {
   for (const auto& class_name : style->list_classes()) {
     style->remove_class(class_name);
   }
-  if (lower.compare("needsattention") == 0) {
+  needs_attention_ = lower.compare("needsattention") == 0;
+  if (needs_attention_) {
     // convert status to dash-case for CSS
     lower = "needs-attention";
   }
@@ -199,33 +228,37 @@ void Item::setStatus(const Glib::ustring& value) {
 }
 
 void Item::getUpdatedProperties() {
-  auto params = Glib::VariantContainerBase::create_tuple(
-      {Glib::Variant<Glib::ustring>::create(SNI_INTERFACE_NAME)});
-  proxy_->call("org.freedesktop.DBus.Properties.GetAll",
-               sigc::mem_fun(*this, &Item::processUpdatedProperties), params);
+  // signals arriving while the replies are in flight schedule another round
+  auto pending = std::move(update_pending_);
+  update_pending_.clear();
+  for (const auto& name : pending) {
+    auto params = Glib::VariantContainerBase::create_tuple(
+        {Glib::Variant<Glib::ustring>::create(SNI_INTERFACE_NAME),
+         Glib::Variant<Glib::ustring>::create(Glib::ustring(name.data(), name.size()))});
+    proxy_->call("org.freedesktop.DBus.Properties.Get",
+                 sigc::bind(sigc::mem_fun(*this, &Item::processUpdatedProperty),
+                            Glib::ustring(name.data(), name.size())),
+                 cancellable_, params);
+  }
 };
 
-void Item::processUpdatedProperties(Glib::RefPtr<Gio::AsyncResult>& _result) {
+void Item::processUpdatedProperty(Glib::RefPtr<Gio::AsyncResult>& _result,
+                                  const Glib::ustring& name) {
   try {
     auto result = proxy_->call_finish(_result);
-    // extract "a{sv}" from VariantContainerBase
-    Glib::Variant<std::map<Glib::ustring, Glib::VariantBase>> properties_variant;
-    result.get_child(properties_variant);
-    auto properties = properties_variant.get();
-
-    for (const auto& [name, value] : properties) {
-      if (update_pending_.count(name.raw())) {
-        setProperty(name, const_cast<Glib::VariantBase&>(value));
-      }
-    }
+    // extract "v" from VariantContainerBase
+    Glib::Variant<Glib::VariantBase> value;
+    result.get_child(value);
+    auto property = value.get();
+    setProperty(name, property);
 
     this->updateImage();
   } catch (const Glib::Error& err) {
-    spdlog::warn("Failed to update properties: {}", err.what());
+    // items are not required to implement every property a signal may cover
+    spdlog::debug("Failed to update property {}.{}: {}", id, name, err.what());
   } catch (const std::exception& err) {
-    spdlog::warn("Failed to update properties: {}", err.what());
+    spdlog::warn("Failed to update property {}.{}: {}", id, name, err.what());
   }
-  update_pending_.clear();
 }
 
 /**
@@ -235,21 +268,30 @@ void Item::processUpdatedProperties(Glib::RefPtr<Gio::AsyncResult>& _result) {
 static const std::map<std::string_view, std::set<std::string_view>> signal2props = {
     {"NewTitle", {"Title"}},
     {"NewIcon", {"IconName", "IconPixmap"}},
-    // {"NewAttentionIcon", {"AttentionIconName", "AttentionIconPixmap", "AttentionMovieName"}},
+    // applied from the payload, fetched only if an item sends it without one
+    {"NewStatus", {"Status"}},
+    {"NewAttentionIcon", {"AttentionIconName", "AttentionIconPixmap", "AttentionMovieName"}},
     // {"NewOverlayIcon", {"OverlayIconName", "OverlayIconPixmap"}},
     {"NewIconThemePath", {"IconThemePath"}},
     {"NewToolTip", {"ToolTip"}},
-    {"NewStatus", {"Status"}},
     // {"XAyatanaNewLabel", {"XAyatanaLabel"}},
 };
 
 void Item::onSignal(const Glib::ustring& sender_name, const Glib::ustring& signal_name,
                     const Glib::VariantContainerBase& arguments) {
   spdlog::trace("Tray item '{}' got signal {}", id, signal_name);
+  if (signal_name == "NewStatus" && arguments.get_n_children() == 1) {
+    // the status is the signal payload, attention flashing needs neither D-Bus nor decoding
+    Glib::Variant<Glib::ustring> status;
+    arguments.get_child(status);
+    setStatus(status.get());
+    updateImage();
+    return;
+  }
   auto changed = signal2props.find(signal_name.raw());
   if (changed != signal2props.end()) {
     if (update_pending_.empty()) {
-      /* Debounce signals and schedule update of all properties.
+      /* Debounce signals and schedule update of the properties they cover.
        * Based on behavior of Plasma dataengine for StatusNotifierItem.
        */
       Glib::signal_timeout().connect_once(sigc::mem_fun(*this, &Item::getUpdatedProperties),
@@ -259,6 +301,13 @@ void Item::onSignal(const Glib::ustring& sender_name, const Glib::ustring& signa
   }
 }
 
+size_t Item::pixmapHash(const Glib::VariantBase& value) {
+  // 0 stands for "nothing decoded yet", the serialized a(iiay) is hashed as is
+  auto hash = std::hash<std::string_view>{}(std::string_view(
+      static_cast<const char*>(g_variant_get_data(value.gobj())), value.get_size()));
+  return hash != 0 ? hash : 1;
+}
+
 static void pixbuf_data_deleter(const guint8* data) { g_free((void*)data); }
 
 Glib::RefPtr<Gdk::Pixbuf> Item::extractPixBuf(GVariant* variant) {
@@ -311,24 +360,68 @@ Glib::RefPtr<Gdk::Pixbuf> Item::extractPixBuf(GVariant* variant) {
   return Glib::RefPtr<Gdk::Pixbuf>{};
 }
 
+void Item::onIconsInvalidated(const std::string& theme_path) {
+  // the icons of another application's theme path are still valid
+  if (!theme_path.empty() && theme_path != icon_theme_path) {
+    return;
+  }
+  icon_surface_ = {};
+  attention_surface_ = {};
+  stopMovie();
+  movie_.reset();
+  updateImage();
+}
+
 void Item::updateImage() {
-  auto pixbuf = getIconPixbuf();
-  auto scaled_icon_size = getScaledIconSize();
+  const int scale = image.get_scale_factor();
 
-  // If the loaded icon is not square, assume that the icon height should match the
-  // requested icon size, but the width is allowed to be different. As such, if the
-  // height of the image does not match the requested icon size, resize the icon such that
-  // the aspect ratio is maintained, but the height matches the requested icon size.
-  if (pixbuf->get_height() != scaled_icon_size) {
-    int width = scaled_icon_size * pixbuf->get_width() / pixbuf->get_height();
-    pixbuf = pixbuf->scale_simple(width, scaled_icon_size, Gdk::InterpType::INTERP_BILINEAR);
+  if (needs_attention_ && !attention_movie_name.empty()) {
+    if (!movie_ || movie_->scale != scale) {
+      stopMovie();
+      movie_ = icons_->movie(attention_movie_name, icon_size, scale, icon_theme_path);
+    }
+    if (movie_ && !movie_->frames.empty()) {
+      playMovie();
+      return;
+    }
+  }
+  stopMovie();
+
+  const bool attention = needs_attention_ && (!attention_icon_name.empty() || attention_pixmap);
+  auto& rendered = attention ? attention_surface_ : icon_surface_;
+  if (!rendered.surface || rendered.scale != scale) {
+    auto pixbuf = attention ? getAttentionPixbuf() : getIconPixbuf();
+    if (!pixbuf) {
+      image.clear();
+      return;
+    }
+    pixbuf = IconCache::fitHeight(pixbuf, static_cast<int>(getScaledIconSize()));
+    rendered = {scale, Gdk::Cairo::create_surface_from_pixbuf(pixbuf, scale, image.get_window())};
   }
+  image.set(rendered.surface);
+}
 
-  auto surface =
-      Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image.get_scale_factor(), image.get_window());
-  image.set(surface);
+void Item::playMovie() {
+  if (!movie_timer_.connected()) {
+    showMovieFrame(0);
+  }
 }
 
+void Item::showMovieFrame(size_t index) {
+  movie_frame_ = index;
+  const auto& frame = movie_->frames[index];
+  image.set(frame.surface);
+  if (movie_->frames.size() < 2 || frame.delay < 0) {
+    return;
+  }
+  // the frames are shared by all bars, advancing only swaps surfaces
+  movie_timer_ = Glib::signal_timeout().connect_once(
+      [this] { showMovieFrame((movie_frame_ + 1) % movie_->frames.size()); },
+      std::max(frame.delay, 20));
+}
+
+void Item::stopMovie() { movie_timer_.disconnect(); }
+
 Glib::RefPtr<Gdk::Pixbuf> Item::getIconPixbuf() {
   if (!icon_name.empty()) {
     try {
@@ -345,11 +438,8 @@ Glib::RefPtr<Gdk::Pixbuf> Item::getIconPixbuf() {
       spdlog::warn("Item '{}': {}", id, static_cast<std::string>(e.what()));
     }
 
-    try {
-      // Will throw if it can not find an icon.
-      return getIconByName(icon_name, getScaledIconSize());
-    } catch (Glib::Error& e) {
-      spdlog::trace("Item '{}': {}", id, static_cast<std::string>(e.what()));
+    if (auto pixbuf = getIconByName(icon_name)) {
+      return pixbuf;
     }
   }
 
@@ -365,20 +455,24 @@ Glib::RefPtr<Gdk::Pixbuf> Item::getIconPixbuf() {
                   icon_name);
   }
 
-  return getIconByName("image-missing", getScaledIconSize());
+  return getIconByName("image-missing");
 }
 
-Glib::RefPtr<Gdk::Pixbuf> Item::getIconByName(const std::string& name, int request_size) {
-  icon_theme->rescan_if_needed();
-
-  if (!icon_theme_path.empty() &&
-      icon_theme->lookup_icon(name.c_str(), request_size,
-                              Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE)) {
-    return icon_theme->load_icon(name.c_str(), request_size,
-                                 Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
+Glib::RefPtr<Gdk::Pixbuf> Item::getAttentionPixbuf() {
+  if (!attention_icon_name.empty()) {
+    if (auto pixbuf = getIconByName(attention_icon_name)) {
+      return pixbuf;
+    }
   }
-  return DefaultGtkIconThemeWrapper::load_icon(name.c_str(), request_size,
-                                               Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
+  if (attention_pixmap) {
+    return attention_pixmap;
+  }
+  // the needs-attention CSS class still marks the item
+  return getIconPixbuf();
+}
+
+Glib::RefPtr<Gdk::Pixbuf> Item::getIconByName(const std::string& name) {
+  return icons_->load(name, icon_size, image.get_scale_factor(), icon_theme_path);
 }
 
 double Item::getScaledIconSize() {
@@ -386,23 +480,11 @@ double Item::getScaledIconSize() {
   return icon_size * image.get_scale_factor();
 }
 
-void Item::onMenuDestroyed(Item* self, GObject* old_menu_pointer) {
-  if (old_menu_pointer == reinterpret_cast<GObject*>(self->dbus_menu)) {
-    self->gtk_menu = nullptr;
-    self->dbus_menu = nullptr;
-  }
-}
-
-void Item::makeMenu() {
-  if (gtk_menu == nullptr && !menu.empty()) {
-    dbus_menu = dbusmenu_gtkmenu_new(bus_name.data(), menu.data());
-    if (dbus_menu != nullptr) {
-      g_object_ref_sink(G_OBJECT(dbus_menu));
-      g_object_weak_ref(G_OBJECT(dbus_menu), (GWeakNotify)onMenuDestroyed, this);
-      gtk_menu = Glib::wrap(GTK_MENU(dbus_menu));
-      gtk_menu->attach_to_widget(event_box);
-    }
+Gtk::Menu* Item::getMenu() {
+  if (menu.empty()) {
+    return nullptr;
   }
+  return menus_->get(bus_name, menu, event_box);
 }
 
 bool Item::handleClick(GdkEventButton* const& ev) {
@@ -410,7 +492,7 @@ bool Item::handleClick(GdkEventButton* const& ev) {
       {Glib::Variant<int>::create(ev->x_root + bar_.x_global),
        Glib::Variant<int>::create(ev->y_root + bar_.y_global)});
   if ((ev->button == 1 && item_is_menu) || ev->button == 3) {
-    makeMenu();
+    auto* gtk_menu = getMenu();
     if (gtk_menu != nullptr) {
 #if GTK_CHECK_VERSION(3, 22, 0)
       gtk_menu->popup_at_pointer(reinterpret_cast<GdkEvent*>(ev));
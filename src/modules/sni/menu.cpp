@@ -0,0 +1,93 @@
+#include "modules/sni/menu.hpp"
+
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+
+namespace waybar::modules::SNI {
+
+// seconds a menu is kept after it was last shown
+static const unsigned MENU_IDLE_TIMEOUT = 60;
+
+MenuCache::~MenuCache() {
+  for (auto& [key, entry] : menus_) {
+    destroy(entry);
+  }
+}
+
+MenuCache::Entry* MenuCache::lookup(const Key& key) {
+  auto it = menus_.find(key);
+  if (it == menus_.end()) {
+    const auto& [bus_name, path] = key;
+    auto* dbus_menu = dbusmenu_gtkmenu_new(const_cast<gchar*>(bus_name.c_str()),
+                                           const_cast<gchar*>(path.c_str()));
+    if (dbus_menu == nullptr) {
+      return nullptr;
+    }
+    g_object_ref_sink(G_OBJECT(dbus_menu));
+    spdlog::debug("Tray: created menu {}{}", bus_name, path);
+    it = menus_.emplace(key, Entry{dbus_menu, Glib::wrap(GTK_MENU(dbus_menu)), {}}).first;
+  }
+
+  auto& entry = it->second;
+  entry.expire.disconnect();
+  entry.expire = Glib::signal_timeout().connect_seconds([this, key] { return expire(key); },
+                                                        MENU_IDLE_TIMEOUT);
+  return &entry;
+}
+
+void MenuCache::prefetch(const std::string& bus_name, const std::string& path) {
+  lookup({bus_name, path});
+}
+
+Gtk::Menu* MenuCache::get(const std::string& bus_name, const std::string& path,
+                          Gtk::Widget& widget) {
+  auto* entry = lookup({bus_name, path});
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  // the same item is shown on every bar, move the menu to the one that was clicked
+  if (entry->gtk_menu->get_attach_widget() != &widget) {
+    if (entry->gtk_menu->get_attach_widget() != nullptr) {
+      entry->gtk_menu->detach();
+    }
+    entry->gtk_menu->attach_to_widget(widget);
+  }
+  return entry->gtk_menu;
+}
+
+void MenuCache::release(Gtk::Widget& widget) {
+  for (auto& [key, entry] : menus_) {
+    if (entry.gtk_menu->get_attach_widget() == &widget) {
+      entry.gtk_menu->detach();
+    }
+  }
+}
+
+bool MenuCache::expire(Key key) {
+  auto it = menus_.find(key);
+  if (it == menus_.end()) {
+    return false;
+  }
+  if (it->second.gtk_menu->get_visible()) {
+    // still open, check again later
+    return true;
+  }
+  spdlog::debug("Tray: dropped idle menu {}{}", key.first, key.second);
+  // this timeout is the one stored in the entry, it ends by returning false
+  auto entry = it->second;
+  entry.expire = {};
+  menus_.erase(it);
+  destroy(entry);
+  return false;
+}
+
+void MenuCache::destroy(Entry& entry) {
+  entry.expire.disconnect();
+  if (entry.gtk_menu->get_attach_widget() != nullptr) {
+    entry.gtk_menu->detach();
+  }
+  gtk_widget_destroy(GTK_WIDGET(entry.dbus_menu));
+  g_object_unref(entry.dbus_menu);
+}
+
+}  // namespace waybar::modules::SNI
@@ -11,6 +11,8 @@
 namespace waybar::modules::sway {
 
 BarIpcClient::BarIpcClient(waybar::Bar& bar) : bar_{bar} {
+  has_mode_ = isModuleEnabled("sway/mode");
+  has_workspaces_ = isModuleEnabled("sway/workspaces");
   {
     sigc::connection handle =
         ipc_.signal_cmd.connect(sigc::mem_fun(*this, &BarIpcClient::onInitialConfig));
@@ -19,23 +21,6 @@ BarIpcClient::BarIpcClient(waybar::Bar& bar) : bar_{bar} {
     handle.disconnect();
   }
 
-  Json::Value subscribe_events{Json::arrayValue};
-  subscribe_events.append("bar_state_update");
-  subscribe_events.append("barconfig_update");
-
-  bool has_mode = isModuleEnabled("sway/mode");
-  bool has_workspaces = isModuleEnabled("sway/workspaces");
-
-  if (has_mode) {
-    subscribe_events.append("mode");
-  }
-  if (has_workspaces) {
-    subscribe_events.append("workspace");
-  }
-  if (has_mode || has_workspaces) {
-    subscribe_events.append("binding");
-  }
-
   modifier_reset_ = bar.config.get("modifier-reset", "press").asString();
 
   signal_config_.connect(sigc::mem_fun(*this, &BarIpcClient::onConfigUpdate));
@@ -43,13 +28,9 @@ BarIpcClient::BarIpcClient(waybar::Bar& bar) : bar_{bar} {
   signal_urgency_.connect(sigc::mem_fun(*this, &BarIpcClient::onUrgencyUpdate));
   signal_mode_.connect(sigc::mem_fun(*this, &BarIpcClient::onModeUpdate));
 
-  // Subscribe to non bar events to determine if the modifier key press is followed by another
-  // action.
-  std::ostringstream oss_events;
-  oss_events << subscribe_events;
-  ipc_.subscribe(oss_events.str());
   ipc_.signal_event.connect(sigc::mem_fun(*this, &BarIpcClient::onIpcEvent));
   ipc_.signal_cmd.connect(sigc::mem_fun(*this, &BarIpcClient::onCmd));
+  updateSubscriptions();
   // Launch worker
   ipc_.setWorker([this] {
     try {
@@ -60,9 +41,59 @@ BarIpcClient::BarIpcClient(waybar::Bar& bar) : bar_{bar} {
   });
 }
 
+/*
+ * Only a bar in hide mode and hidden state is shown by urgency, binding modes and a modifier
+ * press that no other action follows, so only then the workspace, mode and binding events are
+ * subscribed to. Binding events come with every key binding and workspace events with full
+ * workspace objects, a visible bar has no use for either.
+ */
+void BarIpcClient::updateSubscriptions() {
+  const bool track = bar_config_.mode == "hide" && bar_config_.hidden_state == "hide" &&
+                     (has_mode_ || has_workspaces_);
+  if (subscribed_ && track == tracking_visibility_) {
+    return;
+  }
+
+  Json::Value subscribe_events{Json::arrayValue};
+  subscribe_events.append("bar_state_update");
+  subscribe_events.append("barconfig_update");
+  if (track) {
+    if (has_mode_) {
+      subscribe_events.append("mode");
+    }
+    if (has_workspaces_) {
+      subscribe_events.append("workspace");
+    }
+    // Subscribe to non bar events to determine if the modifier key press is followed by another
+    // action.
+    subscribe_events.append("binding");
+  }
+  std::ostringstream oss_events;
+  oss_events << subscribe_events;
+  spdlog::debug("swaybar ipc: subscribing {} to {}", bar_.bar_id, oss_events.str());
+  if (subscribed_) {
+    ipc_.resubscribe(oss_events.str());
+  } else {
+    ipc_.subscribe(oss_events.str());
+    subscribed_ = true;
+  }
+
+  if (track && !tracking_visibility_) {
+    // catch up with the urgency and mode changes missed while not subscribed
+    auto on_reply = [this](const auto& res) { onReply(reply_parser_, res); };
+    if (has_workspaces_) {
+      ipc_.sendCmdAsync(IPC_GET_WORKSPACES, "", on_reply);
+    }
+    if (has_mode_) {
+      ipc_.sendCmdAsync(IPC_GET_BINDING_STATE, "", on_reply);
+    }
+  }
+  tracking_visibility_ = track;
+}
+
 bool BarIpcClient::isModuleEnabled(std::string name) {
   for (const auto& section : {"modules-left", "modules-center", "modules-right"}) {
-    if (const auto& modules = bar_.config.get(section, {}); modules.isArray()) {
+    if (const auto& modules = bar_.config[section]; modules.isArray()) {
       for (const auto& module : modules) {
         if (module.asString().rfind(name, 0) == 0) {
           return true;
@@ -99,37 +130,35 @@ void BarIpcClient::onInitialConfig(const struct Ipc::ipc_response& res) {
 
 void BarIpcClient::onIpcEvent(const struct Ipc::ipc_response& res) {
   try {
-    auto payload = parser_.parse(res.payload);
-    switch (res.type) {
-      case IPC_EVENT_WORKSPACE:
-        if (payload.isMember("change")) {
-          // only check and send signal if the workspace update reason was because of a urgent
-          // change
-          if (payload["change"] == "urgent") {
-            auto urgent = payload["current"]["urgent"];
-            if (urgent.asBool()) {
-              // Event for a new urgency, update the visibly
-              signal_urgency_(true);
-            } else if (!urgent.asBool() && visible_by_urgency_) {
-              // Event clearing an urgency, bar is visible, check if another workspace still has
-              // the urgency hint set
-              ipc_.sendCmd(IPC_GET_WORKSPACES);
-            }
-          }
-          modifier_no_action_ = false;
-        }
+    // only urgency and bar state changes are parsed, the rest is told apart by a pre-scan
+    auto event = classifyBarEvent(res.type, res.payload, bar_.bar_id);
+    switch (event) {
+      case BarEvent::IGNORED:
+        break;
+      case BarEvent::ACTION:
+        modifier_no_action_ = false;
         break;
-      case IPC_EVENT_MODE:
-        if (payload.isMember("change")) {
-          signal_mode_(payload["change"] != "default");
-          modifier_no_action_ = false;
+      case BarEvent::URGENT: {
+        auto payload = parser_.parse(res.payload);
+        auto urgent = payload["current"]["urgent"];
+        if (urgent.asBool()) {
+          // Event for a new urgency, update the visibly
+          signal_urgency_(true);
+        } else if (visible_by_urgency_) {
+          // Event clearing an urgency, bar is visible, check if another workspace still has
+          // the urgency hint set
+          ipc_.sendCmd(IPC_GET_WORKSPACES);
         }
+        modifier_no_action_ = false;
         break;
-      case IPC_EVENT_BINDING:
+      }
+      case BarEvent::MODE_DEFAULT:
+      case BarEvent::MODE_OTHER:
+        signal_mode_(event == BarEvent::MODE_OTHER);
         modifier_no_action_ = false;
         break;
-      case IPC_EVENT_BAR_STATE_UPDATE:
-      case IPC_EVENT_BARCONFIG_UPDATE:
+      case BarEvent::BAR_STATE: {
+        auto payload = parser_.parse(res.payload);
         if (auto id = payload["id"]; id.isString() && id.asString() != bar_.bar_id) {
           spdlog::trace("swaybar ipc: ignore event for {}", id.asString());
           return;
@@ -143,16 +172,19 @@ void BarIpcClient::onIpcEvent(const struct Ipc::ipc_response& res) {
           signal_config_(std::move(config));
         }
         break;
+      }
     }
   } catch (const std::exception& e) {
     spdlog::error("BarIpcClient::onEvent {}", e.what());
   }
 }
 
-void BarIpcClient::onCmd(const struct Ipc::ipc_response& res) {
+void BarIpcClient::onCmd(const struct Ipc::ipc_response& res) { onReply(parser_, res); }
+
+void BarIpcClient::onReply(util::JsonParser& parser, const struct Ipc::ipc_response& res) {
   if (res.type == IPC_GET_WORKSPACES) {
     try {
-      auto payload = parser_.parse(res.payload);
+      auto payload = parser.parse(res.payload);
       for (auto& ws : payload) {
         if (ws["urgent"].asBool()) {
           spdlog::debug("Found workspace {} with urgency set. Stopping search.", ws["name"]);
@@ -167,6 +199,15 @@ void BarIpcClient::onCmd(const struct Ipc::ipc_response& res) {
     } catch (const std::exception& e) {
       spdlog::error("Bar: {}", e.what());
     }
+  } else if (res.type == IPC_GET_BINDING_STATE) {
+    try {
+      auto payload = parser.parse(res.payload);
+      if (auto name = payload["name"]; name.isString()) {
+        signal_mode_(name.asString() != "default");
+      }
+    } catch (const std::exception& e) {
+      spdlog::error("Bar: {}", e.what());
+    }
   }
 }
 
@@ -174,6 +215,13 @@ void BarIpcClient::onConfigUpdate(const swaybar_config& config) {
   spdlog::info("config update for {}: id {}, mode {}, hidden_state {}", bar_.bar_id, config.id,
                config.mode, config.hidden_state);
   bar_config_ = config;
+  if (subscribed_) {
+    try {
+      updateSubscriptions();
+    } catch (const std::exception& e) {
+      spdlog::error("BarIpcClient: {}", e.what());
+    }
+  }
   update();
 }
 
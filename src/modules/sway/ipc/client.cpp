@@ -11,10 +11,19 @@ Ipc::Ipc() {
   const std::string& socketPath = getSocketPath();
   fd_ = open(socketPath);
   fd_event_ = open(socketPath);
+  reply_dp_.connect(sigc::mem_fun(*this, &Ipc::handleReplies));
 }
 
 Ipc::~Ipc() {
   thread_.stop();
+  {
+    std::lock_guard<std::mutex> lock(cmd_mutex_);
+    cmd_stop_ = true;
+  }
+  cmd_cv_.notify_all();
+  if (cmd_thread_.joinable()) {
+    cmd_thread_.join();
+  }
 
   if (fd_ > 0) {
     // To fail the IPC header
@@ -31,6 +40,7 @@ Ipc::~Ipc() {
     close(fd_event_);
     fd_event_ = -1;
   }
+  closeRetired();
 }
 
 void Ipc::setWorker(std::function<void()>&& func) { thread_ = func; }
@@ -114,6 +124,10 @@ struct Ipc::ipc_response Ipc::recv(int fd) {
       }
       throw std::runtime_error("Unable to receive IPC payload");
     }
+    if (res == 0) {
+      // connection closed halfway through the payload
+      throw std::runtime_error("Unable to receive IPC payload");
+    }
     total += res;
   }
   return {data32[0], data32[1], &payload.front()};
@@ -142,6 +156,60 @@ void Ipc::sendCmd(uint32_t type, const std::string& payload) {
   signal_cmd.emit(res);
 }
 
+void Ipc::sendCmdAsync(uint32_t type, const std::string& payload, ReplyHandler on_reply) {
+  {
+    std::lock_guard<std::mutex> lock(cmd_mutex_);
+    cmd_queue_.push_back({type, payload, std::move(on_reply)});
+    if (!cmd_thread_.joinable()) {
+      cmd_thread_ = util::Thread("sway-ipc-cmd", [this] { commandWorker(); },
+                                 util::Thread::SHALLOW_STACK_SIZE);
+    }
+  }
+  cmd_cv_.notify_one();
+}
+
+void Ipc::commandWorker() {
+  std::unique_lock<std::mutex> lock(cmd_mutex_);
+  while (true) {
+    cmd_cv_.wait(lock, [this] { return cmd_stop_ || !cmd_queue_.empty(); });
+    if (cmd_stop_) {
+      return;
+    }
+    auto cmd = std::move(cmd_queue_.front());
+    cmd_queue_.pop_front();
+
+    lock.unlock();
+    try {
+      struct ipc_response res;
+      {
+        std::lock_guard<std::mutex> send_lock(mutex_);
+        res = Ipc::send(fd_, cmd.type, cmd.payload);
+      }
+      if (cmd.on_reply) {
+        {
+          std::lock_guard<std::mutex> reply_lock(reply_mutex_);
+          replies_.emplace_back(std::move(cmd.on_reply), std::move(res));
+        }
+        reply_dp_.emit();
+      }
+    } catch (const std::exception& e) {
+      spdlog::error("Ipc: {}", e.what());
+    }
+    lock.lock();
+  }
+}
+
+void Ipc::handleReplies() {
+  std::unique_lock<std::mutex> lock(reply_mutex_);
+  while (!replies_.empty()) {
+    auto [on_reply, res] = std::move(replies_.front());
+    replies_.pop_front();
+    lock.unlock();
+    on_reply(res);
+    lock.lock();
+  }
+}
+
 void Ipc::subscribe(const std::string& payload) {
   auto res = Ipc::send(fd_event_, IPC_SUBSCRIBE, payload);
   if (res.payload != "{\"success\": true}") {
@@ -149,8 +217,47 @@ void Ipc::subscribe(const std::string& payload) {
   }
 }
 
+void Ipc::resubscribe(const std::string& payload) {
+  const int fd = open(getSocketPath());
+  try {
+    auto res = Ipc::send(fd, IPC_SUBSCRIBE, payload);
+    if (res.payload != "{\"success\": true}") {
+      throw std::runtime_error("Unable to subscribe ipc event");
+    }
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  const int old = fd_event_.exchange(fd);
+  {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_fds_.push_back(old);
+  }
+  // the worker blocked on the old connection returns, it is closed on the next handleEvent()
+  ::shutdown(old, SHUT_RDWR);
+}
+
+void Ipc::closeRetired() {
+  std::lock_guard<std::mutex> lock(retired_mutex_);
+  for (auto fd : retired_fds_) {
+    close(fd);
+  }
+  retired_fds_.clear();
+}
+
 void Ipc::handleEvent() {
-  const auto res = Ipc::recv(fd_event_);
+  closeRetired();
+  const int fd = fd_event_;
+  struct ipc_response res;
+  try {
+    res = Ipc::recv(fd);
+  } catch (const std::exception&) {
+    if (fd != fd_event_) {
+      // connection replaced by resubscribe()
+      return;
+    }
+    throw;
+  }
   signal_event.emit(res);
 }
 
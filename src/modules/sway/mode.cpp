@@ -2,6 +2,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include "util/text.hpp"
+
 namespace waybar::modules::sway {
 
 Mode::Mode(const std::string& id, const Json::Value& config)
@@ -27,7 +29,7 @@ void Mode::onEvent(const struct Ipc::ipc_response& res) {
       if (payload["pango_markup"].asBool()) {
         mode_ = payload["change"].asString();
       } else {
-        mode_ = Glib::Markup::escape_text(payload["change"].asString());
+        mode_ = util::escape_markup(payload["change"].asString());
       }
     } else {
       mode_.clear();
@@ -13,6 +13,7 @@
 
 #include "util/gtk_icon.hpp"
 #include "util/rewrite_string.hpp"
+#include "util/text.hpp"
 
 namespace waybar::modules::sway {
 
@@ -228,7 +229,7 @@ gfnWithWorkspace(const Json::Value& nodes, std::string& output, const Json::Valu
       return {nb,
               floating_count,
               node["id"].asInt(),
-              Glib::Markup::escape_text(node["name"].asString()),
+              util::escape_markup(node["name"].asString()),
               app_id,
               app_class,
               shell,
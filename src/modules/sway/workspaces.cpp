@@ -6,6 +6,8 @@
 #include <cctype>
 #include <string>
 
+#include "util/text.hpp"
+
 namespace waybar::modules::sway {
 
 // Helper function to assign a number to a workspace, just like sway. In fact
@@ -268,7 +270,7 @@ bool Workspaces::hasFlag(const Json::Value &node, const std::string &flag) {
 void Workspaces::updateWindows(const Json::Value &node, std::string &windows) {
   if ((node["type"].asString() == "con" || node["type"].asString() == "floating_con") &&
       node["name"].isString()) {
-    std::string title = g_markup_escape_text(node["name"].asString().c_str(), -1);
+    std::string title = util::escape_markup(node["name"].asString());
     std::string windowClass = node["app_id"].asString();
     std::string windowReprKey = fmt::format("class<{}> title<{}>", windowClass, title);
     std::string window = m_windowRewriteRules.get(windowReprKey);
@@ -358,6 +360,17 @@ auto Workspaces::update() -> void {
   AModule::update();
 }
 
+void Workspaces::setFocusedButton(const std::string &name) {
+  // move the class right away, the workspace event that follows brings the full state
+  for (auto &[button_name, button] : buttons_) {
+    if (button_name == name) {
+      button.get_style_context()->add_class("focused");
+    } else {
+      button.get_style_context()->remove_class("focused");
+    }
+  }
+}
+
 Gtk::Button &Workspaces::addButton(const Json::Value &node) {
   auto pair = buttons_.emplace(node["name"].asString(), node["name"].asString());
   auto &&button = pair.first->second;
@@ -368,17 +381,19 @@ Gtk::Button &Workspaces::addButton(const Json::Value &node) {
     button.signal_pressed().connect([this, node] {
       try {
         if (node["target_output"].isString()) {
-          ipc_.sendCmd(IPC_COMMAND,
-                       fmt::format(persistent_workspace_switch_cmd_, "--no-auto-back-and-forth",
-                                   node["name"].asString(), node["target_output"].asString(),
-                                   "--no-auto-back-and-forth", node["name"].asString()));
+          ipc_.sendCmdAsync(IPC_COMMAND,
+                            fmt::format(persistent_workspace_switch_cmd_,
+                                        "--no-auto-back-and-forth", node["name"].asString(),
+                                        node["target_output"].asString(),
+                                        "--no-auto-back-and-forth", node["name"].asString()));
         } else {
-          ipc_.sendCmd(IPC_COMMAND, fmt::format("workspace {} \"{}\"",
-                                                config_["disable-auto-back-and-forth"].asBool()
-                                                    ? "--no-auto-back-and-forth"
-                                                    : "",
-                                                node["name"].asString()));
+          const auto *flag = config_["disable-auto-back-and-forth"].asBool()
+                                 ? "--no-auto-back-and-forth"
+                                 : "";
+          ipc_.sendCmdAsync(IPC_COMMAND,
+                            fmt::format("workspace {} \"{}\"", flag, node["name"].asString()));
         }
+        setFocusedButton(node["name"].asString());
       } catch (const std::exception &e) {
         spdlog::error("Workspaces: {}", e.what());
       }
@@ -459,16 +474,14 @@ bool Workspaces::handleScroll(GdkEventScroll *e) {
     }
   }
   if (!config_["warp-on-scroll"].isNull() && !config_["warp-on-scroll"].asBool()) {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format("mouse_warping none"));
-  }
-  try {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format(workspace_switch_cmd_, "--no-auto-back-and-forth", name));
-  } catch (const std::exception &e) {
-    spdlog::error("Workspaces: {}", e.what());
+    ipc_.sendCmdAsync(IPC_COMMAND, fmt::format("mouse_warping none"));
   }
+  ipc_.sendCmdAsync(IPC_COMMAND,
+                    fmt::format(workspace_switch_cmd_, "--no-auto-back-and-forth", name));
   if (!config_["warp-on-scroll"].isNull() && !config_["warp-on-scroll"].asBool()) {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format("mouse_warping container"));
+    ipc_.sendCmdAsync(IPC_COMMAND, fmt::format("mouse_warping container"));
   }
+  setFocusedButton(name);
   return true;
 }
 
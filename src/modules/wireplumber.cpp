@@ -339,13 +339,10 @@ auto waybar::modules::Wireplumber::update() -> void {
   ALabel::update();
 }
 
-bool waybar::modules::Wireplumber::handleScroll(GdkEventScroll* e) {
+void waybar::modules::Wireplumber::handleScrollSteps(SCROLL_DIR dir, unsigned steps) {
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
-    return AModule::handleScroll(e);
-  }
-  auto dir = AModule::getScrollDir(e);
-  if (dir == SCROLL_DIR::NONE) {
-    return true;
+    AModule::handleScrollSteps(dir, steps);
+    return;
   }
   double maxVolume = 1;
   double step = 1.0 / 100.0;
@@ -357,6 +354,7 @@ bool waybar::modules::Wireplumber::handleScroll(GdkEventScroll* e) {
   }
 
   if (step < min_step_) step = min_step_;
+  step *= steps;
 
   double newVol = volume_;
   if (dir == SCROLL_DIR::UP) {
@@ -375,5 +373,4 @@ bool waybar::modules::Wireplumber::handleScroll(GdkEventScroll* e) {
     gboolean ret;
     g_signal_emit_by_name(mixer_api_, "set-volume", node_id_, variant, &ret);
   }
-  return true;
 }
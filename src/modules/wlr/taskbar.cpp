@@ -1,6 +1,12 @@
 #include "modules/wlr/taskbar.hpp"
 
 #include <fmt/core.h>
+// In the 80000 version of fmt library authors decided to optimize imports
+// and moved declarations required for fmt::dynamic_format_arg_store in new
+// header fmt/args.h
+#if (FMT_VERSION >= 80000)
+#include <fmt/args.h>
+#endif
 #include <gdkmm/monitor.h>
 #include <gio/gdesktopappinfo.h>
 #include <giomm/desktopappinfo.h>
@@ -23,6 +29,7 @@
 #include "util/gtk_icon.hpp"
 #include "util/rewrite_string.hpp"
 #include "util/string.hpp"
+#include "util/text.hpp"
 
 namespace waybar::modules::wlr {
 
@@ -327,6 +334,8 @@ Task::Task(const waybar::Bar &bar, const Json::Value &config, Taskbar *tbar,
     else
       format_tooltip_ = "{title}";
   }
+  format_fields_ =
+      format_fields(format_before_) | format_fields(format_after_) | format_fields(format_tooltip_);
 
   /* Handle click events if configured */
   if (config_["on-click"].isString() || config_["on-click-middle"].isString() ||
@@ -413,9 +422,9 @@ void Task::handle_app_id(const char *app_id) {
   app_id_ = app_id;
   hide_if_ignored();
 
-  auto ids_replace_map = tbar_->app_ids_replace_map();
-  if (ids_replace_map.count(app_id_)) {
-    auto replaced_id = ids_replace_map[app_id_];
+  const auto &ids_replace_map = tbar_->app_ids_replace_map();
+  if (auto replaced = ids_replace_map.find(app_id_); replaced != ids_replace_map.end()) {
+    const auto &replaced_id = replaced->second;
     spdlog::debug(
         fmt::format("Task ({}) [{}] app_id was replaced with {}", id_, app_id_, replaced_id));
     app_id_ = replaced_id;
@@ -622,54 +631,65 @@ bool Task::operator==(const Task &o) const { return o.id_ == id_; }
 
 bool Task::operator!=(const Task &o) const { return o.id_ != id_; }
 
+uint32_t Task::format_fields(const std::string &format) {
+  uint32_t fields = 0;
+  if (format.find("{title") != std::string::npos) fields |= FIELD_TITLE;
+  if (format.find("{name") != std::string::npos) fields |= FIELD_NAME;
+  if (format.find("{app_id") != std::string::npos) fields |= FIELD_APP_ID;
+  if (format.find("{state") != std::string::npos) fields |= FIELD_STATE;
+  if (format.find("{short_state") != std::string::npos) fields |= FIELD_SHORT_STATE;
+  return fields;
+}
+
 void Task::update() {
   bool markup = config_["markup"].isBool() ? config_["markup"].asBool() : false;
-  std::string title = title_;
-  std::string name = name_;
-  std::string app_id = app_id_;
-  if (markup) {
-    title = Glib::Markup::escape_text(title);
-    name = Glib::Markup::escape_text(name);
-    app_id = Glib::Markup::escape_text(app_id);
-  }
-  if (!format_before_.empty()) {
-    auto txt =
-        fmt::format(fmt::runtime(format_before_), fmt::arg("title", title), fmt::arg("name", name),
-                    fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
-                    fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
-
-    if (markup)
-      text_before_.set_markup(txt);
-    else
-      text_before_.set_label(txt);
+  /* Only compute the fields the formats actually use, the store is shared by all of them */
+  fmt::dynamic_format_arg_store<fmt::format_context> store;
+  if (format_fields_ & FIELD_TITLE)
+    store.push_back(fmt::arg("title", markup ? util::escape_markup(title_) : title_));
+  if (format_fields_ & FIELD_NAME)
+    store.push_back(fmt::arg("name", markup ? util::escape_markup(name_) : name_));
+  if (format_fields_ & FIELD_APP_ID)
+    store.push_back(
+        fmt::arg("app_id", markup ? util::escape_markup(app_id_) : app_id_));
+  if (format_fields_ & FIELD_STATE) store.push_back(fmt::arg("state", state_string()));
+  if (format_fields_ & FIELD_SHORT_STATE)
+    store.push_back(fmt::arg("short_state", state_string(true)));
+
+  const auto &rewrite = tbar_->rewrite_rules();
+  if (!format_before_.empty()) {
+    auto txt = rewrite.apply(fmt::vformat(format_before_, store));
+    if (txt != text_before_str_) {
+      if (markup)
+        text_before_.set_markup(txt);
+      else
+        text_before_.set_label(txt);
+      text_before_str_ = std::move(txt);
+    }
     text_before_.show();
   }
   if (!format_after_.empty()) {
-    auto txt =
-        fmt::format(fmt::runtime(format_after_), fmt::arg("title", title), fmt::arg("name", name),
-                    fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
-                    fmt::arg("short_state", state_string(true)));
-
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
-
-    if (markup)
-      text_after_.set_markup(txt);
-    else
-      text_after_.set_label(txt);
+    auto txt = rewrite.apply(fmt::vformat(format_after_, store));
+    if (txt != text_after_str_) {
+      if (markup)
+        text_after_.set_markup(txt);
+      else
+        text_after_.set_label(txt);
+      text_after_str_ = std::move(txt);
+    }
     text_after_.show();
   }
 
   if (!format_tooltip_.empty()) {
-    auto txt =
-        fmt::format(fmt::runtime(format_tooltip_), fmt::arg("title", title), fmt::arg("name", name),
-                    fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
-                    fmt::arg("short_state", state_string(true)));
-    if (markup)
-      button.set_tooltip_markup(txt);
-    else
-      button.set_tooltip_text(txt);
+    auto txt = fmt::vformat(format_tooltip_, store);
+    if (txt != tooltip_str_) {
+      if (markup)
+        button.set_tooltip_markup(txt);
+      else
+        button.set_tooltip_text(txt);
+      tooltip_str_ = std::move(txt);
+    }
   }
 }
 
@@ -725,6 +745,7 @@ Taskbar::Taskbar(const std::string &id, const waybar::Bar &bar, const Json::Valu
     : waybar::AModule(config, "taskbar", id, false, false),
       bar_(bar),
       box_{bar.orientation, 0},
+      rewrite_rules_{config["rewrite"]},
       manager_{nullptr},
       seat_{nullptr} {
   box_.set_name("taskbar");
@@ -929,4 +950,6 @@ const std::map<std::string, std::string> &Taskbar::app_ids_replace_map() const {
   return app_ids_replace_map_;
 }
 
+const util::RewriteRules &Taskbar::rewrite_rules() const { return rewrite_rules_; }
+
 } /* namespace waybar::modules::wlr */
@@ -9,19 +9,64 @@
 #include <cmath>
 #include <stdexcept>
 
+#include "util/profiler.hpp"
+
 namespace waybar::util {
 
-AudioBackend::AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag)
+SinkState SinkState::from(const pa_sink_info &i) {
+  SinkState state;
+  state.index = i.index;
+  state.volume = std::round(static_cast<float>(pa_cvolume_avg(&i.volume)) /
+                            float{PA_VOLUME_NORM} * 100.0F);
+  state.muted = i.mute != 0;
+  state.desc = i.description;
+  state.monitor = i.monitor_source_name;
+  state.port_name = i.active_port != nullptr ? i.active_port->name : "Unknown";
+  if (auto ff = pa_proplist_gets(i.proplist, PA_PROP_DEVICE_FORM_FACTOR)) {
+    state.form_factor = ff;
+  }
+  return state;
+}
+
+SourceState SourceState::from(const pa_source_info &i) {
+  SourceState state;
+  state.index = i.index;
+  state.volume = std::round(static_cast<float>(pa_cvolume_avg(&i.volume)) /
+                            float{PA_VOLUME_NORM} * 100.0F);
+  state.muted = i.mute != 0;
+  state.desc = i.description;
+  state.port_name = i.active_port != nullptr ? i.active_port->name : "Unknown";
+  return state;
+}
+
+AudioQuery audioQueryFor(pa_subscription_event_type_t type) {
+  unsigned facility = type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+  unsigned operation = type & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
+  if (operation != PA_SUBSCRIPTION_EVENT_CHANGE) {
+    return AudioQuery::None;
+  }
+  switch (facility) {
+    case PA_SUBSCRIPTION_EVENT_SERVER:
+      return AudioQuery::Server;
+    case PA_SUBSCRIPTION_EVENT_SINK:
+      return AudioQuery::Sink;
+    case PA_SUBSCRIPTION_EVENT_SINK_INPUT:
+      return AudioQuery::SinkInput;
+    case PA_SUBSCRIPTION_EVENT_SOURCE:
+      return AudioQuery::Source;
+    case PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT:
+      return AudioQuery::SourceOutput;
+    default:
+      return AudioQuery::None;
+  }
+}
+
+AudioBackend::AudioBackend(std::vector<std::string> ignored_sinks, private_constructor_tag tag)
     : mainloop_(nullptr),
       mainloop_api_(nullptr),
       context_(nullptr),
-      sink_idx_(0),
-      volume_(0),
-      muted_(false),
-      source_idx_(0),
-      source_volume_(0),
-      source_muted_(false),
-      on_updated_cb_(on_updated_cb) {
+      current_sink_running_(false),
+      ignored_sinks_(std::move(ignored_sinks)) {
   mainloop_ = pa_threaded_mainloop_new();
   if (mainloop_ == nullptr) {
     throw std::runtime_error("pa_mainloop_new() failed.");
@@ -35,6 +80,22 @@ AudioBackend::AudioBackend(std::function<void()> on_updated_cb, private_construc
   pa_threaded_mainloop_unlock(mainloop_);
 }
 
+AudioBackend::AudioBackend(std::vector<std::string> ignored_sinks, AudioQueryHook query_hook,
+                           private_constructor_tag tag)
+    : mainloop_(nullptr),
+      mainloop_api_(nullptr),
+      context_(nullptr),
+      current_sink_running_(false),
+      ignored_sinks_(std::move(ignored_sinks)),
+      query_hook_(std::move(query_hook)) {
+  // never started, only its lock guards the listeners
+  mainloop_ = pa_threaded_mainloop_new();
+  if (mainloop_ == nullptr) {
+    throw std::runtime_error("pa_mainloop_new() failed.");
+  }
+  mainloop_api_ = pa_threaded_mainloop_get_api(mainloop_);
+}
+
 AudioBackend::~AudioBackend() {
   if (context_ != nullptr) {
     pa_context_disconnect(context_);
@@ -47,9 +108,68 @@ AudioBackend::~AudioBackend() {
   }
 }
 
-std::shared_ptr<AudioBackend> AudioBackend::getInstance(std::function<void()> on_updated_cb) {
+std::shared_ptr<AudioBackend> AudioBackend::getInstance(const Json::Value &ignored_sinks) {
+  std::vector<std::string> ignored;
+  if (ignored_sinks.isArray()) {
+    for (const auto &ignored_sink : ignored_sinks) {
+      if (ignored_sink.isString()) {
+        ignored.push_back(ignored_sink.asString());
+      }
+    }
+  }
+  std::sort(ignored.begin(), ignored.end());
+  ignored.erase(std::unique(ignored.begin(), ignored.end()), ignored.end());
+
+  static std::map<std::vector<std::string>, std::weak_ptr<AudioBackend>> instances;
+  auto backend = instances[ignored].lock();
+  if (!backend) {
+    private_constructor_tag tag;
+    backend = std::make_shared<AudioBackend>(ignored, tag);
+    instances[ignored] = backend;
+  }
+  return backend;
+}
+
+std::shared_ptr<AudioBackend> AudioBackend::create(std::vector<std::string> ignored_sinks,
+                                                   AudioQueryHook query_hook) {
   private_constructor_tag tag;
-  return std::make_shared<AudioBackend>(on_updated_cb, tag);
+  return std::make_shared<AudioBackend>(std::move(ignored_sinks), std::move(query_hook), tag);
+}
+
+void AudioBackend::replay(pa_subscription_event_type_t type, uint32_t idx) {
+  subscribeCb(context_, type, idx, this);
+}
+
+void AudioBackend::replay(const pa_server_info &i) { serverInfoCb(context_, &i, this); }
+
+void AudioBackend::replay(const pa_sink_info &i) { sinkInfoCb(context_, &i, 0, this); }
+
+void AudioBackend::replay(const pa_sink_input_info &i) { sinkInputInfoCb(context_, &i, 0, this); }
+
+void AudioBackend::replay(const pa_source_info &i) { sourceInfoCb(context_, &i, 0, this); }
+
+void AudioBackend::replay(const pa_source_output_info &i) {
+  sourceOutputInfoCb(context_, &i, 0, this);
+}
+
+uint64_t AudioBackend::addListener(std::function<void()> on_updated_cb) {
+  pa_threaded_mainloop_lock(mainloop_);
+  const auto id = next_listener_++;
+  listeners_.emplace(id, std::move(on_updated_cb));
+  pa_threaded_mainloop_unlock(mainloop_);
+  return id;
+}
+
+void AudioBackend::removeListener(uint64_t id) {
+  pa_threaded_mainloop_lock(mainloop_);
+  listeners_.erase(id);
+  pa_threaded_mainloop_unlock(mainloop_);
+}
+
+void AudioBackend::notify() {
+  for (auto &[id, listener] : listeners_) {
+    listener();
+  }
 }
 
 void AudioBackend::connectContext() {
@@ -65,6 +185,43 @@ void AudioBackend::connectContext() {
   }
 }
 
+/*
+ * Issues an introspection request, answered in the matching info callback.
+ */
+void AudioBackend::request(AudioQuery query, uint32_t idx) {
+  if (query_hook_) {
+    query_hook_(query, idx);
+    return;
+  }
+  switch (query) {
+    case AudioQuery::Server:
+      pa_context_get_server_info(context_, serverInfoCb, this);
+      break;
+    case AudioQuery::Sink:
+      if (idx == PA_INVALID_INDEX) {
+        pa_context_get_sink_info_list(context_, sinkInfoCb, this);
+      } else {
+        pa_context_get_sink_info_by_index(context_, idx, sinkInfoCb, this);
+      }
+      break;
+    case AudioQuery::SinkInput:
+      pa_context_get_sink_input_info(context_, idx, sinkInputInfoCb, this);
+      break;
+    case AudioQuery::Source:
+      if (idx == PA_INVALID_INDEX) {
+        pa_context_get_source_info_list(context_, sourceInfoCb, this);
+      } else {
+        pa_context_get_source_info_by_index(context_, idx, sourceInfoCb, this);
+      }
+      break;
+    case AudioQuery::SourceOutput:
+      pa_context_get_source_output_info(context_, idx, sourceOutputInfoCb, this);
+      break;
+    case AudioQuery::None:
+      break;
+  }
+}
+
 void AudioBackend::contextStateCb(pa_context *c, void *data) {
   auto backend = static_cast<AudioBackend *>(data);
   switch (pa_context_get_state(c)) {
@@ -72,7 +229,7 @@ void AudioBackend::contextStateCb(pa_context *c, void *data) {
       backend->mainloop_api_->quit(backend->mainloop_api_, 0);
       break;
     case PA_CONTEXT_READY:
-      pa_context_get_server_info(c, serverInfoCb, data);
+      backend->request(AudioQuery::Server);
       pa_context_set_subscribe_callback(c, subscribeCb, data);
       pa_context_subscribe(c,
                            static_cast<enum pa_subscription_mask>(
@@ -102,25 +259,12 @@ void AudioBackend::contextStateCb(pa_context *c, void *data) {
 
 /*
  * Called when an event we subscribed to occurs.
+ * Stream events only refresh the sink or source the stream is connected to.
  */
-void AudioBackend::subscribeCb(pa_context *context, pa_subscription_event_type_t type, uint32_t idx,
-                               void *data) {
-  unsigned facility = type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
-  unsigned operation = type & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
-  if (operation != PA_SUBSCRIPTION_EVENT_CHANGE) {
-    return;
-  }
-  if (facility == PA_SUBSCRIPTION_EVENT_SERVER) {
-    pa_context_get_server_info(context, serverInfoCb, data);
-  } else if (facility == PA_SUBSCRIPTION_EVENT_SINK) {
-    pa_context_get_sink_info_by_index(context, idx, sinkInfoCb, data);
-  } else if (facility == PA_SUBSCRIPTION_EVENT_SINK_INPUT) {
-    pa_context_get_sink_info_list(context, sinkInfoCb, data);
-  } else if (facility == PA_SUBSCRIPTION_EVENT_SOURCE) {
-    pa_context_get_source_info_by_index(context, idx, sourceInfoCb, data);
-  } else if (facility == PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT) {
-    pa_context_get_source_info_list(context, sourceInfoCb, data);
-  }
+void AudioBackend::subscribeCb(pa_context * /*context*/, pa_subscription_event_type_t type,
+                               uint32_t idx, void *data) {
+  Profiler::Scope scope(Profiler::account("pulseaudio"));
+  static_cast<AudioBackend *>(data)->request(audioQueryFor(type), idx);
 }
 
 /*
@@ -129,7 +273,27 @@ void AudioBackend::subscribeCb(pa_context *context, pa_subscription_event_type_t
 void AudioBackend::volumeModifyCb(pa_context *c, int success, void *data) {
   auto backend = static_cast<AudioBackend *>(data);
   if (success != 0) {
-    pa_context_get_sink_info_by_index(backend->context_, backend->sink_idx_, sinkInfoCb, data);
+    backend->request(AudioQuery::Sink, backend->sink_.index);
+  }
+}
+
+/*
+ * Called when the requested sink input information is ready.
+ */
+void AudioBackend::sinkInputInfoCb(pa_context * /*context*/, const pa_sink_input_info *i,
+                                   int /*eol*/, void *data) {
+  if (i != nullptr && i->sink != PA_INVALID_INDEX) {
+    static_cast<AudioBackend *>(data)->request(AudioQuery::Sink, i->sink);
+  }
+}
+
+/*
+ * Called when the requested source output information is ready.
+ */
+void AudioBackend::sourceOutputInfoCb(pa_context * /*context*/, const pa_source_output_info *i,
+                                      int /*eol*/, void *data) {
+  if (i != nullptr && i->source != PA_INVALID_INDEX) {
+    static_cast<AudioBackend *>(data)->request(AudioQuery::Source, i->source);
   }
 }
 
@@ -138,6 +302,7 @@ void AudioBackend::volumeModifyCb(pa_context *c, int success, void *data) {
  */
 void AudioBackend::sinkInfoCb(pa_context * /*context*/, const pa_sink_info *i, int /*eol*/,
                               void *data) {
+  Profiler::Scope scope(Profiler::account("pulseaudio"));
   if (i == nullptr) return;
 
   auto backend = static_cast<AudioBackend *>(data);
@@ -165,20 +330,12 @@ void AudioBackend::sinkInfoCb(pa_context * /*context*/, const pa_sink_info *i, i
 
   if (backend->current_sink_name_ == i->name) {
     backend->pa_volume_ = i->volume;
-    float volume =
-        static_cast<float>(pa_cvolume_avg(&(backend->pa_volume_))) / float{PA_VOLUME_NORM};
-    backend->sink_idx_ = i->index;
-    backend->volume_ = std::round(volume * 100.0F);
-    backend->muted_ = i->mute != 0;
-    backend->desc_ = i->description;
-    backend->monitor_ = i->monitor_source_name;
-    backend->port_name_ = i->active_port != nullptr ? i->active_port->name : "Unknown";
-    if (auto ff = pa_proplist_gets(i->proplist, PA_PROP_DEVICE_FORM_FACTOR)) {
-      backend->form_factor_ = ff;
-    } else {
-      backend->form_factor_ = "";
+    auto sink = SinkState::from(*i);
+    // stream and state events often leave the rendered fields untouched
+    if (sink != backend->sink_) {
+      backend->sink_ = std::move(sink);
+      backend->notify();
     }
-    backend->on_updated_cb_();
   }
 }
 
@@ -187,15 +344,14 @@ void AudioBackend::sinkInfoCb(pa_context * /*context*/, const pa_sink_info *i, i
  */
 void AudioBackend::sourceInfoCb(pa_context * /*context*/, const pa_source_info *i, int /*eol*/,
                                 void *data) {
+  Profiler::Scope scope(Profiler::account("pulseaudio"));
   auto backend = static_cast<AudioBackend *>(data);
   if (i != nullptr && backend->default_source_name_ == i->name) {
-    auto source_volume = static_cast<float>(pa_cvolume_avg(&(i->volume))) / float{PA_VOLUME_NORM};
-    backend->source_volume_ = std::round(source_volume * 100.0F);
-    backend->source_idx_ = i->index;
-    backend->source_muted_ = i->mute != 0;
-    backend->source_desc_ = i->description;
-    backend->source_port_name_ = i->active_port != nullptr ? i->active_port->name : "Unknown";
-    backend->on_updated_cb_();
+    auto source = SourceState::from(*i);
+    if (source != backend->source_) {
+      backend->source_ = std::move(source);
+      backend->notify();
+    }
   }
 }
 
@@ -203,13 +359,14 @@ void AudioBackend::sourceInfoCb(pa_context * /*context*/, const pa_source_info *
  * Called when the requested information on the server is ready. This is
  * used to find the default PulseAudio sink.
  */
-void AudioBackend::serverInfoCb(pa_context *context, const pa_server_info *i, void *data) {
+void AudioBackend::serverInfoCb(pa_context * /*context*/, const pa_server_info *i, void *data) {
+  Profiler::Scope scope(Profiler::account("pulseaudio"));
   auto backend = static_cast<AudioBackend *>(data);
   backend->current_sink_name_ = i->default_sink_name;
   backend->default_source_name_ = i->default_source_name;
 
-  pa_context_get_sink_info_list(context, sinkInfoCb, data);
-  pa_context_get_source_info_list(context, sourceInfoCb, data);
+  backend->request(AudioQuery::Sink);
+  backend->request(AudioQuery::Source);
 }
 
 void AudioBackend::changeVolume(uint16_t volume, uint16_t min_volume, uint16_t max_volume) {
@@ -219,7 +376,7 @@ void AudioBackend::changeVolume(uint16_t volume, uint16_t min_volume, uint16_t m
   volume = std::clamp(volume, min_volume, max_volume);
   pa_cvolume_set(&pa_volume, pa_volume_.channels, volume * volume_tick);
 
-  pa_context_set_sink_volume_by_index(context_, sink_idx_, &pa_volume, volumeModifyCb, this);
+  pa_context_set_sink_volume_by_index(context_, sink_.index, &pa_volume, volumeModifyCb, this);
 }
 
 void AudioBackend::changeVolume(ChangeType change_type, double step, uint16_t max_volume) {
@@ -230,61 +387,45 @@ void AudioBackend::changeVolume(ChangeType change_type, double step, uint16_t ma
   max_volume = std::min(max_volume, static_cast<uint16_t>(PA_VOLUME_UI_MAX));
 
   if (change_type == ChangeType::Increase) {
-    if (volume_ < max_volume) {
-      if (volume_ + step > max_volume) {
-        change = round((max_volume - volume_) * volume_tick);
+    if (sink_.volume < max_volume) {
+      if (sink_.volume + step > max_volume) {
+        change = round((max_volume - sink_.volume) * volume_tick);
       } else {
         change = round(step * volume_tick);
       }
       pa_cvolume_inc(&pa_volume, change);
     }
   } else if (change_type == ChangeType::Decrease) {
-    if (volume_ > 0) {
-      if (volume_ - step < 0) {
-        change = round(volume_ * volume_tick);
+    if (sink_.volume > 0) {
+      if (sink_.volume - step < 0) {
+        change = round(sink_.volume * volume_tick);
       } else {
         change = round(step * volume_tick);
       }
       pa_cvolume_dec(&pa_volume, change);
     }
   }
-  pa_context_set_sink_volume_by_index(context_, sink_idx_, &pa_volume, volumeModifyCb, this);
+  pa_context_set_sink_volume_by_index(context_, sink_.index, &pa_volume, volumeModifyCb, this);
 }
 
-void AudioBackend::toggleSinkMute() {
-  muted_ = !muted_;
-  pa_context_set_sink_mute_by_index(context_, sink_idx_, muted_, nullptr, nullptr);
-}
+// The cached state is left to the change event, so the modules get notified of the new value
+
+void AudioBackend::toggleSinkMute() { toggleSinkMute(!sink_.muted); }
 
 void AudioBackend::toggleSinkMute(bool mute) {
-  muted_ = mute;
-  pa_context_set_sink_mute_by_index(context_, sink_idx_, muted_, nullptr, nullptr);
+  pa_context_set_sink_mute_by_index(context_, sink_.index, mute, nullptr, nullptr);
 }
 
-void AudioBackend::toggleSourceMute() {
-  source_muted_ = !muted_;
-  pa_context_set_source_mute_by_index(context_, source_idx_, source_muted_, nullptr, nullptr);
-}
+void AudioBackend::toggleSourceMute() { toggleSourceMute(!source_.muted); }
 
 void AudioBackend::toggleSourceMute(bool mute) {
-  source_muted_ = mute;
-  pa_context_set_source_mute_by_index(context_, source_idx_, source_muted_, nullptr, nullptr);
+  pa_context_set_source_mute_by_index(context_, source_.index, mute, nullptr, nullptr);
 }
 
 bool AudioBackend::isBluetooth() {
-  return monitor_.find("a2dp_sink") != std::string::npos ||  // PulseAudio
-         monitor_.find("a2dp-sink") != std::string::npos ||  // PipeWire
-         monitor_.find("bluez") != std::string::npos;
-}
-
-void AudioBackend::setIgnoredSinks(const Json::Value &config) {
-  if (config.isArray()) {
-    for (const auto &ignored_sink : config) {
-      if (ignored_sink.isString()) {
-        ignored_sinks_.push_back(ignored_sink.asString());
-      }
-    }
-  }
+  return sink_.monitor.find("a2dp_sink") != std::string::npos ||  // PulseAudio
+         sink_.monitor.find("a2dp-sink") != std::string::npos ||  // PipeWire
+         sink_.monitor.find("bluez") != std::string::npos;
 }
 
 }  // namespace waybar::util
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 #include <optional>
 
+#include "util/profiler.hpp"
+
 namespace {
 class FileDescriptor {
  public:
@@ -153,6 +155,8 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
       Gio::DBus::BusType::BUS_TYPE_SYSTEM, "org.freedesktop.login1",
       "/org/freedesktop/login1/session/self", "org.freedesktop.login1.Session");
 
+  // one udev thread serves every backlight module
+  Thread::Owner owner("backlight-udev");
   udev_thread_ = [this] {
     std::unique_ptr<udev, UdevDeleter> udev{udev_new()};
     check_nn(udev.get(), "Udev new failed");
@@ -182,6 +186,7 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
       if (!udev_thread_.isRunning()) {
         break;
       }
+      Profiler::Scope scope(Profiler::account("backlight-udev"), false);
       decltype(devices_) devices;
       {
         std::scoped_lock<std::mutex> lock(udev_thread_mutex_);
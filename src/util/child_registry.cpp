@@ -0,0 +1,113 @@
+#include "util/child_registry.hpp"
+
+#include <spdlog/spdlog.h>
+#include <sys/wait.h>
+
+#include <csignal>
+#include <vector>
+
+namespace waybar::util {
+
+ChildRegistry &ChildRegistry::inst() {
+  static ChildRegistry registry;
+  return registry;
+}
+
+void ChildRegistry::add(pid_t pid, Owner owner, ExitCallback on_exit) {
+  if (pid <= 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // a short command may have exited and its SIGCHLD been handled before it got here
+    if (waitpid(pid, nullptr, WNOHANG) != pid) {
+      children_[pid] = {owner, std::move(on_exit)};
+      if (owner != nullptr) {
+        owners_[owner].insert(pid);
+      }
+      spdlog::debug("Added child to reap list: {}", pid);
+      return;
+    }
+  }
+  spdlog::debug("Reaped child with PID: {}", pid);
+  if (on_exit) {
+    on_exit();
+  }
+}
+
+void ChildRegistry::reap() {
+  std::vector<ExitCallback> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // SIGCHLD is not queued, one signal may stand for several exits.
+    // Only registered pids are waited for, command::exec waits for its own children.
+    std::vector<pid_t> exited;
+    for (const auto &[pid, child] : children_) {
+      if (waitpid(pid, nullptr, WNOHANG) == pid) {
+        exited.push_back(pid);
+      }
+    }
+    for (auto pid : exited) {
+      spdlog::debug("Reaped child with PID: {}", pid);
+      if (auto on_exit = erase(pid)) {
+        callbacks.push_back(std::move(on_exit));
+      }
+    }
+  }
+  // outside the lock, a callback may spawn the next child
+  for (auto &on_exit : callbacks) {
+    on_exit();
+  }
+}
+
+void ChildRegistry::terminate(Owner owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = owners_.find(owner);
+  if (it == owners_.end()) {
+    return;
+  }
+  for (auto pid : it->second) {
+    // not reaped yet, so the pid (and its process group) can't have been recycled
+    killpg(pid, SIGTERM);
+    // keep the entry without an owner so the child is still reaped
+    children_[pid].owner = nullptr;
+  }
+  owners_.erase(it);
+}
+
+bool ChildRegistry::contains(pid_t pid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return children_.count(pid) != 0;
+}
+
+size_t ChildRegistry::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return children_.size();
+}
+
+size_t ChildRegistry::size(Owner owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = owners_.find(owner);
+  return it == owners_.end() ? 0 : it->second.size();
+}
+
+ChildRegistry::ExitCallback ChildRegistry::erase(pid_t pid) {
+  auto it = children_.find(pid);
+  if (it == children_.end()) {
+    return {};
+  }
+  if (it->second.owner != nullptr) {
+    auto owner = owners_.find(it->second.owner);
+    if (owner != owners_.end()) {
+      owner->second.erase(pid);
+      if (owner->second.empty()) {
+        owners_.erase(owner);
+      }
+    }
+  }
+  auto on_exit = std::move(it->second.on_exit);
+  children_.erase(it);
+  return on_exit;
+}
+
+}  // namespace waybar::util
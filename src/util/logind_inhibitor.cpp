@@ -0,0 +1,172 @@
+#include "util/logind_inhibitor.hpp"
+
+#include <gio/gunixfdlist.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include <set>
+#include <sstream>
+
+namespace waybar::util {
+
+namespace {
+
+// Carried through the async call, the inhibitor may be gone when logind replies
+struct Request {
+  std::weak_ptr<LogindInhibitor> inhibitor;
+  std::string what;
+};
+
+}  // namespace
+
+std::shared_ptr<LogindInhibitor> LogindInhibitor::getInstance() {
+  static std::weak_ptr<LogindInhibitor> instance;
+  auto inhibitor = instance.lock();
+  if (!inhibitor) {
+    GError* error = nullptr;
+    GDBusConnection* bus = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+    if (error) {
+      spdlog::error("g_bus_get_sync() failed: {}", error->message);
+      g_error_free(error);
+    }
+    inhibitor = create(bus);
+    if (bus) {
+      g_object_unref(bus);
+    }
+    instance = inhibitor;
+  }
+  return inhibitor;
+}
+
+std::shared_ptr<LogindInhibitor> LogindInhibitor::create(GDBusConnection* bus) {
+  return std::shared_ptr<LogindInhibitor>(new LogindInhibitor(bus));
+}
+
+LogindInhibitor::LogindInhibitor(GDBusConnection* bus)
+    : bus_(bus ? G_DBUS_CONNECTION(g_object_ref(bus)) : nullptr) {}
+
+LogindInhibitor::~LogindInhibitor() {
+  for (auto& [what, lock] : locks_) {
+    if (lock.request) {
+      // the reply handler closes the fd once the call completes
+      g_cancellable_cancel(lock.request);
+      g_object_unref(lock.request);
+    }
+    release(lock);
+  }
+  if (bus_) {
+    g_object_unref(bus_);
+  }
+}
+
+std::string LogindInhibitor::normalize(const std::string& what) {
+  std::set<std::string> inhibitors;
+  std::istringstream stream(what);
+  for (std::string inhibitor; std::getline(stream, inhibitor, ':');) {
+    if (!inhibitor.empty()) {
+      inhibitors.insert(inhibitor);
+    }
+  }
+
+  std::string key;
+  for (const auto& inhibitor : inhibitors) {
+    if (!key.empty()) {
+      key += ':';
+    }
+    key += inhibitor;
+  }
+  return key;
+}
+
+bool LogindInhibitor::active(const std::string& what) const {
+  auto it = locks_.find(normalize(what));
+  return it != locks_.end() && it->second.fd != -1;
+}
+
+bool LogindInhibitor::pending(const std::string& what) const {
+  auto it = locks_.find(normalize(what));
+  return it != locks_.end() && it->second.request != nullptr;
+}
+
+void LogindInhibitor::toggle(const std::string& what) {
+  const auto key = normalize(what);
+  auto& lock = locks_[key];
+
+  lock.wanted = !lock.wanted;
+  if (!lock.wanted) {
+    // an in-flight request is dropped when its reply arrives
+    release(lock);
+  } else if (lock.fd == -1 && lock.request == nullptr) {
+    inhibit(key);
+  }
+  signal_changed_.emit(key);
+}
+
+void LogindInhibitor::inhibit(const std::string& what) {
+  auto& lock = locks_[what];
+  if (!bus_) {
+    spdlog::error("cannot get inhibitor locks: no system bus");
+    lock.wanted = false;
+    return;
+  }
+
+  lock.request = g_cancellable_new();
+  g_dbus_connection_call_with_unix_fd_list(
+      bus_, "org.freedesktop.login1", "/org/freedesktop/login1", "org.freedesktop.login1.Manager",
+      "Inhibit", g_variant_new("(ssss)", what.c_str(), "waybar", "Asked by user", "block"),
+      G_VARIANT_TYPE("(h)"), G_DBUS_CALL_FLAGS_NONE, -1, nullptr, lock.request,
+      [](GObject* source, GAsyncResult* res, gpointer data) {
+        std::unique_ptr<Request> request(static_cast<Request*>(data));
+        GError* error = nullptr;
+        GUnixFDList* fd_list = nullptr;
+        int fd = -1;
+
+        auto* reply = g_dbus_connection_call_with_unix_fd_list_finish(G_DBUS_CONNECTION(source),
+                                                                      &fd_list, res, &error);
+        if (error) {
+          if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            spdlog::error("Inhibit({}) failed: {}", request->what, error->message);
+          }
+          g_error_free(error);
+        } else {
+          gint index;
+          g_variant_get(reply, "(h)", &index);
+          g_variant_unref(reply);
+          fd = g_unix_fd_list_get(fd_list, index, nullptr);
+          g_object_unref(fd_list);
+        }
+
+        if (auto inhibitor = request->inhibitor.lock()) {
+          inhibitor->handleReply(request->what, fd);
+        } else if (fd != -1) {
+          ::close(fd);
+        }
+      },
+      new Request{weak_from_this(), what});
+}
+
+void LogindInhibitor::handleReply(const std::string& what, int fd) {
+  auto& lock = locks_[what];
+  if (lock.request) {
+    g_object_unref(lock.request);
+    lock.request = nullptr;
+  }
+
+  if (fd == -1) {
+    lock.wanted = false;
+  } else if (lock.wanted) {
+    lock.fd = fd;
+  } else {
+    ::close(fd);
+  }
+  signal_changed_.emit(what);
+}
+
+void LogindInhibitor::release(Lock& lock) {
+  if (lock.fd != -1) {
+    ::close(lock.fd);
+    lock.fd = -1;
+  }
+}
+
+}  // namespace waybar::util
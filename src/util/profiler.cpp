@@ -0,0 +1,172 @@
+#include "util/profiler.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+
+namespace waybar::util {
+
+namespace {
+
+// Plain counters, operator new may run before any thread_local constructor could
+thread_local uint64_t thread_allocations = 0;
+thread_local uint64_t thread_allocated_bytes = 0;
+thread_local Profiler::Scope *thread_scope = nullptr;
+thread_local Profiler::Account *thread_account = nullptr;
+
+uint64_t clockNs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+std::mutex accounts_mutex;
+// deque keeps the accounts in place, scopes hold plain pointers to them
+std::deque<Profiler::Account> &accounts() {
+  static auto *list = new std::deque<Profiler::Account>();
+  return *list;
+}
+std::map<std::string, Profiler::Account *> &accountsByName() {
+  static auto *map = new std::map<std::string, Profiler::Account *>();
+  return *map;
+}
+
+void *countedAlloc(std::size_t size) {
+  ++thread_allocations;
+  thread_allocated_bytes += size;
+  if (void *ptr = std::malloc(size != 0 ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+Profiler::Scope::Scope(Account *account, bool wall) : account_(account), wall_(wall) {
+  if (account_ == nullptr) {
+    return;
+  }
+  parent_ = thread_scope;
+  thread_scope = this;
+  thread_account = account_;
+  wall_start_ = wall_ ? clockNs(CLOCK_MONOTONIC) : 0;
+  cpu_start_ = clockNs(CLOCK_THREAD_CPUTIME_ID);
+  allocations_start_ = thread_allocations;
+  bytes_start_ = thread_allocated_bytes;
+}
+
+Profiler::Scope::~Scope() {
+  if (account_ == nullptr) {
+    return;
+  }
+  const uint64_t wall = wall_ ? clockNs(CLOCK_MONOTONIC) - wall_start_ : 0;
+  const uint64_t cpu = clockNs(CLOCK_THREAD_CPUTIME_ID) - cpu_start_;
+  const uint64_t allocations = thread_allocations - allocations_start_;
+  const uint64_t bytes = thread_allocated_bytes - bytes_start_;
+
+  account_->calls.fetch_add(1, std::memory_order_relaxed);
+  account_->wall_ns.fetch_add(wall - std::min(wall, child_wall_), std::memory_order_relaxed);
+  account_->cpu_ns.fetch_add(cpu - std::min(cpu, child_cpu_), std::memory_order_relaxed);
+  account_->allocations.fetch_add(allocations - child_allocations_, std::memory_order_relaxed);
+  account_->allocated_bytes.fetch_add(bytes - child_bytes_, std::memory_order_relaxed);
+
+  thread_scope = parent_;
+  thread_account = parent_ != nullptr ? parent_->account_ : nullptr;
+  if (parent_ != nullptr) {
+    parent_->child_wall_ += wall;
+    parent_->child_cpu_ += cpu;
+    parent_->child_allocations_ += allocations;
+    parent_->child_bytes_ += bytes;
+  }
+}
+
+Profiler::Account *Profiler::account(const std::string &name) {
+  if (!enabled()) {
+    return nullptr;
+  }
+  std::lock_guard lock(accounts_mutex);
+  auto &by_name = accountsByName();
+  auto it = by_name.find(name);
+  if (it == by_name.end()) {
+    it = by_name.emplace(name, &accounts().emplace_back(name)).first;
+  }
+  return it->second;
+}
+
+Profiler::Account *Profiler::current() { return thread_account; }
+
+uint64_t Profiler::threadAllocations() { return thread_allocations; }
+
+uint64_t Profiler::threadAllocatedBytes() { return thread_allocated_bytes; }
+
+std::vector<Profiler::Totals> Profiler::snapshot() {
+  std::vector<Totals> totals;
+  {
+    std::lock_guard lock(accounts_mutex);
+    for (const auto &account : accounts()) {
+      totals.push_back({account.name, account.calls.load(), account.wall_ns.load(),
+                        account.cpu_ns.load(), account.allocations.load(),
+                        account.allocated_bytes.load()});
+    }
+  }
+  std::sort(totals.begin(), totals.end(),
+            [](const auto &a, const auto &b) { return a.cpu_ns > b.cpu_ns; });
+  return totals;
+}
+
+std::vector<Profiler::Totals> Profiler::difference(const std::vector<Totals> &now,
+                                                   const std::vector<Totals> &before) {
+  std::map<std::string_view, const Totals *> previous;
+  for (const auto &totals : before) {
+    previous.emplace(totals.name, &totals);
+  }
+  std::vector<Totals> result;
+  for (auto totals : now) {
+    if (auto it = previous.find(totals.name); it != previous.end()) {
+      totals.calls -= it->second->calls;
+      totals.wall_ns -= it->second->wall_ns;
+      totals.cpu_ns -= it->second->cpu_ns;
+      totals.allocations -= it->second->allocations;
+      totals.allocated_bytes -= it->second->allocated_bytes;
+    }
+    if (totals.cpu_ns != 0 || totals.allocations != 0) {
+      result.push_back(std::move(totals));
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const auto &a, const auto &b) { return a.cpu_ns > b.cpu_ns; });
+  return result;
+}
+
+std::string Profiler::report(const std::vector<Totals> &totals) {
+  size_t width = 7;
+  for (const auto &account : totals) {
+    width = std::max(width, account.name.size());
+  }
+  auto out = fmt::format("{:<{}} {:>10} {:>12} {:>12} {:>12} {:>12}\n", "account", width,
+                         "calls", "cpu ms", "wall ms", "allocs", "alloc KiB");
+  for (const auto &account : totals) {
+    out += fmt::format("{:<{}} {:>10} {:>12.3f} {:>12.3f} {:>12} {:>12.1f}\n", account.name,
+                       width, account.calls, account.cpu_ns / 1e6, account.wall_ns / 1e6,
+                       account.allocations, account.allocated_bytes / 1024.0);
+  }
+  return out;
+}
+
+}  // namespace waybar::util
+
+// Counting replacements of the global allocation functions, cheap enough to stay always on
+void *operator new(std::size_t size) { return waybar::util::countedAlloc(size); }
+void *operator new[](std::size_t size) { return waybar::util::countedAlloc(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t /*size*/) noexcept { std::free(ptr); }
@@ -10,22 +10,36 @@ std::string rewriteString(const std::string& value, const Json::Value& rules) {
     return value;
   }
 
-  std::string res = value;
+  return RewriteRules(rules).apply(value);
+}
+
+RewriteRules::RewriteRules(const Json::Value& rules) {
+  if (!rules.isObject()) {
+    return;
+  }
 
   for (auto it = rules.begin(); it != rules.end(); ++it) {
     if (it.key().isString() && it->isString()) {
       try {
         // malformated regexes will cause an exception.
         // in this case, log error and try the next rule.
-        const std::regex rule{it.key().asString(), std::regex_constants::icase};
-        if (std::regex_match(value, rule)) {
-          res = std::regex_replace(res, rule, it->asString());
-        }
+        rules_.emplace_back(std::regex{it.key().asString(), std::regex_constants::icase},
+                            it->asString());
       } catch (const std::regex_error& e) {
         spdlog::error("Invalid rule {}: {}", it.key().asString(), e.what());
       }
     }
   }
+}
+
+std::string RewriteRules::apply(const std::string& value) const {
+  std::string res = value;
+
+  for (const auto& [rule, replacement] : rules_) {
+    if (std::regex_match(value, rule)) {
+      res = std::regex_replace(res, rule, replacement);
+    }
+  }
 
   return res;
 }
@@ -25,11 +25,30 @@
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstring>
 
-waybar::util::Rfkill::Rfkill(const enum rfkill_type rfkill_type) : rfkill_type_(rfkill_type) {
-  fd_ = open("/dev/rfkill", O_RDONLY);
+namespace waybar::util {
+
+std::shared_ptr<RfkillMonitor> RfkillMonitor::getInstance() {
+  static std::weak_ptr<RfkillMonitor> instance;
+  auto monitor = instance.lock();
+  if (!monitor) {
+    int fd = open("/dev/rfkill", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      spdlog::error("Can't open RFKILL control device");
+    }
+    monitor = create(fd);
+    instance = monitor;
+  }
+  return monitor;
+}
+
+std::shared_ptr<RfkillMonitor> RfkillMonitor::create(int fd) {
+  return std::shared_ptr<RfkillMonitor>(new RfkillMonitor(fd));
+}
+
+RfkillMonitor::RfkillMonitor(int fd) : fd_(fd) {
   if (fd_ < 0) {
-    spdlog::error("Can't open RFKILL control device");
     return;
   }
   int rc = fcntl(fd_, F_SETFL, O_NONBLOCK);
@@ -39,43 +58,118 @@ waybar::util::Rfkill::Rfkill(const enum rfkill_type rfkill_type) : rfkill_type_(
     fd_ = -1;
     return;
   }
-  Glib::signal_io().connect(sigc::mem_fun(*this, &Rfkill::on_event), fd_,
-                            Glib::IO_IN | Glib::IO_ERR | Glib::IO_HUP);
+  // the kernel queues an ADD event for every existing device on open
+  watch_ = Glib::signal_io().connect(sigc::mem_fun(*this, &RfkillMonitor::on_event), fd_,
+                                     Glib::IO_IN | Glib::IO_ERR | Glib::IO_HUP);
 }
 
-waybar::util::Rfkill::~Rfkill() {
+RfkillMonitor::~RfkillMonitor() {
+  watch_.disconnect();
   if (fd_ >= 0) {
     close(fd_);
   }
 }
 
-bool waybar::util::Rfkill::on_event(Glib::IOCondition cond) {
-  if (cond & Glib::IO_IN) {
-    struct rfkill_event event;
-    ssize_t len;
+bool RfkillMonitor::blocked(enum rfkill_type type) const {
+  return type < NUM_RFKILL_TYPES && blocked_[type];
+}
+
+size_t RfkillMonitor::devices(enum rfkill_type type) const {
+  return type < NUM_RFKILL_TYPES ? count_[type].load() : 0;
+}
 
-    len = read(fd_, &event, sizeof(event));
-    if (len < 0) {
-      if (errno == EAGAIN) {
-        return true;
+sigc::signal<void(const struct rfkill_event&)>& RfkillMonitor::signal_changed(
+    enum rfkill_type type) {
+  return signals_.at(type);
+}
+
+bool RfkillMonitor::on_event(Glib::IOCondition cond) {
+  if (cond & Glib::IO_IN) {
+    // drain everything queued since the last wakeup, one event per read
+    while (true) {
+      struct rfkill_event event;
+      std::memset(&event, 0, sizeof(event));
+      ssize_t len = read(fd_, &event, sizeof(event));
+      if (len < 0) {
+        if (errno == EAGAIN) {
+          return true;
+        }
+        spdlog::error("Reading of RFKILL events failed: {}", errno);
+        return false;
+      }
+      if (len == 0) {
+        break;
       }
-      spdlog::error("Reading of RFKILL events failed: {}", errno);
-      return false;
+      if (static_cast<size_t>(len) < RFKILL_EVENT_SIZE_V1) {
+        spdlog::error("Wrong size of RFKILL event: {} < {}", len, RFKILL_EVENT_SIZE_V1);
+        continue;
+      }
+      handleEvent(event);
     }
+  }
+  if (cond & (Glib::IO_ERR | Glib::IO_HUP)) {
+    spdlog::error("Failed to poll RFKILL control device");
+    return false;
+  }
+  return true;
+}
 
-    if (static_cast<size_t>(len) < RFKILL_EVENT_SIZE_V1) {
-      spdlog::error("Wrong size of RFKILL event: {} < {}", len, RFKILL_EVENT_SIZE_V1);
-      return true;
+void RfkillMonitor::handleEvent(const struct rfkill_event& event) {
+  if (event.type >= NUM_RFKILL_TYPES) {
+    return;
+  }
+  switch (event.op) {
+    case RFKILL_OP_ADD:
+      devices_[event.idx] = event;
+      break;
+    case RFKILL_OP_DEL:
+      if (devices_.erase(event.idx) == 0) {
+        return;
+      }
+      break;
+    case RFKILL_OP_CHANGE: {
+      auto it = devices_.find(event.idx);
+      if (it != devices_.end() && it->second.soft == event.soft &&
+          it->second.hard == event.hard) {
+        return;
+      }
+      devices_[event.idx] = event;
+      break;
     }
+    default:
+      return;
+  }
+  updateSummary(event.type);
+  signals_[event.type].emit(event);
+}
 
-    if (event.type == rfkill_type_ && (event.op == RFKILL_OP_ADD || event.op == RFKILL_OP_CHANGE)) {
-      state_ = event.soft || event.hard;
-      on_update.emit(event);
+void RfkillMonitor::updateSummary(uint8_t type) {
+  size_t count = 0;
+  size_t blocked = 0;
+  for (const auto& [idx, device] : devices_) {
+    if (device.type == type) {
+      ++count;
+      blocked += device.soft || device.hard ? 1 : 0;
     }
-    return true;
   }
-  spdlog::error("Failed to poll RFKILL control device");
-  return false;
+  count_[type] = count;
+  blocked_[type] = count > 0 && blocked == count;
 }
 
-bool waybar::util::Rfkill::getState() const { return state_; }
+Rfkill::Rfkill(const enum rfkill_type rfkill_type)
+    : Rfkill(rfkill_type, RfkillMonitor::getInstance()) {}
+
+Rfkill::Rfkill(const enum rfkill_type rfkill_type, std::shared_ptr<RfkillMonitor> monitor)
+    : rfkill_type_(rfkill_type), monitor_(std::move(monitor)) {
+  connection_ = monitor_->signal_changed(rfkill_type_).connect(
+      [this](const struct rfkill_event& event) {
+        auto copy = event;
+        on_update.emit(copy);
+      });
+}
+
+Rfkill::~Rfkill() { connection_.disconnect(); }
+
+bool Rfkill::getState() const { return monitor_->blocked(rfkill_type_); }
+
+}  // namespace waybar::util
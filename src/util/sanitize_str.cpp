@@ -1,24 +1,35 @@
-#include <array>
 #include <string>
 #include <util/sanitize_str.hpp>
-#include <utility>
 
 namespace waybar::util {
-// replaces ``<>&"'`` with their encoded counterparts
+// replaces ``<>&"'`` with their encoded counterparts, everything else is kept as is
 std::string sanitize_string(std::string str) {
-  // note: it's important that '&' is replaced first; therefore we *can't* use std::map
-  const std::pair<char, std::string> replacement_table[] = {
-      {'&', "&amp;"}, {'<', "&lt;"}, {'>', "&gt;"}, {'"', "&quot;"}, {'\'', "&apos;"}};
-  size_t startpoint;
-  for (size_t i = 0; i < (sizeof(replacement_table) / sizeof(replacement_table[0])); ++i) {
-    startpoint = 0;
-    std::pair pair = replacement_table[i];
-    while ((startpoint = str.find(pair.first, startpoint)) != std::string::npos) {
-      str.replace(startpoint, 1, pair.second);
-      startpoint += pair.second.length();
+  if (str.find_first_of("&<>\"'") == std::string::npos) {
+    return str;
+  }
+  std::string res;
+  res.reserve(str.size() + str.size() / 8);
+  for (const char c : str) {
+    switch (c) {
+      case '&':
+        res += "&amp;";
+        break;
+      case '<':
+        res += "&lt;";
+        break;
+      case '>':
+        res += "&gt;";
+        break;
+      case '"':
+        res += "&quot;";
+        break;
+      case '\'':
+        res += "&apos;";
+        break;
+      default:
+        res += c;
     }
   }
-
-  return str;
+  return res;
 }
 }  // namespace waybar::util
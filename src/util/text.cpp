@@ -0,0 +1,283 @@
+#include "util/text.hpp"
+
+#include <glib.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr uint64_t ONES = 0x0101010101010101ULL;
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+constexpr size_t BLOCK = sizeof(uint64_t);
+
+uint64_t load_block(const char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, BLOCK);
+  return v;
+}
+
+// SWAR predicates, only exact for blocks without bytes >= 0x80
+uint64_t has_byte(uint64_t v, uint8_t c) {
+  const uint64_t x = v ^ (ONES * c);
+  return (x - ONES) & ~x & HIGH_BITS;
+}
+
+uint64_t has_less(uint64_t v, uint8_t n) { return (v - ONES * n) & ~v & HIGH_BITS; }
+
+// A block of ASCII that can be copied as is and is one column per byte
+bool is_plain_block(uint64_t v, bool escape) {
+  if ((v & HIGH_BITS) != 0) {
+    return false;
+  }
+  if (!escape) {
+    return true;
+  }
+  return (has_less(v, 0x20) | has_byte(v, 0x7f) | has_byte(v, '&') | has_byte(v, '<') |
+          has_byte(v, '>') | has_byte(v, '"') | has_byte(v, '\'')) == 0;
+}
+
+bool is_ascii_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+bool is_space(uint32_t c) { return c < 0x80 ? is_ascii_space(c) : g_unichar_isspace(c); }
+
+size_t char_width(uint32_t c) {
+  if (c < 0x80) {
+    return 1;
+  }
+  if (g_unichar_iswide(c)) {
+    return 2;
+  }
+  // neither zero-width nor soft hyphen
+  if (g_unichar_iszerowidth(c) || c == 0xAD) {
+    return 0;
+  }
+  return 1;
+}
+
+// Strict UTF-8 decoding: rejects overlong forms, surrogates and truncated sequences
+bool decode_utf8(const char* p, const char* end, uint32_t& c, size_t& len) {
+  const auto b0 = static_cast<unsigned char>(*p);
+  if (b0 < 0x80) {
+    c = b0;
+    len = 1;
+    return true;
+  }
+  if (b0 < 0xC2) {
+    return false;
+  }
+  if (b0 < 0xE0) {
+    c = b0 & 0x1F;
+    len = 2;
+  } else if (b0 < 0xF0) {
+    c = b0 & 0x0F;
+    len = 3;
+  } else if (b0 < 0xF5) {
+    c = b0 & 0x07;
+    len = 4;
+  } else {
+    return false;
+  }
+  if (static_cast<size_t>(end - p) < len) {
+    return false;
+  }
+  for (size_t i = 1; i < len; ++i) {
+    const auto b = static_cast<unsigned char>(p[i]);
+    if ((b & 0xC0) != 0x80) {
+      return false;
+    }
+    c = (c << 6) | (b & 0x3F);
+  }
+  if (len == 3 && (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF))) {
+    return false;
+  }
+  if (len == 4 && (c < 0x10000 || c > 0x10FFFF)) {
+    return false;
+  }
+  return true;
+}
+
+void append_char_ref(std::string& out, uint32_t c) {
+  static constexpr char HEX[] = "0123456789abcdef";
+  out += "&#x";
+  if (c >= 0x10) {
+    out += HEX[(c >> 4) & 0xF];
+  }
+  out += HEX[c & 0xF];
+  out += ';';
+}
+
+// Same replacements as g_markup_escape_text
+void append_escaped(std::string& out, uint32_t c, const char* p, size_t len) {
+  switch (c) {
+    case '&':
+      out += "&amp;";
+      return;
+    case '<':
+      out += "&lt;";
+      return;
+    case '>':
+      out += "&gt;";
+      return;
+    case '"':
+      out += "&quot;";
+      return;
+    case '\'':
+      out += "&#39;";
+      return;
+    default:
+      break;
+  }
+  if ((c >= 0x1 && c <= 0x8) || c == 0xb || c == 0xc || (c >= 0xe && c <= 0x1f) || c == 0x7f ||
+      (c >= 0x80 && c <= 0x84) || (c >= 0x86 && c <= 0x9f)) {
+    append_char_ref(out, c);
+    return;
+  }
+  out.append(p, len);
+}
+
+// Fallback for invalid UTF-8: one column per byte, cut without an ellipsis.
+// Markup must be valid UTF-8, so escaping replaces non-ASCII bytes with U+FFFD.
+Text process_bytes(std::string_view str, const TextOptions& options) {
+  Text res;
+  const auto cut = str.substr(0, options.max_width);
+  res.truncated = cut.size() < str.size();
+  res.width = cut.size();
+  if (!options.escape) {
+    res.str = cut;
+    return res;
+  }
+  res.str.reserve(cut.size());
+  for (const char ch : cut) {
+    const auto c = static_cast<unsigned char>(ch);
+    if (c < 0x80) {
+      append_escaped(res.str, c, &ch, 1);
+    } else {
+      res.str += "\uFFFD";
+    }
+  }
+  return res;
+}
+
+}  // namespace
+
+Text process_text(std::string_view str, const TextOptions& options) {
+  Text res;
+  if (options.max_width == 0) {
+    res.truncated = !str.empty();
+    return res;
+  }
+
+  const bool limited = options.max_width != std::string::npos;
+  const size_t ellipsis_width = limited ? text_width(options.ellipsis) : 0;
+  // widest prefix that still leaves room for the ellipsis
+  const size_t target = limited && options.max_width >= ellipsis_width
+                            ? options.max_width - ellipsis_width
+                            : 0;
+
+  auto& out = res.str;
+  out.reserve(str.size());
+  size_t width = 0;
+  // output position and width after the last non-space character within target
+  size_t cut_len = 0;
+  size_t cut_width = 0;
+
+  const char* p = str.data();
+  const char* end = p + str.size();
+  while (p < end) {
+    if (static_cast<size_t>(end - p) >= BLOCK && (!limited || width + BLOCK <= target)) {
+      const uint64_t block = load_block(p);
+      if (is_plain_block(block, options.escape)) {
+        out.append(p, BLOCK);
+        width += BLOCK;
+        if (limited) {
+          for (size_t i = BLOCK; i-- > 0;) {
+            if (!is_ascii_space(p[i])) {
+              cut_len = out.size() - (BLOCK - 1 - i);
+              cut_width = width - (BLOCK - 1 - i);
+              break;
+            }
+          }
+        }
+        p += BLOCK;
+        continue;
+      }
+    }
+
+    uint32_t c;
+    size_t len;
+    if (!decode_utf8(p, end, c, len)) {
+      return process_bytes(str, options);
+    }
+    const size_t w = char_width(c);
+    if (limited && width + w > options.max_width) {
+      res.truncated = true;
+      break;
+    }
+    if (options.escape) {
+      append_escaped(out, c, p, len);
+    } else {
+      out.append(p, len);
+    }
+    width += w;
+    p += len;
+    if (limited && width <= target && !is_space(c)) {
+      cut_len = out.size();
+      cut_width = width;
+    }
+  }
+
+  if (res.truncated) {
+    if (options.max_width < ellipsis_width) {
+      out.clear();
+      res.width = 0;
+      return res;
+    }
+    out.resize(cut_len);
+    width = cut_width + ellipsis_width;
+    if (options.escape) {
+      out += escape_markup(options.ellipsis);
+    } else {
+      out += options.ellipsis;
+    }
+  }
+
+  res.width = width;
+  return res;
+}
+
+std::string escape_markup(std::string_view str) {
+  return process_text(str, TextOptions{.escape = true}).str;
+}
+
+size_t text_width(std::string_view str) {
+  size_t width = 0;
+  const char* p = str.data();
+  const char* end = p + str.size();
+  while (p < end) {
+    if (static_cast<size_t>(end - p) >= BLOCK && (load_block(p) & HIGH_BITS) == 0) {
+      width += BLOCK;
+      p += BLOCK;
+      continue;
+    }
+    uint32_t c;
+    size_t len;
+    if (!decode_utf8(p, end, c, len)) {
+      // invalid unicode, treat string as ascii
+      return str.size();
+    }
+    width += char_width(c);
+    p += len;
+  }
+  return width;
+}
+
+size_t truncate_text(std::string& str, size_t max_width, std::string_view ellipsis) {
+  auto res = process_text(str, TextOptions{.max_width = max_width, .ellipsis = ellipsis});
+  str = std::move(res.str);
+  return res.width;
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,126 @@
+#include "util/thread.hpp"
+
+#include <fmt/format.h>
+#include <limits.h>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace waybar::util {
+
+namespace {
+
+std::mutex census_mutex;
+std::map<std::string, size_t>& liveThreads() {
+  static auto* threads = new std::map<std::string, size_t>();
+  return *threads;
+}
+
+thread_local std::string owner_name = "waybar";
+
+struct Start {
+  std::string name;
+  std::function<void()> func;
+
+  // runs on thread exit and on pthread_cancel's unwinding alike
+  ~Start() {
+    std::lock_guard lock(census_mutex);
+    auto it = liveThreads().find(name);
+    if (it != liveThreads().end() && --it->second == 0) {
+      liveThreads().erase(it);
+    }
+  }
+};
+
+void* run(void* data) {
+  std::unique_ptr<Start> start(static_cast<Start*>(data));
+  pthread_setname_np(pthread_self(), start->name.substr(0, 15).c_str());
+  // threads started from here are named after the same owner
+  owner_name = start->name;
+  start->func();
+  return nullptr;
+}
+
+}  // namespace
+
+Thread::Thread(std::string name, std::function<void()> func, size_t stack_size) {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  if (stack_size != DEFAULT_STACK_SIZE) {
+    pthread_attr_setstacksize(&attr, std::max<size_t>(stack_size, PTHREAD_STACK_MIN));
+  }
+
+  {
+    std::lock_guard lock(census_mutex);
+    ++liveThreads()[name];
+  }
+  auto* start = new Start{std::move(name), std::move(func)};
+  int rc = pthread_create(&handle_, &attr, &run, start);
+  pthread_attr_destroy(&attr);
+  if (rc != 0) {
+    handle_ = 0;
+    delete start;
+    throw std::system_error(rc, std::generic_category(), "pthread_create failed");
+  }
+}
+
+Thread::Thread(Thread&& other) noexcept : handle_(other.handle_) { other.handle_ = 0; }
+
+Thread& Thread::operator=(Thread&& other) noexcept {
+  if (joinable()) {
+    std::terminate();
+  }
+  handle_ = other.handle_;
+  other.handle_ = 0;
+  return *this;
+}
+
+Thread::~Thread() {
+  if (joinable()) {
+    std::terminate();
+  }
+}
+
+void Thread::join() {
+  pthread_join(handle_, nullptr);
+  handle_ = 0;
+}
+
+void Thread::detach() {
+  pthread_detach(handle_);
+  handle_ = 0;
+}
+
+const std::string& Thread::owner() { return owner_name; }
+
+Thread::Owner::Owner(std::string name) : previous_(std::move(owner_name)) {
+  owner_name = std::move(name);
+}
+
+Thread::Owner::~Owner() { owner_name = std::move(previous_); }
+
+std::map<std::string, size_t> Thread::census() {
+  std::lock_guard lock(census_mutex);
+  return liveThreads();
+}
+
+std::string Thread::report() {
+  auto threads = census();
+  std::vector<std::pair<std::string, size_t>> sorted(threads.begin(), threads.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto& a, const auto& b) { return a.second > b.second; });
+  size_t total = 0;
+  std::string out;
+  for (const auto& [name, count] : sorted) {
+    total += count;
+    out += fmt::format(", {} {}", name, count);
+  }
+  return fmt::format("{} threads{}", total, out);
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,167 @@
+#include "modules/cffi_plugin.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <dlfcn.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace ffi = waybar::modules::ffi;
+
+namespace {
+
+// Layout of the struct returned by stub_stats() in stub.cpp
+struct StubStats {
+  int inits;
+  int deinits;
+  int shared_inits;
+  int shared_deinits;
+  int updates;
+  size_t config_entries;
+  std::string greeting;
+  void* last_shared;
+};
+
+std::string stubPath(const char* var) {
+  const char* path = std::getenv(var);
+  REQUIRE(path != nullptr);
+  return path;
+}
+
+StubStats* stubStats(const std::string& path) {
+  // the plugin keeps the library open, this only takes another reference
+  void* handle = dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+  REQUIRE(handle != nullptr);
+  auto* fn = reinterpret_cast<StubStats* (*)()>(dlsym(handle, "stub_stats"));
+  dlclose(handle);
+  REQUIRE(fn != nullptr);
+  return fn();
+}
+
+Json::Value stubConfig() {
+  Json::Value config;
+  config["module_path"] = "stub.so";
+  config["greeting"] = "hello";
+  config["interval"] = 5;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("Convert config to a node tree", "[cffi]") {
+  Json::Value config;
+  config["flag"] = true;
+  config["negative"] = -3;
+  config["count"] = 42U;
+  config["ratio"] = 0.5;
+  config["name"] = "waybar";
+  config["list"].append(1);
+  config["list"].append("two");
+  config["nested"]["inner"] = Json::nullValue;
+
+  ffi::ConfigTree tree(config);
+  const auto* root = tree.root();
+  REQUIRE(root->type == ffi::WBCFFI_CONFIG_OBJECT);
+  REQUIRE(root->as.children.len == config.size());
+
+  auto find = [](const ffi::wbcffi_config_node* node, const char* key) {
+    for (size_t i = 0; i < node->as.children.len; i++) {
+      if (std::strcmp(node->as.children.items[i].key, key) == 0) {
+        return &node->as.children.items[i];
+      }
+    }
+    return static_cast<const ffi::wbcffi_config_node*>(nullptr);
+  };
+
+  REQUIRE(find(root, "flag")->type == ffi::WBCFFI_CONFIG_BOOL);
+  REQUIRE(find(root, "flag")->as.boolean);
+  REQUIRE(find(root, "negative")->type == ffi::WBCFFI_CONFIG_INT);
+  REQUIRE(find(root, "negative")->as.integer == -3);
+  REQUIRE(find(root, "count")->type == ffi::WBCFFI_CONFIG_UINT);
+  REQUIRE(find(root, "count")->as.uinteger == 42);
+  REQUIRE(find(root, "ratio")->type == ffi::WBCFFI_CONFIG_DOUBLE);
+  REQUIRE(find(root, "ratio")->as.real == 0.5);
+  REQUIRE(find(root, "name")->type == ffi::WBCFFI_CONFIG_STRING);
+  REQUIRE(std::string(find(root, "name")->as.string) == "waybar");
+
+  const auto* list = find(root, "list");
+  REQUIRE(list->type == ffi::WBCFFI_CONFIG_ARRAY);
+  REQUIRE(list->as.children.len == 2);
+  REQUIRE(list->as.children.items[0].key == nullptr);
+  REQUIRE(list->as.children.items[0].as.integer == 1);
+  REQUIRE(std::string(list->as.children.items[1].as.string) == "two");
+
+  const auto* nested = find(root, "nested");
+  REQUIRE(nested->type == ffi::WBCFFI_CONFIG_OBJECT);
+  REQUIRE(find(nested, "inner")->type == ffi::WBCFFI_CONFIG_NULL);
+}
+
+TEST_CASE("Load an ABI version 1 module", "[cffi]") {
+  const auto path = stubPath("WBCFFI_STUB_V1");
+  auto plugin = ffi::Plugin::load(path);
+  REQUIRE(plugin->version() == 1);
+  REQUIRE_FALSE(plugin->hasShared());
+  REQUIRE(ffi::Plugin::load(path) == plugin);
+
+  auto* stats = stubStats(path);
+  const auto config = stubConfig();
+  ffi::ConfigTree tree(config);
+  ffi::wbcffi_init_info info{};
+  info.config = tree.root();
+
+  void* instance = plugin->init(info, config);
+  REQUIRE(instance != nullptr);
+  REQUIRE(stats->inits == 1);
+  REQUIRE(stats->config_entries == config.size());
+  REQUIRE(stats->greeting == "hello");
+
+  plugin->update(instance);
+  plugin->refresh(instance, 10);  // not exported by the stub
+  plugin->doAction(instance, "action");
+  REQUIRE(stats->updates == 1);
+
+  plugin->deinit(instance);
+  REQUIRE(stats->deinits == 1);
+}
+
+TEST_CASE("Load an ABI version 2 module", "[cffi]") {
+  const auto path = stubPath("WBCFFI_STUB_V2");
+  auto plugin = ffi::Plugin::load(path);
+  REQUIRE(plugin->version() == 2);
+  REQUIRE(plugin->hasShared());
+
+  auto* stats = stubStats(path);
+  const auto config = stubConfig();
+  ffi::ConfigTree tree(config);
+  ffi::wbcffi_init_info info{};
+  info.config = tree.root();
+
+  void* shared = plugin->sharedInit(info);
+  REQUIRE(shared != nullptr);
+  REQUIRE(stats->shared_inits == 1);
+
+  // one view per bar, all bound to the same backend
+  info.shared = shared;
+  void* first = plugin->init(info, config);
+  void* second = plugin->init(info, config);
+  REQUIRE(stats->inits == 2);
+  REQUIRE(stats->greeting == "hello");
+  REQUIRE(stats->last_shared == shared);
+  REQUIRE(stats->shared_inits == 1);
+
+  plugin->deinit(first);
+  plugin->deinit(second);
+  plugin->sharedDeinit(shared);
+  REQUIRE(stats->deinits == 2);
+  REQUIRE(stats->shared_deinits == 1);
+}
+
+TEST_CASE("Reject unknown ABI versions", "[cffi]") {
+  REQUIRE_THROWS_AS(ffi::Plugin::load(stubPath("WBCFFI_STUB_V3")), std::runtime_error);
+  REQUIRE_THROWS_AS(ffi::Plugin::load("/nonexistent/wbcffi.so"), std::runtime_error);
+}
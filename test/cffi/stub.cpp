@@ -0,0 +1,72 @@
+// Minimal CFFI module used by the plugin tests, built once per ABI version
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "modules/cffi_plugin.hpp"
+
+using namespace waybar::modules::ffi;
+
+struct StubStats {
+  int inits;
+  int deinits;
+  int shared_inits;
+  int shared_deinits;
+  int updates;
+  size_t config_entries;
+  std::string greeting;
+  void* last_shared;
+};
+
+static StubStats stats{};
+
+extern "C" {
+
+extern const size_t wbcffi_version;
+const size_t wbcffi_version = STUB_VERSION;
+
+StubStats* stub_stats() { return &stats; }
+
+void* wbcffi_init(const wbcffi_init_info* init_info, const wbcffi_config_entry* config_entries,
+                  size_t config_entries_len) {
+  stats.inits++;
+  stats.config_entries = config_entries_len;
+  stats.greeting.clear();
+#if STUB_VERSION >= 2
+  const auto* config = init_info->config;
+  for (size_t i = 0; i < config->as.children.len; i++) {
+    const auto& node = config->as.children.items[i];
+    if (std::strcmp(node.key, "greeting") == 0 && node.type == WBCFFI_CONFIG_STRING) {
+      stats.greeting = node.as.string;
+    }
+  }
+  stats.last_shared = init_info->shared;
+#else
+  for (size_t i = 0; i < config_entries_len; i++) {
+    if (std::strcmp(config_entries[i].key, "greeting") == 0) {
+      stats.greeting = config_entries[i].value;
+    }
+  }
+#endif
+  return std::malloc(1);
+}
+
+void wbcffi_deinit(void* instance) {
+  stats.deinits++;
+  std::free(instance);
+}
+
+void wbcffi_update(void* instance) { stats.updates++; }
+
+#if STUB_VERSION >= 2
+void* wbcffi_shared_init(const wbcffi_init_info* init_info) {
+  stats.shared_inits++;
+  return std::malloc(1);
+}
+
+void wbcffi_shared_deinit(void* shared) {
+  stats.shared_deinits++;
+  std::free(shared);
+}
+#endif
+}
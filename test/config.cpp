@@ -5,6 +5,68 @@
 #else
 #include <catch2/catch.hpp>
 #endif
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#endif
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Points the config cache at a scratch directory, fixtures copied there can be edited freely
+class ConfigCacheFixture {
+ public:
+  ConfigCacheFixture()
+      : dir_(fs::temp_directory_path() / ("waybar-config-cache-" + std::to_string(getpid()))) {
+    fs::remove_all(dir_);
+    fs::create_directories(dir_ / "cache");
+    if (const char* cache = std::getenv("XDG_CACHE_HOME")) {
+      saved_cache_home_ = cache;
+    }
+    setenv("XDG_CACHE_HOME", (dir_ / "cache").c_str(), 1);
+  }
+
+  ~ConfigCacheFixture() {
+    if (saved_cache_home_) {
+      setenv("XDG_CACHE_HOME", saved_cache_home_->c_str(), 1);
+    } else {
+      unsetenv("XDG_CACHE_HOME");
+    }
+    fs::remove_all(dir_);
+  }
+
+  // Copies a fixture with its includes redirected to the copies
+  std::string copy(const std::string& name) {
+    std::ifstream in("test/config/" + name);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    for (auto pos = text.find("test/config/"); pos != std::string::npos;
+         pos = text.find("test/config/", pos)) {
+      text.replace(pos, 12, dir_.string() + "/");
+    }
+    return write(name, text);
+  }
+
+  std::string write(const std::string& name, const std::string& text) {
+    auto path = (dir_ / name).string();
+    std::ofstream(path, std::ios::trunc) << text;
+    return path;
+  }
+
+ private:
+  fs::path dir_;
+  std::optional<std::string> saved_cache_home_;
+};
+
+}  // namespace
 
 TEST_CASE("Load simple config", "[config]") {
   waybar::Config conf;
@@ -32,31 +94,31 @@ TEST_CASE("Load config with multiple bars", "[config]") {
   SECTION("select multiple configs #1") {
     auto data = conf.getOutputConfigs("DP-0", "Fake DisplayPort output #0");
     REQUIRE(data.size() == 4);
-    REQUIRE(data[0]["layer"].asString() == "bottom");
-    REQUIRE(data[0]["height"].asInt() == 20);
-    REQUIRE(data[1]["layer"].asString() == "top");
-    REQUIRE(data[1]["position"].asString() == "bottom");
-    REQUIRE(data[1]["height"].asInt() == 21);
-    REQUIRE(data[2]["layer"].asString() == "overlay");
-    REQUIRE(data[2]["position"].asString() == "right");
-    REQUIRE(data[2]["height"].asInt() == 23);
-    REQUIRE(data[3]["height"].asInt() == 24);
+    REQUIRE(data[0].get()["layer"].asString() == "bottom");
+    REQUIRE(data[0].get()["height"].asInt() == 20);
+    REQUIRE(data[1].get()["layer"].asString() == "top");
+    REQUIRE(data[1].get()["position"].asString() == "bottom");
+    REQUIRE(data[1].get()["height"].asInt() == 21);
+    REQUIRE(data[2].get()["layer"].asString() == "overlay");
+    REQUIRE(data[2].get()["position"].asString() == "right");
+    REQUIRE(data[2].get()["height"].asInt() == 23);
+    REQUIRE(data[3].get()["height"].asInt() == 24);
   }
   SECTION("select multiple configs #2") {
     auto data = conf.getOutputConfigs("HDMI-0", "Fake HDMI output #0");
     REQUIRE(data.size() == 2);
-    REQUIRE(data[0]["layer"].asString() == "bottom");
-    REQUIRE(data[0]["height"].asInt() == 20);
-    REQUIRE(data[1]["layer"].asString() == "overlay");
-    REQUIRE(data[1]["position"].asString() == "right");
-    REQUIRE(data[1]["height"].asInt() == 23);
+    REQUIRE(data[0].get()["layer"].asString() == "bottom");
+    REQUIRE(data[0].get()["height"].asInt() == 20);
+    REQUIRE(data[1].get()["layer"].asString() == "overlay");
+    REQUIRE(data[1].get()["position"].asString() == "right");
+    REQUIRE(data[1].get()["height"].asInt() == 23);
   }
   SECTION("select single config by output description") {
     auto data = conf.getOutputConfigs("HDMI-1", "Fake HDMI output #1");
     REQUIRE(data.size() == 1);
-    REQUIRE(data[0]["layer"].asString() == "overlay");
-    REQUIRE(data[0]["position"].asString() == "left");
-    REQUIRE(data[0]["height"].asInt() == 22);
+    REQUIRE(data[0].get()["layer"].asString() == "overlay");
+    REQUIRE(data[0].get()["position"].asString() == "left");
+    REQUIRE(data[0].get()["height"].asInt() == 22);
   }
 }
 
@@ -91,25 +153,25 @@ TEST_CASE("Load multiple bar config with include", "[config]") {
   SECTION("bar config with sole include") {
     auto data = conf.getOutputConfigs("OUT-0", "Fake output #0");
     REQUIRE(data.size() == 1);
-    REQUIRE(data[0]["height"].asInt() == 20);
+    REQUIRE(data[0].get()["height"].asInt() == 20);
   }
 
   SECTION("bar config with output and include") {
     auto data = conf.getOutputConfigs("OUT-1", "Fake output #1");
     REQUIRE(data.size() == 1);
-    REQUIRE(data[0]["height"].asInt() == 21);
+    REQUIRE(data[0].get()["height"].asInt() == 21);
   }
 
   SECTION("bar config with output override") {
     auto data = conf.getOutputConfigs("OUT-2", "Fake output #2");
     REQUIRE(data.size() == 1);
-    REQUIRE(data[0]["height"].asInt() == 22);
+    REQUIRE(data[0].get()["height"].asInt() == 22);
   }
 
   SECTION("multiple levels of include") {
     auto data = conf.getOutputConfigs("OUT-3", "Fake output #3");
     REQUIRE(data.size() == 1);
-    REQUIRE(data[0]["height"].asInt() == 23);
+    REQUIRE(data[0].get()["height"].asInt() == 23);
   }
 
   auto& data = conf.getConfig();
@@ -156,3 +218,185 @@ TEST_CASE("Load Hyprland Workspaces bar config", "[config]") {
   REQUIRE(hyprland_window_rewrite["title<Steam>"].asString() == "");
   REQUIRE(hyprland["sort-by"].asString() == "number");
 }
+
+TEST_CASE("Output configs are views into the loaded config", "[config]") {
+  waybar::Config conf;
+  conf.load("test/config/multi.json");
+
+  auto& data = conf.getConfig();
+  auto configs = conf.getOutputConfigs("DP-0", "Fake DisplayPort output #0");
+  REQUIRE(configs.size() == 4);
+  REQUIRE(&configs[0].get() == &data[0]);
+  REQUIRE(&configs[1].get() == &data[1]);
+  REQUIRE(&configs[2].get() == &data[3]);
+  REQUIRE(&configs[3].get() == &data[4]);
+}
+
+TEST_CASE("Convert format-alt-click on load", "[config]") {
+  waybar::Config conf;
+  conf.load("test/config/format-alt.json");
+
+  auto& data = conf.getConfig();
+  SECTION("module listed twice keeps the configured button") {
+    REQUIRE(data[0]["clock"]["format-alt-click"].asUInt() == 3);
+  }
+  SECTION("left click is the default") {
+    REQUIRE(data[0]["battery"]["format-alt-click"].asUInt() == 1);
+  }
+  SECTION("modules in groups are converted") {
+    REQUIRE(data[0]["cpu"]["format-alt-click"].asUInt() == 2);
+    REQUIRE_FALSE(data[0]["memory"].isMember("format-alt-click"));
+  }
+  SECTION("every bar is converted separately") {
+    REQUIRE(data[1]["clock"]["format-alt-click"].asUInt() == 9);
+  }
+}
+
+TEST_CASE_METHOD(ConfigCacheFixture, "Unchanged config is loaded from the cache",
+                 "[config][cache]") {
+  waybar::Config conf;
+  conf.load("test/config/include.json");
+  REQUIRE_FALSE(conf.loadedFromCache());
+  const auto expected = conf.getConfig();
+  REQUIRE(fs::exists(waybar::Config::cachePath("test/config/include.json")));
+
+  SECTION("reloading the same instance") {
+    conf.load("test/config/include.json");
+    CHECK(conf.loadedFromCache());
+    CHECK(conf.getConfig() == expected);
+  }
+  SECTION("a new instance reads the cache file") {
+    waybar::Config other;
+    other.load("test/config/include.json");
+    CHECK(other.loadedFromCache());
+    CHECK(other.getConfig() == expected);
+    CHECK(other.getConfig()["height"].isInt());
+    CHECK(other.getConfig()["nullOption"].isNull());
+    CHECK(other.getOutputConfigs("HDMI-0", "").size() == 1);
+  }
+  SECTION("another main file has its own cache") {
+    waybar::Config other;
+    other.load("test/config/include-1.json");
+    CHECK_FALSE(other.loadedFromCache());
+    CHECK(other.getConfig()["position"] == "bottom");
+  }
+}
+
+TEST_CASE_METHOD(ConfigCacheFixture, "Editing an included file invalidates the cache",
+                 "[config][cache]") {
+  copy("include-1.json");
+  auto include = copy("include-2.json");
+  auto main = copy("include.json");
+
+  waybar::Config conf;
+  conf.load(main);
+  REQUIRE(conf.getConfig()["layer"] == "top");
+  REQUIRE_FALSE(conf.getConfig().isMember("margin"));
+
+  write("include-2.json", R"({"layer": "bottom", "margin": 5})");
+  conf.load(main);
+  CHECK_FALSE(conf.loadedFromCache());
+  CHECK(conf.getConfig()["margin"] == 5);
+
+  // the cache file was refreshed by the reload above
+  waybar::Config other;
+  other.load(main);
+  CHECK(other.loadedFromCache());
+  CHECK(other.getConfig()["margin"] == 5);
+
+  SECTION("a removed include fails the load") {
+    fs::remove(include);
+    waybar::Config fresh;
+    CHECK_THROWS(fresh.load(main));
+  }
+}
+
+TEST_CASE_METHOD(ConfigCacheFixture, "Includes are expanded again before using the cache",
+                 "[config][cache]") {
+  auto first = copy("include-1.json");
+  auto second = copy("include-2.json");
+  auto main = write("main.json", R"({"include": "$WAYBAR_TEST_INCLUDE", "position": "top"})");
+
+  setenv("WAYBAR_TEST_INCLUDE", first.c_str(), 1);
+  waybar::Config conf;
+  conf.load(main);
+  REQUIRE(conf.getConfig()["height"] == 30);
+
+  setenv("WAYBAR_TEST_INCLUDE", second.c_str(), 1);
+  conf.load(main);
+  CHECK_FALSE(conf.loadedFromCache());
+  CHECK(conf.getConfig()["layer"] == "bottom");
+  CHECK_FALSE(conf.getConfig().isMember("height"));
+  unsetenv("WAYBAR_TEST_INCLUDE");
+}
+
+TEST_CASE_METHOD(ConfigCacheFixture, "Damaged cache files are ignored", "[config][cache]") {
+  const auto path = waybar::Config::cachePath("test/config/include.json");
+  fs::create_directories(fs::path(path).parent_path());
+
+  waybar::Config reference;
+  reference.load("test/config/include.json");
+  std::ifstream in(path, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  REQUIRE(data.size() > 8);
+
+  SECTION("truncated") { data.resize(data.size() - 3); }
+  SECTION("garbage") { data = "not a cache"; }
+  SECTION("trailing bytes") { data += "xx"; }
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+
+  waybar::Config conf;
+  conf.load("test/config/include.json");
+  CHECK_FALSE(conf.loadedFromCache());
+  CHECK(conf.getConfig() == reference.getConfig());
+}
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+// 4 bars with 400 module definitions each. Run with `waybar_test "[benchmark]"`.
+TEST_CASE_METHOD(ConfigCacheFixture, "Large config benchmark", "[.][benchmark][config]") {
+  auto path = std::filesystem::temp_directory_path() / "waybar-large-config.json";
+  {
+    std::ofstream out(path);
+    out << "[";
+    for (int bar = 0; bar < 4; ++bar) {
+      out << (bar ? "," : "") << R"({"output": "OUT-)" << bar << R"(", "modules-left": [)";
+      for (int i = 0; i < 400; ++i) {
+        out << (i ? "," : "") << "\"custom/m" << i << "\"";
+      }
+      out << "]";
+      for (int i = 0; i < 400; ++i) {
+        out << R"(, "custom/m)" << i
+            << R"(": {"format": "{icon} {}", "format-alt": "{}", "format-icons": [)";
+        for (int icon = 0; icon < 10; ++icon) {
+          out << (icon ? "," : "") << R"("icon-)" << icon << "\"";
+        }
+        out << "]}";
+      }
+      out << "}";
+    }
+    out << "]";
+  }
+
+  waybar::Config conf;
+  conf.load(path);
+  REQUIRE(conf.getOutputConfigs("OUT-0", "").size() == 1);
+
+  BENCHMARK("load") {
+    waybar::Config conf;
+    conf.load(path);
+    return conf.getConfig().size();
+  };
+  BENCHMARK("getOutputConfigs") {
+    size_t modules = 0;
+    for (int bar = 0; bar < 4; ++bar) {
+      for (const auto& config : conf.getOutputConfigs("OUT-" + std::to_string(bar), "")) {
+        modules += config.get()["modules-left"].size();
+      }
+    }
+    return modules;
+  };
+
+  std::filesystem::remove(path);
+}
+#endif
@@ -1,4 +1,13 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
 #include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 #if __has_include(<catch2/catch_test_macros.hpp>)
 #include <catch2/catch_test_macros.hpp>
 #else
@@ -11,6 +20,32 @@
 namespace fs = std::filesystem;
 namespace hyprland = waybar::modules::hyprland;
 
+namespace {
+
+// Sets an environment variable until the end of the scope, then restores the previous value
+class ScopedEnv {
+ public:
+  ScopedEnv(const char* name, const char* value) : name_(name) {
+    if (const char* previous = getenv(name)) {
+      previous_ = previous;
+    }
+    setenv(name, value, 1);
+  }
+  ~ScopedEnv() {
+    if (previous_) {
+      setenv(name_, previous_->c_str(), 1);
+    } else {
+      unsetenv(name_);
+    }
+  }
+
+ private:
+  const char* name_;
+  std::optional<std::string> previous_;
+};
+
+}  // namespace
+
 TEST_CASE_METHOD(IPCTestFixture, "XDGRuntimeDirExists", "[getSocketFolder]") {
   // Test case: XDG_RUNTIME_DIR exists and contains "hypr" directory
   // Arrange
@@ -53,3 +88,86 @@ TEST_CASE_METHOD(IPCTestFixture, "XDGRuntimeDirExistsNoHyprDir", "[getSocketFold
   // Assert expected result
   REQUIRE(actualPath == expectedPath);
 }
+
+TEST_CASE_METHOD(IPCTestFixture, "SubmapEventsAreDeduplicated", "[submap]") {
+  // Test case: re-entering the active submap doesn't notify handlers again
+  // Arrange
+  struct CountingHandler : public hyprland::EventHandler {
+    int count = 0;
+    void onEvent(const std::string& ev) override { ++count; }
+  } handler;
+  registerForIPC("submap", &handler);
+
+  // Act
+  parseIPC("submap>>resize");
+  parseIPC("submap>>resize");
+  parseIPC("submap>>");
+  parseIPC("submap>>");
+
+  // Assert expected result
+  REQUIRE(handler.count == 2);
+  REQUIRE(getSubmap().empty());
+  unregisterForIPC(&handler);
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "SubmapWithoutCompositor", "[submap]") {
+  // Test case: the submap is read without a socket round trip, a failed query means no submap
+  // Arrange
+  struct CountingHandler : public hyprland::EventHandler {
+    int count = 0;
+    void onEvent(const std::string& /*ev*/) override { ++count; }
+  } handler;
+  registerForIPC("submap", &handler);
+  ScopedEnv runtimeDir("XDG_RUNTIME_DIR", tempDir.c_str());
+  ScopedEnv signature("HYPRLAND_INSTANCE_SIGNATURE", instanceSig);
+
+  // Act and assert expected result
+  REQUIRE(getSubmap().empty());
+  REQUIRE(handler.count == 0);
+  REQUIRE_NOTHROW(seedSubmap());
+  REQUIRE(getSubmap().empty());
+  REQUIRE(handler.count == 1);
+  unregisterForIPC(&handler);
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "DispatchDoesNotWaitForReply", "[dispatch]") {
+  // Test case: dispatch returns before a slow compositor replies, requests keep their order
+  // Arrange
+  using namespace std::chrono_literals;
+  fs::path socketDir = tempDir / "hypr" / instanceSig;
+  fs::create_directories(socketDir);
+  ScopedEnv runtimeDir("XDG_RUNTIME_DIR", tempDir.c_str());
+  ScopedEnv signature("HYPRLAND_INSTANCE_SIGNATURE", instanceSig);
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", (socketDir / ".socket.sock").c_str());
+  REQUIRE(bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+  REQUIRE(listen(server, 4) == 0);
+
+  std::vector<std::string> received;
+  std::thread fakeHyprland([&] {
+    for (int i = 0; i < 2; ++i) {
+      int client = accept(server, nullptr, nullptr);
+      std::array<char, 256> buffer = {0};
+      auto size = read(client, buffer.data(), buffer.size());
+      received.emplace_back(buffer.data(), size > 0 ? size : 0);
+      std::this_thread::sleep_for(100ms);
+      [[maybe_unused]] auto written = write(client, "ok", 2);
+      close(client);
+    }
+  });
+
+  // Act
+  auto start = std::chrono::steady_clock::now();
+  dispatch("dispatch workspace 1");
+  dispatch("dispatch workspace 2");
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  fakeHyprland.join();
+  close(server);
+
+  // Assert expected result
+  REQUIRE(elapsed < 50ms);
+  REQUIRE(received == std::vector<std::string>{"dispatch workspace 1", "dispatch workspace 2"});
+}
@@ -11,12 +11,24 @@
 #include <catch2/catch.hpp>
 #include <catch2/catch_reporter_tap.hpp>
 #endif
+#include <stdlib.h>
+
+#include <filesystem>
 #include <memory>
+#include <string>
 
 int main(int argc, char* argv[]) {
   Catch::Session session;
   Glib::init();
 
+  // loading a config writes its cache, keep it out of the user's cache directory
+  auto cache_home = (std::filesystem::temp_directory_path() / "waybar-test-XXXXXX").string();
+  if (mkdtemp(cache_home.data()) == nullptr) {
+    spdlog::error("Failed to create a cache directory for the tests");
+    return 1;
+  }
+  setenv("XDG_CACHE_HOME", cache_home.c_str(), 1);
+
   session.applyCommandLine(argc, argv);
   const auto logger = spdlog::default_logger();
 #if CATCH_VERSION_MAJOR >= 3
@@ -35,5 +47,7 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  return session.run();
+  const auto result = session.run();
+  std::filesystem::remove_all(cache_home);
+  return result;
 }
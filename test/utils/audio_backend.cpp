@@ -0,0 +1,299 @@
+#include "util/audio_backend.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using waybar::util::AudioQuery;
+using waybar::util::SinkState;
+
+namespace {
+
+/*
+ * `pactl subscribe` while a browser plays a video on the default sink, a notification sound
+ * plays on the same sink and a per-app volume is dragged in pavucontrol.
+ * 40 and 41 are the browser and notification streams on sink 1, 3 runs on sink 2.
+ */
+const char* const RECORDED_EVENTS[] = {
+    "'new' on sink-input #40",    "'change' on sink-input #40", "'change' on sink #1",
+    "'change' on sink-input #40", "'change' on sink-input #40", "'change' on sink-input #40",
+    "'new' on sink-input #41",    "'change' on sink-input #41", "'change' on sink-input #41",
+    "'remove' on sink-input #41", "'change' on sink-input #40", "'change' on sink-input #40",
+    "'change' on sink-input #40", "'change' on sink-input #40", "'change' on sink-input #40",
+    "'change' on sink-input #40", "'change' on sink-input #40", "'change' on sink-input #40",
+    "'change' on sink-input #3",  "'change' on sink-input #3",  "'change' on sink #2",
+    "'change' on source-output #7", "'change' on source #1",     "'change' on sink #1",
+    "'change' on sink-input #40", "'change' on sink-input #40", "'change' on server",
+};
+
+struct Event {
+  pa_subscription_event_type_t type;
+  uint32_t idx;
+};
+
+std::vector<Event> replay() {
+  static const std::map<std::string, unsigned> operations = {
+      {"new", PA_SUBSCRIPTION_EVENT_NEW},
+      {"change", PA_SUBSCRIPTION_EVENT_CHANGE},
+      {"remove", PA_SUBSCRIPTION_EVENT_REMOVE},
+  };
+  static const std::map<std::string, unsigned> facilities = {
+      {"sink", PA_SUBSCRIPTION_EVENT_SINK},
+      {"sink-input", PA_SUBSCRIPTION_EVENT_SINK_INPUT},
+      {"source", PA_SUBSCRIPTION_EVENT_SOURCE},
+      {"source-output", PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT},
+      {"server", PA_SUBSCRIPTION_EVENT_SERVER},
+  };
+
+  std::vector<Event> events;
+  for (const auto* line : RECORDED_EVENTS) {
+    char operation[16] = {};
+    char facility[16] = {};
+    unsigned idx = PA_INVALID_INDEX;
+    std::sscanf(line, "'%15[a-z]' on %15[a-z-] #%u", operation, facility, &idx);
+    events.push_back({static_cast<pa_subscription_event_type_t>(operations.at(operation) |
+                                                                facilities.at(facility)),
+                      idx});
+  }
+  return events;
+}
+
+// A sink as introspection returns it, the strings live in the struct's own storage
+struct FakeSink {
+  FakeSink(uint32_t index, const char* name, pa_volume_t volume) : port{} {
+    std::memset(&info, 0, sizeof(info));
+    info.index = index;
+    info.name = name;
+    info.description = name;
+    info.monitor_source_name = "monitor";
+    info.state = PA_SINK_RUNNING;
+    pa_cvolume_set(&info.volume, 2, volume);
+    port.name = "analog-output-speaker";
+    info.active_port = &port;
+    info.proplist = pa_proplist_new();
+    pa_proplist_sets(info.proplist, PA_PROP_DEVICE_FORM_FACTOR, "speaker");
+  }
+  ~FakeSink() { pa_proplist_free(info.proplist); }
+
+  pa_sink_info info;
+  pa_sink_port_info port;
+};
+
+struct FakeSource {
+  FakeSource(uint32_t index, const char* name) {
+    std::memset(&info, 0, sizeof(info));
+    info.index = index;
+    info.name = name;
+    info.description = name;
+    pa_cvolume_set(&info.volume, 2, PA_VOLUME_NORM);
+  }
+
+  pa_source_info info;
+};
+
+/*
+ * A server with speakers playing, an idle HDMI sink and a microphone.
+ * Streams 40 and 41 play on the speakers, every other stream on HDMI. Requests of the backend
+ * are answered in order with the infos below, like the server does.
+ */
+struct PulseAudioFake {
+  explicit PulseAudioFake(std::vector<std::string> ignored_sinks = {})
+      : backend(waybar::util::AudioBackend::create(
+            std::move(ignored_sinks),
+            [this](AudioQuery query, uint32_t idx) { pending.emplace_back(query, idx); })) {
+    hdmi.info.state = PA_SINK_IDLE;
+    std::memset(&server, 0, sizeof(server));
+    server.default_sink_name = "speakers";
+    server.default_source_name = "mic";
+    backend->addListener([this] { ++notifications; });
+  }
+
+  void startup() {
+    pending.emplace_back(AudioQuery::Server, PA_INVALID_INDEX);
+    answer();
+  }
+
+  // The server sends the event, the sink of the speakers toggles its mute on its own changes
+  void event(const Event& event) {
+    if (waybar::util::audioQueryFor(event.type) == AudioQuery::Sink && event.idx == 1) {
+      speakers.info.mute = !speakers.info.mute;
+    }
+    backend->replay(event.type, event.idx);
+    answer();
+  }
+
+  void answer() {
+    while (!pending.empty()) {
+      auto [query, idx] = pending.front();
+      pending.pop_front();
+      ++queries[{query, idx == PA_INVALID_INDEX}];
+      switch (query) {
+        case AudioQuery::Server:
+          backend->replay(server);
+          break;
+        case AudioQuery::Sink:
+          if (idx != 2) {
+            backend->replay(speakers.info);
+          }
+          if (idx != 1) {
+            backend->replay(hdmi.info);
+          }
+          break;
+        case AudioQuery::SinkInput: {
+          pa_sink_input_info stream;
+          std::memset(&stream, 0, sizeof(stream));
+          stream.index = idx;
+          stream.sink = idx == 40 || idx == 41 ? 1 : 2;
+          backend->replay(stream);
+          break;
+        }
+        case AudioQuery::Source:
+          backend->replay(mic.info);
+          break;
+        case AudioQuery::SourceOutput: {
+          pa_source_output_info stream;
+          std::memset(&stream, 0, sizeof(stream));
+          stream.index = idx;
+          stream.source = 1;
+          backend->replay(stream);
+          break;
+        }
+        case AudioQuery::None:
+          break;
+      }
+    }
+  }
+
+  FakeSink speakers{1, "speakers", PA_VOLUME_NORM / 2};
+  FakeSink hdmi{2, "hdmi", PA_VOLUME_NORM};
+  FakeSource mic{1, "mic"};
+  pa_server_info server;
+  std::deque<std::pair<AudioQuery, uint32_t>> pending;
+  // requests by kind and whether they listed every sink or source
+  std::map<std::pair<AudioQuery, bool>, size_t> queries;
+  size_t notifications = 0;
+  std::shared_ptr<waybar::util::AudioBackend> backend;
+};
+
+}  // namespace
+
+TEST_CASE("Subscription events map to targeted queries", "[util][audio]") {
+  auto query = [](unsigned facility, unsigned operation) {
+    return waybar::util::audioQueryFor(
+        static_cast<pa_subscription_event_type_t>(facility | operation));
+  };
+
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SINK_INPUT, PA_SUBSCRIPTION_EVENT_CHANGE) ==
+        AudioQuery::SinkInput);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT, PA_SUBSCRIPTION_EVENT_CHANGE) ==
+        AudioQuery::SourceOutput);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SINK, PA_SUBSCRIPTION_EVENT_CHANGE) == AudioQuery::Sink);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SOURCE, PA_SUBSCRIPTION_EVENT_CHANGE) == AudioQuery::Source);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SERVER, PA_SUBSCRIPTION_EVENT_CHANGE) == AudioQuery::Server);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SINK_INPUT, PA_SUBSCRIPTION_EVENT_NEW) == AudioQuery::None);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_SINK_INPUT, PA_SUBSCRIPTION_EVENT_REMOVE) ==
+        AudioQuery::None);
+  CHECK(query(PA_SUBSCRIPTION_EVENT_CLIENT, PA_SUBSCRIPTION_EVENT_CHANGE) == AudioQuery::None);
+}
+
+TEST_CASE("Sink state only differs on rendered fields", "[util][audio]") {
+  FakeSink sink(1, "speakers", PA_VOLUME_NORM / 2);
+  const auto state = SinkState::from(sink.info);
+  CHECK(state.index == 1);
+  CHECK(state.volume == 50);
+  CHECK_FALSE(state.muted);
+  CHECK(state.port_name == "analog-output-speaker");
+  CHECK(state.form_factor == "speaker");
+
+  // corking the last stream suspends the sink, nothing on the bar changes
+  sink.info.state = PA_SINK_IDLE;
+  CHECK(SinkState::from(sink.info) == state);
+
+  sink.info.mute = 1;
+  CHECK(SinkState::from(sink.info) != state);
+  sink.info.mute = 0;
+  pa_cvolume_set(&sink.info.volume, 2, PA_VOLUME_NORM);
+  CHECK(SinkState::from(sink.info).volume == 100);
+}
+
+TEST_CASE("Recorded stream events refresh one sink", "[util][audio]") {
+  PulseAudioFake pulse;
+  pulse.startup();
+  REQUIRE(pulse.backend->getCurrentSinkName() == "speakers");
+  REQUIRE(pulse.backend->getDefaultSourceName() == "mic");
+  pulse.queries.clear();
+  pulse.notifications = 0;
+
+  size_t stream_changes = 0;
+  for (const auto& event : replay()) {
+    stream_changes += waybar::util::audioQueryFor(event.type) == AudioQuery::SinkInput;
+    pulse.event(event);
+  }
+  REQUIRE(stream_changes == 18);
+
+  // one stream and one sink per stream change, nothing listed but on the server change
+  CHECK(pulse.queries[{AudioQuery::SinkInput, false}] == stream_changes);
+  CHECK(pulse.queries[{AudioQuery::Sink, false}] == stream_changes + 3);
+  CHECK(pulse.queries[{AudioQuery::SourceOutput, false}] == 1);
+  CHECK(pulse.queries[{AudioQuery::Source, false}] == 2);
+  CHECK(pulse.queries[{AudioQuery::Server, true}] == 1);
+  CHECK(pulse.queries[{AudioQuery::Sink, true}] == 1);
+  CHECK(pulse.queries[{AudioQuery::Source, true}] == 1);
+
+  // the browser stream's volume changes do not touch the sink, only the two mutes notify
+  CHECK(pulse.notifications == 2);
+  CHECK_FALSE(pulse.backend->getSinkMuted());
+}
+
+TEST_CASE("Source changes update the source only", "[util][audio]") {
+  PulseAudioFake pulse;
+  pulse.startup();
+  pulse.notifications = 0;
+
+  pulse.mic.info.mute = 1;
+  pulse.event({static_cast<pa_subscription_event_type_t>(PA_SUBSCRIPTION_EVENT_SOURCE |
+                                                         PA_SUBSCRIPTION_EVENT_CHANGE),
+               1});
+  CHECK(pulse.notifications == 1);
+  CHECK(pulse.backend->getSourceMuted());
+  CHECK_FALSE(pulse.backend->getSinkMuted());
+}
+
+TEST_CASE("Ignored sinks are never tracked", "[util][audio]") {
+  PulseAudioFake pulse({"speakers"});
+  pulse.startup();
+  CHECK(pulse.backend->getSinkDesc().empty());
+  // only the source notified
+  CHECK(pulse.notifications == 1);
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Audio subscription replay benchmark", "[.][benchmark][audio]") {
+  const auto events = replay();
+  PulseAudioFake pulse;
+  pulse.startup();
+
+  BENCHMARK("route and answer recorded events") {
+    for (const auto& event : events) {
+      pulse.event(event);
+    }
+    return pulse.notifications;
+  };
+}
+#endif
@@ -0,0 +1,163 @@
+#include "util/child_registry.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+namespace {
+
+pid_t spawn(bool wait_for_signal) {
+  // The test framework's handler would report a SIGTERM as a failure. The child only lets it
+  // through once the default action is back, even if it arrives right after fork().
+  sigset_t term;
+  sigset_t previous;
+  sigemptyset(&term);
+  sigaddset(&term, SIGTERM);
+  sigprocmask(SIG_BLOCK, &term, &previous);
+  pid_t pid = fork();
+  if (pid == 0) {
+    setpgid(0, 0);
+    signal(SIGTERM, SIG_DFL);
+    sigprocmask(SIG_SETMASK, &previous, nullptr);
+    if (wait_for_signal) {
+      pause();
+    }
+    _exit(0);
+  }
+  sigprocmask(SIG_SETMASK, &previous, nullptr);
+  return pid;
+}
+
+// Stand-in for the signal thread: reap until everything registered has exited
+void reapAll(waybar::util::ChildRegistry& registry) {
+  for (int i = 0; i < 1000 && registry.size() != 0; ++i) {
+    registry.reap();
+    if (registry.size() != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+void spawnAndReap(waybar::util::ChildRegistry& registry, int count, int batch) {
+  int owner;
+  for (int i = 0; i < count; i += batch) {
+    for (int j = 0; j < batch; ++j) {
+      registry.add(spawn(false), &owner);
+    }
+    reapAll(registry);
+    REQUIRE(registry.size() == 0);
+    REQUIRE(registry.size(&owner) == 0);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Exited children are dropped", "[util][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  int owner;
+
+  // still running when added, exit once signalled
+  auto pid = spawn(true);
+  auto other = spawn(true);
+  registry.add(pid, &owner);
+  registry.add(other);
+  REQUIRE(registry.size() == 2);
+  REQUIRE(registry.size(&owner) == 1);
+
+  REQUIRE(registry.contains(pid));
+
+  kill(pid, SIGTERM);
+  kill(other, SIGTERM);
+  reapAll(registry);
+  REQUIRE(registry.size() == 0);
+  REQUIRE(registry.size(&owner) == 0);
+  REQUIRE_FALSE(registry.contains(pid));
+  // already reaped by the registry
+  REQUIRE(waitpid(pid, nullptr, WNOHANG) == -1);
+}
+
+TEST_CASE("Children that exit before they are added are reaped", "[util][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  int owner;
+
+  auto pid = spawn(false);
+  // wait for the exit without reaping, as if SIGCHLD had been handled before add
+  siginfo_t info;
+  REQUIRE(waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == 0);
+  registry.reap();
+
+  registry.add(pid, &owner);
+  REQUIRE(registry.size() == 0);
+  REQUIRE(registry.size(&owner) == 0);
+  REQUIRE_FALSE(registry.contains(pid));
+  REQUIRE(waitpid(pid, nullptr, WNOHANG) == -1);
+}
+
+TEST_CASE("Exit callbacks run once the child is reaped", "[util][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  int exited = 0;
+
+  auto pid = spawn(true);
+  registry.add(pid, nullptr, [&exited] { ++exited; });
+  registry.reap();
+  REQUIRE(exited == 0);
+  kill(pid, SIGTERM);
+  reapAll(registry);
+  REQUIRE(exited == 1);
+
+  SECTION("also when the child exited before it was added") {
+    pid = spawn(false);
+    siginfo_t info;
+    REQUIRE(waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == 0);
+    registry.add(pid, nullptr, [&exited] { ++exited; });
+    REQUIRE(exited == 2);
+  }
+}
+
+TEST_CASE("Terminate only signals running children of the owner", "[util][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  int owner;
+  int other;
+
+  auto running = spawn(true);
+  auto kept = spawn(true);
+  registry.add(spawn(false), &owner);
+  registry.add(running, &owner);
+  registry.add(kept, &other);
+  // let the first child exit and get reaped before its owner goes away
+  for (int i = 0; i < 1000 && registry.size(&owner) != 1; ++i) {
+    registry.reap();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(registry.size(&owner) == 1);
+
+  registry.terminate(&owner);
+  REQUIRE(registry.size(&owner) == 0);
+  // still tracked until reaped
+  reapAll(registry);
+  REQUIRE(registry.size() == 1);
+  REQUIRE(registry.size(&other) == 1);
+
+  registry.terminate(&other);
+  reapAll(registry);
+  REQUIRE(registry.size() == 0);
+}
+
+TEST_CASE("Registry size is bounded by running children", "[util][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  spawnAndReap(registry, 2000, 50);
+}
+
+// 100k spawns, takes a while. Run with `utils_test "[soak]"`.
+TEST_CASE("Child registry soak", "[.][soak][child_registry]") {
+  waybar::util::ChildRegistry registry;
+  spawnAndReap(registry, 100000, 100);
+}
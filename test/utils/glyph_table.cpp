@@ -0,0 +1,69 @@
+#include "util/glyph_table.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+using waybar::util::GlyphTable;
+
+namespace {
+
+const std::vector<std::string> BLOCKS = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+
+}  // namespace
+
+TEST_CASE("Glyph table renders one glyph per level", "[util][glyph_table]") {
+  GlyphTable table(BLOCKS, 0);
+  REQUIRE(table.size() == 8);
+
+  REQUIRE(table.render({0, 3, 7}));
+  CHECK(table.text() == "▁▄█");
+
+  SECTION("Levels out of range are clamped") {
+    REQUIRE(table.render({-1, 9}));
+    CHECK(table.text() == "▁█");
+  }
+
+  SECTION("Unchanged frames are skipped") {
+    CHECK_FALSE(table.render({0, 3, 7}));
+    CHECK(table.text() == "▁▄█");
+    CHECK(table.render({0, 3}));
+    CHECK(table.text() == "▁▄");
+  }
+}
+
+TEST_CASE("Glyph table delimiter follows every glyph", "[util][glyph_table]") {
+  GlyphTable table(BLOCKS, ';');
+  REQUIRE(table.render({1, 2}));
+  CHECK(table.text() == "▂;▃;");
+
+  GlyphTable empty;
+  CHECK(empty.render({1, 2}));
+  CHECK(empty.text().empty());
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Glyph table frame assembly", "[.][benchmark][glyph_table]") {
+  GlyphTable table(BLOCKS, 0);
+  std::vector<int> levels(32);
+  int frame = 0;
+
+  BENCHMARK("32 bars") {
+    ++frame;
+    for (size_t i = 0; i < levels.size(); ++i) {
+      levels[i] = static_cast<int>((i + frame) % BLOCKS.size());
+    }
+    table.render(levels);
+    return table.text().size();
+  };
+
+  BENCHMARK("32 bars, unchanged") { return table.render(levels); };
+}
+#endif
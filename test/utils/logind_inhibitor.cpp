@@ -0,0 +1,313 @@
+#include "util/logind_inhibitor.hpp"
+
+#include <fcntl.h>
+#include <gio/gunixfdlist.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using waybar::util::LogindInhibitor;
+
+namespace {
+
+const char* const LOGIND_XML = R"(
+<node>
+  <interface name='org.freedesktop.login1.Manager'>
+    <method name='Inhibit'>
+      <arg type='s' name='what' direction='in'/>
+      <arg type='s' name='who' direction='in'/>
+      <arg type='s' name='why' direction='in'/>
+      <arg type='s' name='mode' direction='in'/>
+      <arg type='h' name='fd' direction='out'/>
+    </method>
+  </interface>
+</node>)";
+
+// Iterates the default main context until pred holds, false after two seconds
+bool waitFor(const std::function<bool()>& pred) {
+  const auto deadline = g_get_monotonic_time() + 2 * G_TIME_SPAN_SECOND;
+  while (!pred()) {
+    if (g_get_monotonic_time() > deadline) {
+      return false;
+    }
+    if (!g_main_context_iteration(nullptr, FALSE)) {
+      g_usleep(1000);
+    }
+  }
+  return true;
+}
+
+GDBusConnection* connectTo(GTestDBus* bus) {
+  return g_dbus_connection_new_for_address_sync(
+      g_test_dbus_get_bus_address(bus),
+      static_cast<GDBusConnectionFlags>(G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                        G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+      nullptr, nullptr, nullptr);
+}
+
+/*
+ * org.freedesktop.login1 on a private session bus.
+ * Every lock is the read end of a pipe, the write end tells whether the client still holds it.
+ */
+class FakeLogind {
+ public:
+  explicit FakeLogind(GDBusConnection* bus) : bus_(bus) {
+    auto* info = g_dbus_node_info_new_for_xml(LOGIND_XML, nullptr);
+    static const GDBusInterfaceVTable vtable = {
+        .method_call =
+            [](GDBusConnection*, const gchar*, const gchar*, const gchar*, const gchar*,
+               GVariant* parameters, GDBusMethodInvocation* invocation, gpointer data) {
+              static_cast<FakeLogind*>(data)->inhibit(parameters, invocation);
+            },
+    };
+    registration_ = g_dbus_connection_register_object(
+        bus_, "/org/freedesktop/login1", info->interfaces[0], &vtable, this, nullptr, nullptr);
+    g_dbus_node_info_unref(info);
+
+    auto* reply = g_dbus_connection_call_sync(
+        bus_, "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+        "RequestName", g_variant_new("(su)", "org.freedesktop.login1", 0), nullptr,
+        G_DBUS_CALL_FLAGS_NONE, -1, nullptr, nullptr);
+    g_variant_unref(reply);
+  }
+
+  ~FakeLogind() {
+    for (auto* invocation : held) {
+      g_object_unref(invocation);
+    }
+    for (auto fd : locks_) {
+      ::close(fd);
+    }
+    g_dbus_connection_unregister_object(bus_, registration_);
+  }
+
+  void replyHeld() {
+    auto invocations = std::move(held);
+    for (auto* invocation : invocations) {
+      reply(invocation);
+    }
+  }
+
+  // Locks whose read end is still open somewhere
+  size_t openLocks() const {
+    size_t open = 0;
+    for (auto fd : locks_) {
+      struct pollfd pfd = {.fd = fd, .events = 0, .revents = 0};
+      ::poll(&pfd, 1, 0);
+      if ((pfd.revents & POLLERR) == 0) {
+        ++open;
+      }
+    }
+    return open;
+  }
+
+  std::vector<std::string> calls;
+  std::vector<GDBusMethodInvocation*> held;
+  bool hold = false;
+  bool fail = false;
+
+ private:
+  void inhibit(GVariant* parameters, GDBusMethodInvocation* invocation) {
+    const gchar* what = nullptr;
+    g_variant_get(parameters, "(&s&s&s&s)", &what, nullptr, nullptr, nullptr);
+    calls.emplace_back(what);
+    if (hold) {
+      held.push_back(G_DBUS_METHOD_INVOCATION(g_object_ref(invocation)));
+      return;
+    }
+    reply(invocation);
+  }
+
+  void reply(GDBusMethodInvocation* invocation) {
+    if (fail) {
+      g_dbus_method_invocation_return_dbus_error(
+          invocation, "org.freedesktop.DBus.Error.AccessDenied", "Permission denied");
+      return;
+    }
+    int fds[2];
+    REQUIRE(::pipe2(fds, O_CLOEXEC) == 0);
+    locks_.push_back(fds[1]);
+    auto* fd_list = g_unix_fd_list_new_from_array(&fds[0], 1);
+    g_dbus_method_invocation_return_value_with_unix_fd_list(invocation, g_variant_new("(h)", 0),
+                                                            fd_list);
+    g_object_unref(fd_list);
+  }
+
+  GDBusConnection* bus_;
+  guint registration_;
+  std::vector<int> locks_;
+};
+
+class LogindFixture {
+ public:
+  LogindFixture() {
+    gchar* daemon = g_find_program_in_path("dbus-daemon");
+    available = daemon != nullptr;
+    g_free(daemon);
+    if (!available) {
+      return;
+    }
+    test_bus_ = g_test_dbus_new(G_TEST_DBUS_NONE);
+    g_test_dbus_up(test_bus_);
+    server_bus_ = connectTo(test_bus_);
+    client_bus_ = connectTo(test_bus_);
+    logind = std::make_unique<FakeLogind>(server_bus_);
+    inhibitor = LogindInhibitor::create(client_bus_);
+    inhibitor->signal_changed().connect(
+        [this](const std::string& what) { changes.push_back(what); });
+  }
+
+  ~LogindFixture() {
+    if (!available) {
+      return;
+    }
+    inhibitor.reset();
+    logind.reset();
+    // let pending replies and cancellations run before the connections go away
+    waitFor([] { return !g_main_context_pending(nullptr); });
+    g_dbus_connection_close_sync(client_bus_, nullptr, nullptr);
+    g_dbus_connection_close_sync(server_bus_, nullptr, nullptr);
+    g_object_unref(client_bus_);
+    g_object_unref(server_bus_);
+    g_test_dbus_down(test_bus_);
+    g_object_unref(test_bus_);
+  }
+
+  bool available = false;
+  std::unique_ptr<FakeLogind> logind;
+  std::shared_ptr<LogindInhibitor> inhibitor;
+  std::vector<std::string> changes;
+
+ private:
+  GTestDBus* test_bus_ = nullptr;
+  GDBusConnection* server_bus_ = nullptr;
+  GDBusConnection* client_bus_ = nullptr;
+};
+
+}  // namespace
+
+TEST_CASE("Inhibitor keys are normalized", "[util][inhibitor]") {
+  CHECK(LogindInhibitor::normalize("idle") == "idle");
+  CHECK(LogindInhibitor::normalize("sleep:idle") == "idle:sleep");
+  CHECK(LogindInhibitor::normalize("sleep:idle:sleep:") == "idle:sleep");
+}
+
+TEST_CASE_METHOD(LogindFixture, "Inhibit does not block the caller", "[util][inhibitor]") {
+  if (!available) {
+    WARN("dbus-daemon not found, skipping");
+    return;
+  }
+  logind->hold = true;
+
+  inhibitor->toggle("idle");
+  CHECK(inhibitor->pending("idle"));
+  CHECK_FALSE(inhibitor->active("idle"));
+  REQUIRE(waitFor([&] { return logind->held.size() == 1; }));
+  CHECK(inhibitor->pending("idle"));
+
+  logind->replyHeld();
+  REQUIRE(waitFor([&] { return inhibitor->active("idle"); }));
+  CHECK_FALSE(inhibitor->pending("idle"));
+  CHECK(logind->openLocks() == 1);
+  CHECK(changes == std::vector<std::string>{"idle", "idle"});
+
+  inhibitor->toggle("idle");
+  CHECK_FALSE(inhibitor->active("idle"));
+  CHECK(waitFor([&] { return logind->openLocks() == 0; }));
+}
+
+TEST_CASE_METHOD(LogindFixture, "Modules with the same what share one lock", "[util][inhibitor]") {
+  if (!available) {
+    WARN("dbus-daemon not found, skipping");
+    return;
+  }
+
+  inhibitor->toggle("sleep:idle");
+  REQUIRE(waitFor([&] { return inhibitor->active("idle:sleep"); }));
+  CHECK(inhibitor->active("sleep:idle"));
+  CHECK_FALSE(inhibitor->active("idle"));
+  REQUIRE(logind->calls == std::vector<std::string>{"idle:sleep"});
+
+  // the module on another bar releases the lock taken by the first one
+  inhibitor->toggle("idle:sleep");
+  CHECK_FALSE(inhibitor->active("sleep:idle"));
+  CHECK(waitFor([&] { return logind->openLocks() == 0; }));
+  CHECK(logind->calls.size() == 1);
+}
+
+TEST_CASE_METHOD(LogindFixture, "Releasing a pending lock drops it on reply", "[util][inhibitor]") {
+  if (!available) {
+    WARN("dbus-daemon not found, skipping");
+    return;
+  }
+  logind->hold = true;
+
+  inhibitor->toggle("idle");
+  inhibitor->toggle("idle");
+  CHECK(inhibitor->pending("idle"));
+  REQUIRE(waitFor([&] { return logind->held.size() == 1; }));
+
+  logind->replyHeld();
+  REQUIRE(waitFor([&] { return !inhibitor->pending("idle"); }));
+  CHECK_FALSE(inhibitor->active("idle"));
+  CHECK(waitFor([&] { return logind->openLocks() == 0; }));
+  CHECK(logind->calls.size() == 1);
+
+  SECTION("toggling back on while pending keeps the lock") {
+    inhibitor->toggle("idle");
+    inhibitor->toggle("idle");
+    inhibitor->toggle("idle");
+    REQUIRE(waitFor([&] { return logind->held.size() == 1; }));
+    logind->replyHeld();
+    REQUIRE(waitFor([&] { return inhibitor->active("idle"); }));
+    CHECK(logind->calls.size() == 2);
+  }
+}
+
+TEST_CASE_METHOD(LogindFixture, "Failed Inhibit calls leave the lock released",
+                 "[util][inhibitor]") {
+  if (!available) {
+    WARN("dbus-daemon not found, skipping");
+    return;
+  }
+  logind->fail = true;
+
+  inhibitor->toggle("shutdown");
+  REQUIRE(waitFor([&] { return !inhibitor->pending("shutdown"); }));
+  CHECK_FALSE(inhibitor->active("shutdown"));
+
+  logind->fail = false;
+  inhibitor->toggle("shutdown");
+  REQUIRE(waitFor([&] { return inhibitor->active("shutdown"); }));
+  CHECK(logind->calls.size() == 2);
+}
+
+TEST_CASE_METHOD(LogindFixture, "Locks are closed with the inhibitor", "[util][inhibitor]") {
+  if (!available) {
+    WARN("dbus-daemon not found, skipping");
+    return;
+  }
+
+  inhibitor->toggle("idle");
+  REQUIRE(waitFor([&] { return inhibitor->active("idle"); }));
+  logind->hold = true;
+  inhibitor->toggle("sleep");
+  REQUIRE(waitFor([&] { return logind->held.size() == 1; }));
+
+  inhibitor.reset();
+  CHECK(waitFor([&] { return logind->openLocks() == 0; }));
+
+  // a reply arriving after the inhibitor is gone is closed right away
+  logind->replyHeld();
+  CHECK(waitFor([&] { return logind->openLocks() == 0 && !g_main_context_pending(nullptr); }));
+}
@@ -0,0 +1,100 @@
+#include "util/netdev.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+#include <fmt/format.h>
+
+#include <string>
+
+using waybar::util::BandwidthMeter;
+using waybar::util::NetDevBytes;
+using waybar::util::parseNetDev;
+
+namespace {
+
+// /proc/net/dev of a laptop on ethernet, wifi and a VPN
+std::string netdev(unsigned long long eth, unsigned long long wlan, unsigned long long wg) {
+  return fmt::format(
+      "Inter-|   Receive                                                |  Transmit\n"
+      " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs "
+      "drop fifo colls carrier compressed\n"
+      "    lo:  123456     789    0    0    0     0          0         0   123456     789    0 "
+      "   0    0     0       0          0\n"
+      "enp0s31f6:{:>8}  15000    0    0    0     0          0       120 {:>8}   9000    0    0 "
+      "   0     0       0          0\n"
+      " wlan0: {:>8}   4000    0    3    0     0          0         0 {:>8}   2000    0    0 "
+      "   0     0       0          0\n"
+      "   wg0: {:>8}    500    0    0    0     0          0         0 {:>8}    400    0    0 "
+      "   0     0       0          0\n",
+      eth, eth / 2, wlan, wlan / 2, wg, wg / 2);
+}
+
+}  // namespace
+
+TEST_CASE("Net dev counters are read for every interface", "[util][netdev]") {
+  auto snapshot = parseNetDev(netdev(1000, 2000, 3000));
+  REQUIRE(snapshot.size() == 4);
+  CHECK(snapshot["lo"] == NetDevBytes{.down = 123456, .up = 123456});
+  CHECK(snapshot["enp0s31f6"] == NetDevBytes{.down = 1000, .up = 500});
+  CHECK(snapshot["wlan0"] == NetDevBytes{.down = 2000, .up = 1000});
+  CHECK(snapshot["wg0"] == NetDevBytes{.down = 3000, .up = 1500});
+
+  SECTION("counters wider than their column follow the colon") {
+    snapshot = parseNetDev(netdev(123456789012, 0, 0));
+    CHECK(snapshot["enp0s31f6"].down == 123456789012);
+    CHECK(snapshot["enp0s31f6"].up == 61728394506);
+  }
+  SECTION("truncated lines are skipped") {
+    snapshot = parseNetDev("  eth0: 1 2 3\n  eth1: 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16");
+    CHECK(snapshot.size() == 1);
+    CHECK(snapshot["eth1"] == NetDevBytes{.down = 1, .up = 9});
+  }
+}
+
+TEST_CASE("Bandwidth meter reports bytes since the previous snapshot", "[util][netdev]") {
+  BandwidthMeter meter;
+  meter.sample(parseNetDev(netdev(1000, 2000, 3000)));
+  CHECK(meter.moved("wlan0") == NetDevBytes{});
+
+  meter.sample(parseNetDev(netdev(1500, 2000, 3100)));
+  CHECK(meter.moved("enp0s31f6") == NetDevBytes{.down = 500, .up = 250});
+  CHECK(meter.moved("wlan0") == NetDevBytes{});
+  CHECK(meter.moved("wg0") == NetDevBytes{.down = 100, .up = 50});
+  CHECK(meter.moved("missing") == NetDevBytes{});
+
+  NetDevBytes total;
+  for (const auto* ifname : {"enp0s31f6", "wlan0", "wg0"}) {
+    total += meter.moved(ifname);
+  }
+  CHECK(total == NetDevBytes{.down = 600, .up = 300});
+
+  SECTION("a recreated interface counts from zero") {
+    meter.sample(parseNetDev(netdev(1500, 2000, 40)));
+    CHECK(meter.moved("wg0") == NetDevBytes{.down = 40, .up = 20});
+  }
+  SECTION("an interface that appears moved nothing yet") {
+    meter.sample(parseNetDev("  tun0: 5000 1 0 0 0 0 0 0 7000 1 0 0 0 0 0 0\n"));
+    CHECK(meter.moved("tun0") == NetDevBytes{});
+    CHECK(meter.moved("wg0") == NetDevBytes{});
+  }
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Net dev snapshot cost", "[.][benchmark][netdev]") {
+  const auto text = netdev(123456789, 987654321, 5555);
+  BandwidthMeter meter;
+  BENCHMARK("parse and sample") {
+    meter.sample(parseNetDev(text));
+    return meter.moved("wlan0").down;
+  };
+}
+#endif
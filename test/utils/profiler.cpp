@@ -0,0 +1,78 @@
+#include "util/profiler.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <new>
+#include <vector>
+
+using waybar::util::Profiler;
+
+namespace {
+
+const Profiler::Totals& totalsOf(const std::vector<Profiler::Totals>& totals,
+                                 const std::string& name) {
+  for (const auto& account : totals) {
+    if (account.name == name) {
+      return account;
+    }
+  }
+  FAIL("no account " << name);
+  throw;
+}
+
+}  // namespace
+
+TEST_CASE("Profiler charges the innermost scope", "[util][profiler]") {
+  Profiler::enable();
+  auto* module = Profiler::account("clock@DP-1");
+  auto* backend = Profiler::account("test-backend");
+  REQUIRE(module == Profiler::account("clock@DP-1"));
+  const auto before = Profiler::snapshot();
+
+  {
+    Profiler::Scope scope(module);
+    CHECK(Profiler::current() == module);
+    // called directly, new and delete pairs of new expressions may be elided by the optimizer
+    void* buffer = ::operator new(4096);
+    {
+      Profiler::Scope inner(backend);
+      CHECK(Profiler::current() == backend);
+      for (int i = 0; i < 3; ++i) {
+        ::operator delete(::operator new(sizeof(int)));
+      }
+    }
+    CHECK(Profiler::current() == module);
+    ::operator delete(buffer);
+  }
+  CHECK(Profiler::current() == nullptr);
+
+  const auto growth = Profiler::difference(Profiler::snapshot(), before);
+  const auto& outer = totalsOf(growth, "clock@DP-1");
+  CHECK(outer.calls == 1);
+  CHECK(outer.allocations == 1);
+  CHECK(outer.allocated_bytes == 4096);
+  const auto& inner = totalsOf(growth, "test-backend");
+  CHECK(inner.calls == 1);
+  CHECK(inner.allocations == 3);
+  CHECK(inner.allocated_bytes == 3 * sizeof(int));
+}
+
+TEST_CASE("Profiler report lists every account", "[util][profiler]") {
+  const auto report = Profiler::report({{"battery@eDP-1", 3, 2000000, 1500000, 12, 2048}});
+  CHECK(report.find("battery@eDP-1") != std::string::npos);
+  CHECK(report.find("1.500") != std::string::npos);
+  CHECK(report.find("2.0") != std::string::npos);
+}
+
+TEST_CASE("Scopes without an account are free", "[util][profiler]") {
+  const auto allocations = Profiler::threadAllocations();
+  {
+    Profiler::Scope scope(nullptr);
+    CHECK(Profiler::current() == nullptr);
+  }
+  CHECK(Profiler::threadAllocations() == allocations);
+}
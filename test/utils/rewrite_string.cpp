@@ -0,0 +1,87 @@
+#include "util/rewrite_string.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+#include <fmt/format.h>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Rewrite rules", "[util][rewrite]") {
+  Json::Value rules(Json::objectValue);
+  rules["(.*) - Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) - zsh"] = "> [$1]";
+
+  SECTION("Matching rule is applied") {
+    waybar::util::RewriteRules compiled(rules);
+    REQUIRE(compiled.apply("Waybar - Mozilla Firefox") == "🌎 Waybar");
+    REQUIRE(compiled.apply("~ - ZSH") == "> [~]");
+    REQUIRE(compiled.apply("unrelated") == "unrelated");
+  }
+
+  SECTION("Compiled rules agree with rewriteString") {
+    waybar::util::RewriteRules compiled(rules);
+    for (const std::string title : {"a - Mozilla Firefox", "b - zsh", "", "c"}) {
+      REQUIRE(compiled.apply(title) == waybar::util::rewriteString(title, rules));
+    }
+  }
+
+  SECTION("Invalid rules are skipped") {
+    rules["(unbalanced"] = "x";
+    waybar::util::RewriteRules compiled(rules);
+    REQUIRE(compiled.apply("Waybar - Mozilla Firefox") == "🌎 Waybar");
+  }
+
+  SECTION("Non-object config gives no rules") {
+    waybar::util::RewriteRules compiled(Json::Value("rule"));
+    REQUIRE(compiled.empty());
+    REQUIRE(compiled.apply("title") == "title");
+  }
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+namespace {
+
+Json::Value makeRules(int count) {
+  Json::Value rules(Json::objectValue);
+  for (int i = 0; i < count; ++i) {
+    rules[fmt::format("(.*) - App {}", i)] = fmt::format("<app{}> $1", i);
+  }
+  return rules;
+}
+
+}  // namespace
+
+// Taskbar refresh: 50 tasks, 10 rewrite rules. Run with `utils_test "[benchmark]"`.
+TEST_CASE("Rewrite rules benchmark", "[.][benchmark][rewrite]") {
+  const auto rules = makeRules(10);
+  std::vector<std::string> titles;
+  for (int i = 0; i < 50; ++i) {
+    titles.push_back(fmt::format("Document {} - App {}", i, i % 20));
+  }
+
+  BENCHMARK("rewriteString per title") {
+    size_t len = 0;
+    for (const auto& title : titles) {
+      len += waybar::util::rewriteString(title, rules).size();
+    }
+    return len;
+  };
+
+  const waybar::util::RewriteRules compiled(rules);
+  BENCHMARK("RewriteRules::apply per title") {
+    size_t len = 0;
+    for (const auto& title : titles) {
+      len += compiled.apply(title).size();
+    }
+    return len;
+  };
+}
+#endif
@@ -0,0 +1,116 @@
+#include "util/rfkill.hpp"
+
+#include <fcntl.h>
+#include <glib.h>
+#include <unistd.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <cstring>
+#include <vector>
+
+using waybar::util::Rfkill;
+using waybar::util::RfkillMonitor;
+
+namespace {
+
+// The kernel side of /dev/rfkill, events written here come out of the monitor's fd
+class FakeRfkill {
+ public:
+  FakeRfkill() {
+    int fds[2];
+    REQUIRE(::pipe2(fds, O_CLOEXEC) == 0);
+    write_fd_ = fds[1];
+    monitor = RfkillMonitor::create(fds[0]);
+  }
+
+  ~FakeRfkill() {
+    monitor.reset();
+    ::close(write_fd_);
+  }
+
+  void send(uint32_t idx, enum rfkill_type type, enum rfkill_operation op, bool soft,
+            bool hard = false) {
+    struct rfkill_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.idx = idx;
+    event.type = type;
+    event.op = op;
+    event.soft = soft;
+    event.hard = hard;
+    REQUIRE(::write(write_fd_, &event, sizeof(event)) == sizeof(event));
+  }
+
+  void dispatch() {
+    while (g_main_context_iteration(nullptr, FALSE)) {
+    }
+  }
+
+  std::shared_ptr<RfkillMonitor> monitor;
+
+ private:
+  int write_fd_;
+};
+
+}  // namespace
+
+TEST_CASE("Rfkill state is tracked per type and device", "[util][rfkill]") {
+  FakeRfkill rfkill;
+  rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_ADD, false);
+  rfkill.send(1, RFKILL_TYPE_BLUETOOTH, RFKILL_OP_ADD, true);
+  rfkill.send(2, RFKILL_TYPE_WLAN, RFKILL_OP_ADD, true);
+  rfkill.dispatch();
+
+  CHECK(rfkill.monitor->devices(RFKILL_TYPE_WLAN) == 2);
+  CHECK(rfkill.monitor->devices(RFKILL_TYPE_BLUETOOTH) == 1);
+  CHECK(rfkill.monitor->blocked(RFKILL_TYPE_BLUETOOTH));
+  // one of the two radios can still be used
+  CHECK_FALSE(rfkill.monitor->blocked(RFKILL_TYPE_WLAN));
+  CHECK_FALSE(rfkill.monitor->blocked(RFKILL_TYPE_WWAN));
+
+  rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_CHANGE, false, true);
+  rfkill.dispatch();
+  CHECK(rfkill.monitor->blocked(RFKILL_TYPE_WLAN));
+
+  rfkill.send(2, RFKILL_TYPE_WLAN, RFKILL_OP_DEL, true);
+  rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_DEL, false, true);
+  rfkill.dispatch();
+  CHECK(rfkill.monitor->devices(RFKILL_TYPE_WLAN) == 0);
+  CHECK_FALSE(rfkill.monitor->blocked(RFKILL_TYPE_WLAN));
+}
+
+TEST_CASE("Rfkill subscribers only hear about their type", "[util][rfkill]") {
+  FakeRfkill rfkill;
+  std::vector<bool> wlan;
+  std::vector<bool> bluetooth;
+  {
+    Rfkill wlan_module(RFKILL_TYPE_WLAN, rfkill.monitor);
+    Rfkill other_bar(RFKILL_TYPE_WLAN, rfkill.monitor);
+    Rfkill bluetooth_module(RFKILL_TYPE_BLUETOOTH, rfkill.monitor);
+    wlan_module.on_update.connect(
+        [&](struct rfkill_event&) { wlan.push_back(wlan_module.getState()); });
+    bluetooth_module.on_update.connect(
+        [&](struct rfkill_event&) { bluetooth.push_back(bluetooth_module.getState()); });
+
+    rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_ADD, false);
+    rfkill.send(1, RFKILL_TYPE_BLUETOOTH, RFKILL_OP_ADD, false);
+    rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_CHANGE, true);
+    // repeated state is not announced again
+    rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_CHANGE, true);
+    rfkill.dispatch();
+
+    CHECK(wlan == std::vector<bool>{false, true});
+    CHECK(bluetooth == std::vector<bool>{false});
+    CHECK(other_bar.getState());
+  }
+
+  // destroyed subscribers are disconnected
+  rfkill.send(0, RFKILL_TYPE_WLAN, RFKILL_OP_CHANGE, false);
+  rfkill.dispatch();
+  CHECK(wlan.size() == 2);
+  CHECK_FALSE(rfkill.monitor->blocked(RFKILL_TYPE_WLAN));
+}
@@ -0,0 +1,113 @@
+#include "util/scroll_burst.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <vector>
+
+namespace {
+
+enum class Dir { UP, DOWN, LEFT, RIGHT };
+
+using Burst = waybar::util::ScrollBurst<Dir>::Burst;
+
+// Feed frames of synthetic scroll steps, collecting bursts the way AModule handles them
+std::vector<Burst> replay(const std::vector<std::vector<Dir>>& frames) {
+  waybar::util::ScrollBurst<Dir> burst;
+  std::vector<Burst> handled;
+  for (const auto& frame : frames) {
+    for (auto dir : frame) {
+      if (auto done = burst.add(dir)) {
+        handled.push_back(*done);
+      }
+    }
+    if (auto done = burst.take()) {
+      handled.push_back(*done);
+    }
+  }
+  return handled;
+}
+
+}  // namespace
+
+TEST_CASE("Scroll steps are coalesced per frame", "[util][scroll]") {
+  SECTION("No steps") {
+    waybar::util::ScrollBurst<Dir> burst;
+    REQUIRE(burst.empty());
+    REQUIRE_FALSE(burst.take());
+  }
+
+  SECTION("Single wheel click") {
+    REQUIRE(replay({{Dir::UP}}) == std::vector<Burst>{{Dir::UP, 1}});
+  }
+
+  SECTION("Touchpad flick is handled once per frame") {
+    std::vector<Dir> flick(30, Dir::DOWN);
+    REQUIRE(replay({flick}) == std::vector<Burst>{{Dir::DOWN, 30}});
+    REQUIRE(replay({{Dir::DOWN, Dir::DOWN}, {Dir::DOWN}, {}}) ==
+            std::vector<Burst>{{Dir::DOWN, 2}, {Dir::DOWN, 1}});
+  }
+
+  SECTION("Direction changes keep their order") {
+    REQUIRE(replay({{Dir::UP, Dir::UP, Dir::DOWN, Dir::UP}}) ==
+            std::vector<Burst>{{Dir::UP, 2}, {Dir::DOWN, 1}, {Dir::UP, 1}});
+    REQUIRE(replay({{Dir::LEFT, Dir::LEFT, Dir::RIGHT}}) ==
+            std::vector<Burst>{{Dir::LEFT, 2}, {Dir::RIGHT, 1}});
+  }
+
+  SECTION("Smooth events add several steps at once") {
+    waybar::util::ScrollBurst<Dir> burst;
+    burst.add(Dir::DOWN, 3);
+    burst.add(Dir::DOWN);
+    REQUIRE(burst.add(Dir::UP, 2) == Burst{Dir::DOWN, 4});
+    REQUIRE(burst.take() == Burst{Dir::UP, 2});
+  }
+
+  SECTION("Frame is empty after take") {
+    waybar::util::ScrollBurst<Dir> burst;
+    burst.add(Dir::UP);
+    REQUIRE_FALSE(burst.empty());
+    REQUIRE(burst.take() == Burst{Dir::UP, 1});
+    REQUIRE(burst.empty());
+  }
+}
+
+TEST_CASE("Smooth scroll distance steps per threshold", "[util][scroll]") {
+  waybar::util::ScrollDistance distance;
+
+  SECTION("A large delta gives several steps and keeps the remainder") {
+    distance.add(3.5);
+    REQUIRE(distance.take(1.0) == 3);
+    distance.add(0.4);
+    REQUIRE(distance.take(1.0) == 0);
+    distance.add(0.2);
+    REQUIRE(distance.take(1.0) == 1);
+  }
+
+  SECTION("Negative deltas step up or left") {
+    distance.add(-2.5);
+    REQUIRE(distance.take(1.0) == -2);
+    distance.add(0.5);
+    REQUIRE(distance.take(1.0) == 0);
+  }
+
+  SECTION("Reaching the threshold exactly is not a step") {
+    distance.add(1.0);
+    REQUIRE(distance.take(1.0) == 0);
+    distance.add(0.01);
+    REQUIRE(distance.take(1.0) == 1);
+    distance.add(-3.0);
+    REQUIRE(distance.take(1.0) == -2);
+  }
+
+  SECTION("Without a threshold any distance is one step") {
+    distance.add(12.0);
+    REQUIRE(distance.take(0) == 1);
+    REQUIRE(distance.take(0) == 0);
+    distance.add(-0.1);
+    REQUIRE(distance.take(0) == -1);
+  }
+}
@@ -0,0 +1,69 @@
+#include "modules/sni/icons.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <cairomm/surface.h>
+#include <gdkmm/wrap_init.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+using waybar::modules::SNI::IconCache;
+
+namespace {
+
+// 1x1 looping GIF of a red and a blue frame, shown for 100 ms each
+const unsigned char TWO_FRAME_GIF[] = {
+    'G', 'I', 'F', '8', '9', 'a', 0x01, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00,
+    // global color table: red, blue
+    0xff, 0x00, 0x00, 0x00, 0x00, 0xff,
+    // loop forever
+    0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00,
+    0x00, 0x00,
+    // red frame
+    0x21, 0xf9, 0x04, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x01, 0x00, 0x00, 0x02, 0x02, 0x44, 0x01, 0x00,
+    // blue frame
+    0x21, 0xf9, 0x04, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x01, 0x00, 0x00, 0x02, 0x02, 0x4c, 0x01, 0x00,
+    // trailer
+    0x3b};
+
+// Red and blue channels of the single pixel, ARGB32 is stored as BGRA on little endian
+std::pair<int, int> redBlue(const Cairo::RefPtr<Cairo::Surface>& surface) {
+  auto image = Cairo::RefPtr<Cairo::ImageSurface>::cast_dynamic(surface);
+  REQUIRE(image);
+  image->flush();
+  const auto pixel = *reinterpret_cast<const uint32_t*>(image->get_data());
+  return {(pixel >> 16) & 0xff, pixel & 0xff};
+}
+
+}  // namespace
+
+TEST_CASE("Every frame of a looping GIF is decoded", "[sni][icons]") {
+  Gdk::wrap_init();
+  const auto path = std::filesystem::temp_directory_path() / "waybar-test-movie.gif";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(TWO_FRAME_GIF), sizeof(TWO_FRAME_GIF));
+  }
+
+  auto movie = IconCache::loadMovie(path.string(), 1, 1);
+  std::filesystem::remove(path);
+  REQUIRE(movie);
+  REQUIRE(movie->frames.size() == 2);
+  CHECK(movie->frames[0].delay == 100);
+  CHECK(movie->frames[1].delay == 100);
+  // the loader reuses one pixbuf for all frames, each frame must still keep its own image
+  CHECK(redBlue(movie->frames[0].surface) == std::pair(255, 0));
+  CHECK(redBlue(movie->frames[1].surface) == std::pair(0, 255));
+
+  SECTION("a missing file gives no movie") {
+    CHECK_FALSE(IconCache::loadMovie(path.string(), 1, 1));
+  }
+}
@@ -0,0 +1,165 @@
+#include "modules/sway/ipc/prescan.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/json.hpp"
+
+using waybar::modules::sway::BarEvent;
+using waybar::modules::sway::classifyBarEvent;
+using waybar::modules::sway::topLevelString;
+
+namespace {
+
+// A workspace object as sway sends it in workspace events, trimmed to one window
+const std::string WORKSPACE = R"({
+  "id": 4, "type": "workspace", "orientation": "horizontal", "percent": null,
+  "urgent": false, "marks": [], "layout": "splith", "border": "none", "current_border_width": 0,
+  "rect": {"x": 0, "y": 30, "width": 2560, "height": 1410},
+  "deco_rect": {"x": 0, "y": 0, "width": 0, "height": 0},
+  "window_rect": {"x": 0, "y": 0, "width": 0, "height": 0},
+  "geometry": {"x": 0, "y": 0, "width": 0, "height": 0},
+  "name": "2: web", "window": null, "nodes": [{
+    "id": 9, "type": "con", "name": "Mozilla Firefox \"nightly\" {beta}", "urgent": false,
+    "focused": true, "marks": [], "layout": "none", "app_id": "firefox", "pid": 4242,
+    "rect": {"x": 0, "y": 30, "width": 2560, "height": 1410}, "nodes": [], "floating_nodes": [],
+    "inhibit_idle": false, "idle_inhibitors": {"user": "none", "application": "none"},
+    "shell": "xdg_shell", "visible": true}],
+  "floating_nodes": [], "focus": [9], "fullscreen_mode": 1, "sticky": false, "num": 2,
+  "output": "DP-1", "representation": "H[firefox]", "focused": true, "visible": true})";
+
+std::string workspaceEvent(const std::string& change, bool urgent = false) {
+  auto current = WORKSPACE;
+  if (urgent) {
+    current.replace(current.find("\"urgent\": false"), 15, "\"urgent\": true");
+  }
+  return R"({"change": ")" + change + R"(", "old": )" + WORKSPACE + R"(, "current": )" + current +
+         "}";
+}
+
+const std::string BINDING_EVENT = R"({"change": "run", "binding": {"command": "workspace 2",
+  "event_state_mask": ["Mod4"], "input_code": 0, "symbol": "2", "input_type": "keyboard"}})";
+
+/*
+ * Events of a minute at the keyboard with a hidden bar: mostly bindings and the workspace
+ * switches they cause, a resize mode and a window asking for attention
+ */
+std::vector<std::pair<uint32_t, std::string>> recordedStream() {
+  std::vector<std::pair<uint32_t, std::string>> events;
+  for (int i = 0; i < 40; ++i) {
+    events.emplace_back(IPC_EVENT_BINDING, BINDING_EVENT);
+    events.emplace_back(IPC_EVENT_WORKSPACE, workspaceEvent("focus"));
+  }
+  events.emplace_back(IPC_EVENT_MODE, R"({"change": "resize", "pango_markup": false})");
+  events.emplace_back(IPC_EVENT_MODE, R"({"change": "default", "pango_markup": false})");
+  events.emplace_back(IPC_EVENT_WORKSPACE, workspaceEvent("urgent", true));
+  events.emplace_back(IPC_EVENT_BAR_STATE_UPDATE,
+                      R"({"id": "bar-0", "visible_by_modifier": true})");
+  events.emplace_back(IPC_EVENT_BAR_STATE_UPDATE,
+                      R"({"id": "bar-0", "visible_by_modifier": false})");
+  events.emplace_back(IPC_EVENT_BAR_STATE_UPDATE,
+                      R"({"id": "bar-1", "visible_by_modifier": true})");
+  return events;
+}
+
+}  // namespace
+
+TEST_CASE("Top level strings are found without parsing", "[util][sway]") {
+  CHECK(topLevelString(R"({"change": "focus"})", "change") == "focus");
+  CHECK(topLevelString(" {\n\t\"a\" : 1 ,\"change\":\"x\"}", "change") == "x");
+  CHECK(topLevelString(R"({"id": "bar-0", "mode": "hide"})", "mode") == "hide");
+
+  SECTION("nested members of the same name are skipped") {
+    auto event = workspaceEvent("focus");
+    CHECK(topLevelString(event, "change") == "focus");
+    CHECK(topLevelString(R"({"current": {"name": "inner"}, "name": "outer"})", "name") ==
+          "outer");
+    CHECK_FALSE(topLevelString(R"({"current": {"name": "inner"}})", "name"));
+  }
+  SECTION("strings with braces, quotes and escapes are skipped whole") {
+    CHECK(topLevelString(R"({"a": "}\"{[", "b": ["]", {"c": "\\"}], "change": "ok"})",
+                         "change") == "ok");
+    CHECK(topLevelString(R"({"change": "say \"hi\""})", "change") == R"(say \"hi\")");
+  }
+  SECTION("members that are not strings") {
+    CHECK_FALSE(topLevelString(R"({"change": null})", "change"));
+    CHECK_FALSE(topLevelString(R"({"change": 1})", "change"));
+    CHECK(topLevelString(R"({"a": true, "b": -1.5e3, "change": "x"})", "change") == "x");
+  }
+  SECTION("malformed text") {
+    CHECK_FALSE(topLevelString("", "change"));
+    CHECK_FALSE(topLevelString("[]", "change"));
+    CHECK_FALSE(topLevelString(R"({"change": "unterminated)", "change"));
+    CHECK_FALSE(topLevelString(R"({"a": {"b": 1}, "change")", "change"));
+  }
+}
+
+TEST_CASE("Sway events are classified for the bar", "[util][sway]") {
+  CHECK(classifyBarEvent(IPC_EVENT_BINDING, BINDING_EVENT, "bar-0") == BarEvent::ACTION);
+  CHECK(classifyBarEvent(IPC_EVENT_WORKSPACE, workspaceEvent("focus"), "bar-0") ==
+        BarEvent::ACTION);
+  CHECK(classifyBarEvent(IPC_EVENT_WORKSPACE, workspaceEvent("urgent", true), "bar-0") ==
+        BarEvent::URGENT);
+  CHECK(classifyBarEvent(IPC_EVENT_WORKSPACE, "{}", "bar-0") == BarEvent::IGNORED);
+  CHECK(classifyBarEvent(IPC_EVENT_MODE, R"({"change": "resize"})", "bar-0") ==
+        BarEvent::MODE_OTHER);
+  CHECK(classifyBarEvent(IPC_EVENT_MODE, R"({"change": "default"})", "bar-0") ==
+        BarEvent::MODE_DEFAULT);
+  CHECK(classifyBarEvent(IPC_EVENT_WINDOW, R"({"change": "focus"})", "bar-0") ==
+        BarEvent::IGNORED);
+
+  SECTION("bar events for other bars are dropped before parsing") {
+    auto state = R"({"id": "bar-1", "visible_by_modifier": true})";
+    CHECK(classifyBarEvent(IPC_EVENT_BAR_STATE_UPDATE, state, "bar-1") == BarEvent::BAR_STATE);
+    CHECK(classifyBarEvent(IPC_EVENT_BAR_STATE_UPDATE, state, "bar-0") == BarEvent::IGNORED);
+    CHECK(classifyBarEvent(IPC_EVENT_BARCONFIG_UPDATE, R"({"id": "bar-0", "mode": "dock"})",
+                           "bar-0") == BarEvent::BAR_STATE);
+  }
+
+  SECTION("a recorded stream needs few full parses") {
+    int parsed = 0;
+    for (const auto& [type, payload] : recordedStream()) {
+      auto event = classifyBarEvent(type, payload, "bar-0");
+      parsed += event == BarEvent::URGENT || event == BarEvent::BAR_STATE;
+    }
+    CHECK(parsed == 3);
+  }
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Sway bar event cost", "[.][benchmark][sway]") {
+  const auto events = recordedStream();
+  waybar::util::JsonParser parser;
+
+  BENCHMARK("parse every event") {
+    int urgent = 0;
+    for (const auto& [type, payload] : events) {
+      auto json = parser.parse(payload);
+      urgent += type == IPC_EVENT_WORKSPACE && json["change"] == "urgent";
+    }
+    return urgent;
+  };
+  BENCHMARK("pre-scan, parse urgency and bar state") {
+    int urgent = 0;
+    for (const auto& [type, payload] : events) {
+      auto event = classifyBarEvent(type, payload, "bar-0");
+      if (event == BarEvent::URGENT || event == BarEvent::BAR_STATE) {
+        urgent += parser.parse(payload)["current"]["urgent"].asBool();
+      }
+    }
+    return urgent;
+  };
+}
+#endif
@@ -0,0 +1,157 @@
+#include "util/text.hpp"
+
+#include <glib.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+#include <string>
+
+#include "util/sanitize_str.hpp"
+#include "util/ustring_clen.hpp"
+
+using waybar::util::escape_markup;
+using waybar::util::process_text;
+using waybar::util::text_width;
+using waybar::util::TextOptions;
+using waybar::util::truncate_text;
+
+TEST_CASE("Text width", "[util][text]") {
+  SECTION("ASCII") {
+    REQUIRE(text_width("") == 0);
+    REQUIRE(text_width("Waybar") == 6);
+    REQUIRE(text_width("a fairly long ascii string, longer than one block") == 49);
+  }
+  SECTION("CJK is double width") { REQUIRE(text_width("日本語") == 6); }
+  SECTION("Emoji") {
+    REQUIRE(text_width("🎵") == 2);
+    REQUIRE(text_width("play 🎵 now") == 11);
+  }
+  SECTION("Combining marks are zero width") {
+    REQUIRE(text_width("e\u0301") == 1);
+    REQUIRE(text_width("cafe\u0301 au lait") == 12);
+  }
+  SECTION("Soft hyphen is zero width") { REQUIRE(text_width("soft\u00adhyphen") == 10); }
+  SECTION("Invalid UTF-8 counts bytes") { REQUIRE(text_width("ab\xff\xfe") == 4); }
+}
+
+TEST_CASE("Markup escaping", "[util][text]") {
+  const std::string inputs[] = {
+      "",
+      "plain ascii text without specials",
+      "<b>Tom & Jerry's \"show\"</b>",
+      "a fairly long prefix that is plain ascii & then <markup>",
+      "日本語 & 中文",
+      "ctrl \x01\x1f\x7f tab\tnewline\n",
+      "c1 \u0080\u0085\u009f",
+      "emoji 👩‍👩‍👧 <3",
+  };
+  for (const auto& input : inputs) {
+    gchar* expected = g_markup_escape_text(input.c_str(), input.size());
+    CHECK(escape_markup(input) == expected);
+    g_free(expected);
+  }
+}
+
+TEST_CASE("Invalid UTF-8 is escaped to valid markup", "[util][text]") {
+  auto res = process_text("a<b \xff\xfe", TextOptions{.escape = true});
+  REQUIRE(res.str == "a&lt;b \uFFFD\uFFFD");
+  REQUIRE(res.width == 6);
+  REQUIRE(g_utf8_validate(res.str.data(), res.str.size(), nullptr));
+  // without escaping the bytes are passed through
+  REQUIRE(process_text("a \xff", TextOptions{.max_width = 2}).str == "a ");
+}
+
+TEST_CASE("Callers that keep their own conventions", "[util][text]") {
+  SECTION("sanitize_string only replaces the five markup characters") {
+    REQUIRE(waybar::util::sanitize_string("<b>Tom & Jerry's \"show\"</b>") ==
+            "&lt;b&gt;Tom &amp; Jerry&apos;s &quot;show&quot;&lt;/b&gt;");
+    REQUIRE(waybar::util::sanitize_string("ctrl \x01\x7f") == "ctrl \x01\x7f");
+  }
+  SECTION("ustring_clen counts zero-width characters as one column") {
+    REQUIRE(ustring_clen("日本語") == 6);
+    REQUIRE(ustring_clen("e\u0301") == 2);
+  }
+}
+
+TEST_CASE("Truncation", "[util][text]") {
+  SECTION("Short strings are kept") {
+    auto res = process_text("Waybar", TextOptions{.max_width = 6});
+    REQUIRE(res.str == "Waybar");
+    REQUIRE(res.width == 6);
+    REQUIRE_FALSE(res.truncated);
+  }
+  SECTION("Ellipsis counts towards the width") {
+    auto res = process_text("Hello world", TextOptions{.max_width = 8});
+    REQUIRE(res.str == "Hello w…");
+    REQUIRE(res.width == 8);
+    REQUIRE(res.truncated);
+  }
+  SECTION("Long ASCII runs") {
+    auto res = process_text("abcdefghijklmnopqrstuvwxyz", TextOptions{.max_width = 10});
+    REQUIRE(res.str == "abcdefghi…");
+    REQUIRE(res.width == 10);
+  }
+  SECTION("Wide characters are not split") {
+    auto res = process_text("日本語テキスト", TextOptions{.max_width = 6});
+    REQUIRE(res.str == "日本…");
+    REQUIRE(res.width == 5);
+  }
+  SECTION("Combining marks stay with their base character") {
+    auto res = process_text("e\u0301e\u0301e\u0301e\u0301", TextOptions{.max_width = 3});
+    REQUIRE(res.str == "e\u0301e\u0301…");
+  }
+  SECTION("Emoji") {
+    auto res = process_text("🎵🎵🎵🎵", TextOptions{.max_width = 5});
+    REQUIRE(res.str == "🎵🎵…");
+  }
+  SECTION("Escaping happens after the cut") {
+    auto res = process_text("a<b>c<d>e", TextOptions{.escape = true, .max_width = 4});
+    REQUIRE(res.str == "a&lt;b…");
+    REQUIRE(res.width == 4);
+  }
+  SECTION("Trailing spaces are dropped before the ellipsis") {
+    auto res = process_text("Hello world", TextOptions{.max_width = 7});
+    REQUIRE(res.str == "Hello…");
+    REQUIRE(res.width == 6);
+  }
+  SECTION("Custom and empty ellipsis") {
+    std::string str = "Hello world";
+    REQUIRE(truncate_text(str, 7, "...") == 7);
+    REQUIRE(str == "Hell...");
+    str = "Hello world";
+    REQUIRE(truncate_text(str, 6, "") == 5);
+    REQUIRE(str == "Hello");
+  }
+  SECTION("Zero width and too narrow for the ellipsis") {
+    REQUIRE(process_text("Hello", TextOptions{.max_width = 0}).str.empty());
+    REQUIRE(process_text("Hello", TextOptions{.max_width = 2, .ellipsis = "..."}).str.empty());
+  }
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Text kernel benchmark", "[.][benchmark][text]") {
+  const std::string ascii = "Some Artist - A Rather Long Song Title (Extended Remix) & More";
+  const std::string cjk = "坂本龍一 - 戦場のメリークリスマス (Merry Christmas Mr. Lawrence)";
+  const std::string emoji = "🔥🔥 Trending: café vibes 🎵 <live> 🎵 playlist 2024 🔥🔥";
+
+  for (const auto* input : {&ascii, &cjk, &emoji}) {
+    BENCHMARK("g_markup_escape_text + g_utf8_strlen") {
+      gchar* escaped = g_markup_escape_text(input->c_str(), input->size());
+      glong len = g_utf8_strlen(escaped, -1);
+      g_free(escaped);
+      return len;
+    };
+    BENCHMARK("process_text") {
+      return process_text(*input, TextOptions{.escape = true, .max_width = 30}).width;
+    };
+  }
+}
+#endif
@@ -0,0 +1,114 @@
+#include "util/thread.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using waybar::util::Thread;
+
+namespace {
+
+// Thread attributes as seen from inside the thread
+struct Seen {
+  size_t stack_size = 0;
+  std::string name;
+};
+
+Seen inspect() {
+  Seen seen;
+  pthread_attr_t attr;
+  pthread_getattr_np(pthread_self(), &attr);
+  pthread_attr_getstacksize(&attr, &seen.stack_size);
+  pthread_attr_destroy(&attr);
+  char name[16] = {};
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  seen.name = name;
+  return seen;
+}
+
+}  // namespace
+
+TEST_CASE("Threads are named and counted", "[util][thread]") {
+  Seen seen;
+  std::string inherited;
+  Thread thread("hyprland/workspaces", [&] {
+    seen = inspect();
+    inherited = Thread::owner();
+  });
+  thread.join();
+
+  CHECK(seen.name == "hyprland/worksp");
+  // the default stack of the process, deep enough for std::regex on long titles
+  pthread_attr_t attr;
+  size_t default_size = 0;
+  pthread_getattr_default_np(&attr);
+  pthread_attr_getstacksize(&attr, &default_size);
+  pthread_attr_destroy(&attr);
+  CHECK(seen.stack_size >= default_size);
+  CHECK(inherited == "hyprland/workspaces");
+  CHECK(Thread::census().count("hyprland/workspaces") == 0);
+
+  {
+    Thread::Owner owner("battery");
+    CHECK(Thread::owner() == "battery");
+  }
+  CHECK(Thread::owner() != "battery");
+}
+
+TEST_CASE("Shallow threads stay within the stack budget", "[util][thread]") {
+  // three outputs with the same ten module types, each starting a socket helper
+  const std::vector<std::string> types = {"clock",   "cpu",     "memory",      "battery",
+                                          "network", "custom",  "temperature", "disk",
+                                          "load",    "backlight"};
+  const size_t outputs = 3;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  size_t started = 0;
+  size_t reserved = 0;
+
+  auto worker = [&] {
+    auto seen = inspect();
+    std::unique_lock lock(mutex);
+    reserved += seen.stack_size;
+    ++started;
+    cv.notify_all();
+    cv.wait(lock, [&] { return release; });
+  };
+  std::vector<Thread> threads;
+  for (size_t output = 0; output < outputs; ++output) {
+    for (const auto& type : types) {
+      threads.emplace_back(type, worker, Thread::SHALLOW_STACK_SIZE);
+    }
+  }
+  {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return started == threads.size(); });
+  }
+
+  auto census = Thread::census();
+  for (const auto& type : types) {
+    CHECK(census[type] == outputs);
+  }
+  CHECK(Thread::report().starts_with("30 threads"));
+  // 30 default threads would reserve 240 MiB
+  CHECK(reserved <= 30 * (Thread::SHALLOW_STACK_SIZE + 64 * 1024));
+
+  {
+    std::lock_guard lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(Thread::census().empty());
+}
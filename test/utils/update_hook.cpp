@@ -0,0 +1,74 @@
+#include "util/update_hook.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::UpdateHook;
+using namespace std::chrono_literals;
+
+TEST_CASE("Update hook runs only for changed output", "[util][update_hook]") {
+  UpdateHook hook;
+  auto now = UpdateHook::Clock::now();
+
+  REQUIRE_FALSE(hook.due(now));
+  REQUIRE(hook.update({"50%", "module"}));
+  REQUIRE(hook.due(now) == UpdateHook::Clock::duration::zero());
+  REQUIRE(hook.start(now) == UpdateHook::Output{"50%", "module"});
+  REQUIRE_FALSE(hook.due(now));
+
+  SECTION("Same output is skipped") {
+    REQUIRE_FALSE(hook.update({"50%", "module"}));
+    REQUIRE_FALSE(hook.due(now));
+  }
+
+  SECTION("Class change alone triggers the hook") {
+    REQUIRE(hook.update({"50%", "module warning"}));
+    REQUIRE(hook.start(now).classes == "module warning");
+  }
+
+  SECTION("Burst ends in one run with the latest output") {
+    REQUIRE(hook.update({"51%", "module"}));
+    REQUIRE(hook.update({"52%", "module"}));
+    REQUIRE_FALSE(hook.update({"52%", "module"}));
+    REQUIRE(hook.start(now).text == "52%");
+    REQUIRE_FALSE(hook.due(now));
+  }
+
+  SECTION("Output reverting before the run cancels it") {
+    REQUIRE(hook.update({"51%", "module"}));
+    REQUIRE_FALSE(hook.update({"50%", "module"}));
+    REQUIRE_FALSE(hook.due(now));
+  }
+}
+
+TEST_CASE("Update hook minimum interval", "[util][update_hook]") {
+  UpdateHook hook(1s);
+  auto now = UpdateHook::Clock::now();
+
+  hook.update({"1", ""});
+  REQUIRE(hook.due(now) == UpdateHook::Clock::duration::zero());
+  hook.start(now);
+
+  hook.update({"2", ""});
+  REQUIRE(hook.due(now + 250ms) == 750ms);
+  hook.update({"3", ""});
+  REQUIRE(hook.due(now + 1s) == UpdateHook::Clock::duration::zero());
+  REQUIRE(hook.start(now + 1s).text == "3");
+}
+
+TEST_CASE("Update hook without comparable output", "[util][update_hook]") {
+  UpdateHook hook;
+  auto now = UpdateHook::Clock::now();
+
+  hook.touch();
+  hook.touch();
+  REQUIRE(hook.due(now) == UpdateHook::Clock::duration::zero());
+  // nothing to pass on, the text and classes are left out of the environment
+  REQUIRE_FALSE(hook.start(now).rendered);
+  REQUIRE_FALSE(hook.due(now));
+  hook.touch();
+  REQUIRE(hook.due(now));
+}
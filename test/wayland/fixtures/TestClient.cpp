@@ -0,0 +1,52 @@
+#include <sys/socket.h>
+#include <wayland-client.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "TestServer.hpp"
+
+namespace {
+
+void handle_global(void *data, struct wl_registry *registry, uint32_t name, const char *interface,
+                   uint32_t /*version*/) {
+  if (std::strcmp(interface, wl_output_interface.name) == 0) {
+    auto *client = static_cast<TestClient *>(data);
+    client->outputs.push_back(
+        static_cast<struct wl_output *>(wl_registry_bind(registry, name, &wl_output_interface, 1)));
+  }
+}
+
+void handle_global_remove(void * /*data*/, struct wl_registry * /*registry*/, uint32_t /*name*/) {}
+
+const struct wl_registry_listener registry_listener = {
+    .global = handle_global,
+    .global_remove = handle_global_remove,
+};
+
+}  // namespace
+
+TestClient::TestClient(TestServer &server) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+    throw std::runtime_error("socketpair failed");
+  }
+  server.addClient(fds[0]);
+  display = wl_display_connect_to_fd(fds[1]);
+  if (display == nullptr) {
+    throw std::runtime_error("wl_display_connect_to_fd failed");
+  }
+  registry = wl_display_get_registry(display);
+  wl_registry_add_listener(registry, &registry_listener, this);
+  roundtrip();
+}
+
+TestClient::~TestClient() {
+  for (auto *output : outputs) {
+    wl_output_destroy(output);
+  }
+  wl_registry_destroy(registry);
+  wl_display_disconnect(display);
+}
+
+void TestClient::roundtrip() const { wl_display_roundtrip(display); }
@@ -0,0 +1,384 @@
+#include "TestServer.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <wayland-server.h>
+
+#include <algorithm>
+#include <future>
+
+#include "dwl-ipc-unstable-v2-server-protocol.h"
+#include "river-status-unstable-v1-server-protocol.h"
+
+namespace {
+
+TestServer *server_of(struct wl_resource *resource) {
+  return static_cast<TestServer *>(wl_resource_get_user_data(resource));
+}
+
+void destroy_resource(struct wl_client * /*client*/, struct wl_resource *resource) {
+  wl_resource_destroy(resource);
+}
+
+void resource_destroyed(struct wl_resource *resource) { server_of(resource)->forget(resource); }
+
+template <typename Impl>
+struct wl_resource *create_resource(struct wl_client *client, const struct wl_interface *interface,
+                                    uint32_t version, uint32_t id, const Impl *impl,
+                                    TestServer *server) {
+  auto *resource = wl_resource_create(client, interface, version, id);
+  wl_resource_set_implementation(resource, impl, server, resource_destroyed);
+  return resource;
+}
+
+void append(struct wl_array *array, uint32_t value) {
+  *static_cast<uint32_t *>(wl_array_add(array, sizeof(uint32_t))) = value;
+}
+
+// wl_seat, only advertised so the status objects find a seat
+void seat_get_object(struct wl_client *client, struct wl_resource * /*resource*/,
+                     uint32_t /*id*/) {
+  wl_client_post_no_memory(client);
+}
+
+const struct wl_seat_interface seat_impl = {
+    .get_pointer = seat_get_object,
+    .get_keyboard = seat_get_object,
+    .get_touch = seat_get_object,
+};
+
+// dwl-ipc-unstable-v2
+void dwl_get_output(struct wl_client * /*client*/, struct wl_resource *resource, uint32_t id,
+                    struct wl_resource *output) {
+  server_of(resource)->dwlGetOutput(resource, id, output);
+}
+
+const struct zdwl_ipc_manager_v2_interface dwl_manager_impl = {
+    .release = destroy_resource,
+    .get_output = dwl_get_output,
+};
+
+void dwl_set_tags(struct wl_client * /*client*/, struct wl_resource *resource, uint32_t tagmask,
+                  uint32_t /*toggle_tagset*/) {
+  server_of(resource)->dwlSetTags(resource, tagmask);
+}
+
+void dwl_set_client_tags(struct wl_client * /*client*/, struct wl_resource * /*resource*/,
+                         uint32_t /*and_tags*/, uint32_t /*xor_tags*/) {}
+
+void dwl_set_layout(struct wl_client * /*client*/, struct wl_resource * /*resource*/,
+                    uint32_t /*index*/) {}
+
+const struct zdwl_ipc_output_v2_interface dwl_output_impl = {
+    .release = destroy_resource,
+    .set_tags = dwl_set_tags,
+    .set_client_tags = dwl_set_client_tags,
+    .set_layout = dwl_set_layout,
+};
+
+// river-status-unstable-v1
+void river_get_output_status(struct wl_client * /*client*/, struct wl_resource *resource,
+                             uint32_t id, struct wl_resource *output) {
+  server_of(resource)->riverGetOutputStatus(resource, id, output);
+}
+
+void river_get_seat_status(struct wl_client * /*client*/, struct wl_resource *resource, uint32_t id,
+                           struct wl_resource * /*seat*/) {
+  server_of(resource)->riverGetSeatStatus(resource, id);
+}
+
+const struct zriver_status_manager_v1_interface river_manager_impl = {
+    .destroy = destroy_resource,
+    .get_river_output_status = river_get_output_status,
+    .get_river_seat_status = river_get_seat_status,
+};
+
+const struct zriver_output_status_v1_interface river_output_impl = {
+    .destroy = destroy_resource,
+};
+
+const struct zriver_seat_status_v1_interface river_seat_impl = {
+    .destroy = destroy_resource,
+};
+
+template <void (TestServer::*bind)(struct wl_client *, uint32_t, uint32_t)>
+void bind_global(struct wl_client *client, void *data, uint32_t version, uint32_t id) {
+  (static_cast<TestServer *>(data)->*bind)(client, version, id);
+}
+
+}  // namespace
+
+TestServer::TestServer(size_t outputs)
+    : display_(wl_display_create()),
+      wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      output_resources_(outputs),
+      dwl_outputs_(outputs),
+      river_outputs_(outputs) {
+  for (size_t i = 0; i < outputs; ++i) {
+    auto &global = output_globals_.emplace_back(new OutputGlobal{this, i});
+    wl_global_create(display_, &wl_output_interface, 1, global.get(),
+                     [](struct wl_client *client, void *data, uint32_t version, uint32_t id) {
+                       auto *global = static_cast<OutputGlobal *>(data);
+                       global->server->bindOutput(client, global->index, version, id);
+                     });
+  }
+  wl_global_create(display_, &wl_seat_interface, 1, this, bind_global<&TestServer::bindSeat>);
+  wl_global_create(display_, &zdwl_ipc_manager_v2_interface, 1, this,
+                   bind_global<&TestServer::bindDwl>);
+  wl_global_create(display_, &zriver_status_manager_v1_interface, 4, this,
+                   bind_global<&TestServer::bindRiver>);
+
+  wl_event_loop_add_fd(
+      wl_display_get_event_loop(display_), wake_fd_, WL_EVENT_READABLE,
+      [](int fd, uint32_t /*mask*/, void *data) {
+        auto *server = static_cast<TestServer *>(data);
+        eventfd_t value;
+        eventfd_read(fd, &value);
+        std::vector<std::function<void()>> queue;
+        {
+          std::lock_guard lock(server->mutex_);
+          queue.swap(server->queue_);
+        }
+        for (auto &fn : queue) {
+          fn();
+        }
+        return 0;
+      },
+      this);
+
+  thread_ = std::thread([this] { wl_display_run(display_); });
+}
+
+TestServer::~TestServer() {
+  run([this] { wl_display_terminate(display_); });
+  thread_.join();
+  wl_display_destroy_clients(display_);
+  wl_display_destroy(display_);
+  close(wake_fd_);
+}
+
+void TestServer::addClient(int fd) {
+  run([this, fd] { wl_client_create(display_, fd); });
+}
+
+void TestServer::run(const std::function<void()> &fn) {
+  std::promise<void> done;
+  {
+    std::lock_guard lock(mutex_);
+    queue_.emplace_back([this, &fn, &done] {
+      fn();
+      wl_display_flush_clients(display_);
+      done.set_value();
+    });
+  }
+  eventfd_write(wake_fd_, 1);
+  done.get_future().wait();
+}
+
+TestServer::Requests TestServer::requests() const {
+  std::lock_guard lock(mutex_);
+  return requests_;
+}
+
+struct wl_resource *TestServer::clientOutput(struct wl_client *client, size_t output) {
+  for (auto *resource : output_resources_[output]) {
+    if (wl_resource_get_client(resource) == client) {
+      return resource;
+    }
+  }
+  return nullptr;
+}
+
+void TestServer::forget(struct wl_resource *resource) {
+  for (auto &resources : output_resources_) {
+    std::erase(resources, resource);
+  }
+  dwl_resources_.erase(resource);
+  river_resources_.erase(resource);
+  std::erase(river_seats_, resource);
+}
+
+void TestServer::bindOutput(struct wl_client *client, size_t output, uint32_t version,
+                            uint32_t id) {
+  auto *resource = create_resource<void>(client, &wl_output_interface, version, id, nullptr, this);
+  output_resources_[output].push_back(resource);
+}
+
+void TestServer::bindSeat(struct wl_client *client, uint32_t version, uint32_t id) {
+  auto *resource = create_resource(client, &wl_seat_interface, version, id, &seat_impl, this);
+  wl_seat_send_capabilities(resource, 0);
+}
+
+/* dwl-ipc-unstable-v2 */
+
+void TestServer::bindDwl(struct wl_client *client, uint32_t version, uint32_t id) {
+  auto *resource = create_resource(client, &zdwl_ipc_manager_v2_interface, version, id,
+                                   &dwl_manager_impl, this);
+  zdwl_ipc_manager_v2_send_tags(resource, 9);
+  zdwl_ipc_manager_v2_send_layout(resource, "[]=");
+}
+
+void TestServer::dwlGetOutput(struct wl_resource *manager, uint32_t id,
+                              struct wl_resource *output) {
+  size_t index = 0;
+  for (; index < output_resources_.size(); ++index) {
+    if (std::ranges::count(output_resources_[index], output) != 0) {
+      break;
+    }
+  }
+  auto *resource =
+      create_resource(wl_resource_get_client(manager), &zdwl_ipc_output_v2_interface,
+                      wl_resource_get_version(manager), id, &dwl_output_impl, this);
+  if (index == output_resources_.size()) {
+    return;
+  }
+  dwl_resources_[resource] = index;
+
+  // the full state followed by a frame, like dwl does for new objects
+  const auto &state = dwl_outputs_[index];
+  for (uint32_t tag = 0; tag < state.tags.size(); ++tag) {
+    const auto &tag_state = state.tags[tag];
+    zdwl_ipc_output_v2_send_tag(resource, tag, tag_state.state, tag_state.clients,
+                                tag_state.focused);
+  }
+  zdwl_ipc_output_v2_send_layout(resource, 0);
+  zdwl_ipc_output_v2_send_title(resource, state.title.c_str());
+  zdwl_ipc_output_v2_send_appid(resource, "");
+  zdwl_ipc_output_v2_send_layout_symbol(resource, "[]=");
+  zdwl_ipc_output_v2_send_active(resource, index == 0);
+  zdwl_ipc_output_v2_send_frame(resource);
+}
+
+void TestServer::dwlSetTags(struct wl_resource *resource, uint32_t tagmask) {
+  {
+    std::lock_guard lock(mutex_);
+    ++requests_.dwl_set_tags;
+  }
+  auto it = dwl_resources_.find(resource);
+  if (it == dwl_resources_.end()) {
+    return;
+  }
+  const auto output = it->second;
+  for (uint32_t tag = 0; tag < dwl_outputs_[output].tags.size(); ++tag) {
+    const auto &state = dwl_outputs_[output].tags[tag];
+    const uint32_t active = (tagmask & (1 << tag)) ? ZDWL_IPC_OUTPUT_V2_TAG_STATE_ACTIVE : 0;
+    dwlTag(output, tag, active, state.clients, state.focused);
+  }
+  dwlFrame(output);
+}
+
+void TestServer::dwlTag(size_t output, uint32_t tag, uint32_t state, uint32_t clients,
+                        uint32_t focused) {
+  auto &tags = dwl_outputs_[output].tags;
+  if (tag >= tags.size()) {
+    tags.resize(tag + 1);
+  }
+  tags[tag] = {state, clients, focused};
+  for (auto &[resource, index] : dwl_resources_) {
+    if (index == output) {
+      zdwl_ipc_output_v2_send_tag(resource, tag, state, clients, focused);
+    }
+  }
+}
+
+void TestServer::dwlTitle(size_t output, const std::string &title) {
+  dwl_outputs_[output].title = title;
+  for (auto &[resource, index] : dwl_resources_) {
+    if (index == output) {
+      zdwl_ipc_output_v2_send_title(resource, title.c_str());
+    }
+  }
+}
+
+void TestServer::dwlFrame(size_t output) {
+  for (auto &[resource, index] : dwl_resources_) {
+    if (index == output) {
+      zdwl_ipc_output_v2_send_frame(resource);
+    }
+  }
+}
+
+/* river-status-unstable-v1 */
+
+void TestServer::bindRiver(struct wl_client *client, uint32_t version, uint32_t id) {
+  create_resource(client, &zriver_status_manager_v1_interface, version, id, &river_manager_impl,
+                  this);
+}
+
+void TestServer::riverGetOutputStatus(struct wl_resource *manager, uint32_t id,
+                                      struct wl_resource *output) {
+  size_t index = 0;
+  for (; index < output_resources_.size(); ++index) {
+    if (std::ranges::count(output_resources_[index], output) != 0) {
+      break;
+    }
+  }
+  auto *resource =
+      create_resource(wl_resource_get_client(manager), &zriver_output_status_v1_interface,
+                      wl_resource_get_version(manager), id, &river_output_impl, this);
+  if (index == output_resources_.size()) {
+    return;
+  }
+  river_resources_[resource] = index;
+
+  const auto &state = river_outputs_[index];
+  zriver_output_status_v1_send_focused_tags(resource, state.focused_tags);
+  struct wl_array tags;
+  wl_array_init(&tags);
+  for (auto view_tags : state.view_tags) {
+    append(&tags, view_tags);
+  }
+  zriver_output_status_v1_send_view_tags(resource, &tags);
+  wl_array_release(&tags);
+}
+
+void TestServer::riverGetSeatStatus(struct wl_resource *manager, uint32_t id) {
+  auto *client = wl_resource_get_client(manager);
+  auto *resource = create_resource(client, &zriver_seat_status_v1_interface,
+                                   wl_resource_get_version(manager), id, &river_seat_impl, this);
+  river_seats_.push_back(resource);
+
+  if (auto *output = clientOutput(client, 0)) {
+    zriver_seat_status_v1_send_focused_output(resource, output);
+  }
+  zriver_seat_status_v1_send_focused_view(resource, focused_view_.c_str());
+}
+
+void TestServer::riverFocusedTags(size_t output, uint32_t tags) {
+  river_outputs_[output].focused_tags = tags;
+  for (auto &[resource, index] : river_resources_) {
+    if (index == output) {
+      zriver_output_status_v1_send_focused_tags(resource, tags);
+    }
+  }
+}
+
+void TestServer::riverViewTags(size_t output, const std::vector<uint32_t> &tags) {
+  river_outputs_[output].view_tags = tags;
+  struct wl_array array;
+  wl_array_init(&array);
+  for (auto view_tags : tags) {
+    append(&array, view_tags);
+  }
+  for (auto &[resource, index] : river_resources_) {
+    if (index == output) {
+      zriver_output_status_v1_send_view_tags(resource, &array);
+    }
+  }
+  wl_array_release(&array);
+}
+
+void TestServer::riverFocusedView(const std::string &title) {
+  focused_view_ = title;
+  for (auto *resource : river_seats_) {
+    zriver_seat_status_v1_send_focused_view(resource, title.c_str());
+  }
+}
+
+void TestServer::riverUnfocusedOutput(size_t output) {
+  for (auto *resource : river_seats_) {
+    if (auto *wl_output = clientOutput(wl_resource_get_client(resource), output)) {
+      zriver_seat_status_v1_send_unfocused_output(resource, wl_output);
+    }
+  }
+}
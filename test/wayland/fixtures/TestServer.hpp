@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct wl_client;
+struct wl_display;
+struct wl_output;
+struct wl_registry;
+struct wl_resource;
+
+/*
+ * Headless stand-in for a compositor, running libwayland-server on its own thread.
+ *
+ * It advertises wl_output, wl_seat and the dwl-ipc and river-status globals with just enough
+ * state to script event storms against the modules' protocol objects. The scripting helpers
+ * must be called from a function passed to run().
+ */
+class TestServer {
+ public:
+  explicit TestServer(size_t outputs = 1);
+  TestServer(const TestServer &) = delete;
+  TestServer &operator=(const TestServer &) = delete;
+  ~TestServer();
+
+  // Serves a client on one end of a socket pair, see TestClient
+  void addClient(int fd);
+
+  // Runs fn on the server thread and flushes the events it sent before returning
+  void run(const std::function<void()> &fn);
+
+  // dwl-ipc-unstable-v2
+  void dwlTag(size_t output, uint32_t tag, uint32_t state, uint32_t clients, uint32_t focused);
+  void dwlTitle(size_t output, const std::string &title);
+  void dwlFrame(size_t output);
+
+  // river-status-unstable-v1
+  void riverFocusedTags(size_t output, uint32_t tags);
+  void riverViewTags(size_t output, const std::vector<uint32_t> &tags);
+  void riverFocusedView(const std::string &title);
+  void riverUnfocusedOutput(size_t output);
+
+  // State changes requested by clients
+  struct Requests {
+    uint32_t dwl_set_tags = 0;
+  };
+  Requests requests() const;
+
+  // Implementation details, public for the C callbacks
+  struct DwlOutput {
+    struct TagState {
+      uint32_t state = 0;
+      uint32_t clients = 0;
+      uint32_t focused = 0;
+    };
+    std::vector<TagState> tags = std::vector<TagState>(9);
+    std::string title;
+  };
+  struct RiverOutput {
+    uint32_t focused_tags = 1;
+    std::vector<uint32_t> view_tags;
+  };
+
+  void bindOutput(struct wl_client *client, size_t output, uint32_t version, uint32_t id);
+  void bindSeat(struct wl_client *client, uint32_t version, uint32_t id);
+  void bindDwl(struct wl_client *client, uint32_t version, uint32_t id);
+  void bindRiver(struct wl_client *client, uint32_t version, uint32_t id);
+
+  void dwlGetOutput(struct wl_resource *manager, uint32_t id, struct wl_resource *output);
+  void dwlSetTags(struct wl_resource *resource, uint32_t tagmask);
+  void riverGetOutputStatus(struct wl_resource *manager, uint32_t id, struct wl_resource *output);
+  void riverGetSeatStatus(struct wl_resource *manager, uint32_t id);
+  void forget(struct wl_resource *resource);
+
+ private:
+  struct wl_resource *clientOutput(struct wl_client *client, size_t output);
+
+  struct OutputGlobal {
+    TestServer *server;
+    size_t index;
+  };
+
+  struct wl_display *display_;
+  std::vector<std::unique_ptr<OutputGlobal>> output_globals_;
+  int wake_fd_;
+  std::thread thread_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::function<void()>> queue_;
+  Requests requests_;
+
+  std::vector<std::vector<struct wl_resource *>> output_resources_;
+  std::vector<DwlOutput> dwl_outputs_;
+  std::map<struct wl_resource *, size_t> dwl_resources_;
+  std::vector<RiverOutput> river_outputs_;
+  std::map<struct wl_resource *, size_t> river_resources_;
+  std::vector<struct wl_resource *> river_seats_;
+  std::string focused_view_;
+};
+
+/*
+ * Client side of a TestServer connection with the outputs bound.
+ */
+struct TestClient {
+  explicit TestClient(TestServer &server);
+  TestClient(const TestClient &) = delete;
+  TestClient &operator=(const TestClient &) = delete;
+  ~TestClient();
+
+  void roundtrip() const;
+
+  struct wl_display *display;
+  struct wl_registry *registry;
+  std::vector<struct wl_output *> outputs;
+};
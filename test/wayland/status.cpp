@@ -0,0 +1,269 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#if __has_include(<catch2/benchmark/catch_benchmark.hpp>)
+#include <catch2/benchmark/catch_benchmark.hpp>
+#define WAYBAR_HAVE_BENCHMARK
+#endif
+
+#include <fmt/format.h>
+#include <glibmm/main.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "fixtures/TestServer.hpp"
+#include "modules/dwl/status.hpp"
+#include "modules/river/status.hpp"
+
+namespace dwl = waybar::modules::dwl;
+namespace river = waybar::modules::river;
+
+namespace {
+
+struct DwlRecorder : dwl::StatusListener {
+  void handle_status(const dwl::OutputState &output, uint32_t changed) override {
+    snapshots.push_back(output);
+    changes.push_back(changed);
+  }
+  std::vector<dwl::OutputState> snapshots;
+  std::vector<uint32_t> changes;
+};
+
+struct RiverRecorder : river::StatusListener {
+  void handle_status(const river::OutputState &output, const river::SeatState &seat,
+                     uint32_t changed) override {
+    outputs.push_back(output);
+    seats.push_back(seat);
+    changes.push_back(changed);
+  }
+  std::vector<river::OutputState> outputs;
+  std::vector<river::SeatState> seats;
+  std::vector<uint32_t> changes;
+};
+
+// Runs the idle handlers the river status coalesces its notifications in
+void drain() {
+  auto context = Glib::MainContext::get_default();
+  while (context->iteration(false)) {
+  }
+}
+
+[[maybe_unused]] double thread_cpu_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+}  // namespace
+
+TEST_CASE("dwl status delivers one snapshot per frame", "[wayland][dwl]") {
+  TestServer server;
+  TestClient client(server);
+  auto status = dwl::Status::getInstance(client.display);
+  REQUIRE(status->available());
+
+  DwlRecorder recorder;
+  status->addListener(client.outputs[0], &recorder);
+  client.roundtrip();
+  REQUIRE(recorder.snapshots.size() == 1);
+  CHECK(recorder.snapshots[0].tags.size() == 9);
+  CHECK(recorder.snapshots[0].active);
+
+  SECTION("title storm with a frame per title") {
+    server.run([&] {
+      for (int i = 0; i < 200; ++i) {
+        server.dwlTitle(0, fmt::format("title {}", i));
+        server.dwlFrame(0);
+      }
+    });
+    client.roundtrip();
+    REQUIRE(recorder.snapshots.size() == 201);
+    CHECK(recorder.snapshots.back().title == "title 199");
+    CHECK(recorder.changes.back() == dwl::StatusChange::TITLE);
+  }
+
+  SECTION("tag and title storm coalesced by a single frame") {
+    server.run([&] {
+      for (uint32_t i = 0; i < 200; ++i) {
+        server.dwlTag(0, i % 9, ZDWL_IPC_OUTPUT_V2_TAG_STATE_ACTIVE, i, 0);
+        server.dwlTitle(0, fmt::format("title {}", i));
+      }
+      server.dwlFrame(0);
+    });
+    client.roundtrip();
+    REQUIRE(recorder.snapshots.size() == 2);
+    CHECK(recorder.snapshots[1].title == "title 199");
+    CHECK(recorder.snapshots[1].active_tags == 0x1ff);
+    CHECK(recorder.snapshots[1].tags[199 % 9].clients == 199);
+    CHECK(recorder.changes[1] == (dwl::StatusChange::TAGS | dwl::StatusChange::TITLE));
+  }
+
+  SECTION("frames without changes are not delivered") {
+    server.run([&] {
+      for (int i = 0; i < 200; ++i) {
+        server.dwlTitle(0, "");
+        server.dwlFrame(0);
+      }
+    });
+    client.roundtrip();
+    CHECK(recorder.snapshots.size() == 1);
+  }
+
+  SECTION("set_tags reaches the compositor") {
+    status->set_tags(client.outputs[0], 1 << 3, 0);
+    client.roundtrip();
+    CHECK(server.requests().dwl_set_tags == 1);
+    REQUIRE(recorder.snapshots.size() == 2);
+    CHECK(recorder.snapshots.back().active_tags == 1 << 3);
+  }
+
+  status->removeListener(&recorder);
+}
+
+TEST_CASE("dwl status shares one object between listeners", "[wayland][dwl]") {
+  TestServer server(2);
+  TestClient client(server);
+  auto status = dwl::Status::getInstance(client.display);
+
+  DwlRecorder first;
+  DwlRecorder second;
+  DwlRecorder other;
+  status->addListener(client.outputs[0], &first);
+  status->addListener(client.outputs[1], &other);
+  client.roundtrip();
+  status->addListener(client.outputs[0], &second);
+  drain();
+  REQUIRE(second.snapshots.size() == 1);
+
+  server.run([&] {
+    server.dwlTitle(0, "focused");
+    server.dwlFrame(0);
+  });
+  client.roundtrip();
+  CHECK(first.snapshots.back().title == "focused");
+  CHECK(second.snapshots.back().title == "focused");
+  CHECK(other.snapshots.size() == 1);
+
+  status->removeListener(&first);
+  status->removeListener(&second);
+  status->removeListener(&other);
+}
+
+TEST_CASE("Status instances are kept per display", "[wayland]") {
+  TestServer server;
+  TestClient first(server);
+  TestClient second(server);
+
+  auto dwl_status = dwl::Status::getInstance(first.display);
+  CHECK(dwl::Status::getInstance(first.display) == dwl_status);
+  CHECK(dwl::Status::getInstance(second.display) != dwl_status);
+
+  auto river_status = river::Status::getInstance(first.display);
+  CHECK(river::Status::getInstance(first.display) == river_status);
+  CHECK(river::Status::getInstance(second.display) != river_status);
+}
+
+TEST_CASE("river outputs added after an unfocus start out unfocused", "[wayland][river]") {
+  TestServer server;
+  TestClient client(server);
+  auto status = river::Status::getInstance(client.display);
+  client.roundtrip();
+
+  server.run([&] { server.riverUnfocusedOutput(0); });
+  client.roundtrip();
+
+  RiverRecorder recorder;
+  status->addListener(client.outputs[0], &recorder);
+  client.roundtrip();
+  drain();
+  REQUIRE_FALSE(recorder.changes.empty());
+  CHECK_FALSE(recorder.outputs.back().focused);
+  CHECK(recorder.seats.back().focused_output == nullptr);
+  status->removeListener(&recorder);
+}
+
+TEST_CASE("river status coalesces bursts into one notification", "[wayland][river]") {
+  TestServer server;
+  TestClient client(server);
+  auto status = river::Status::getInstance(client.display);
+
+  RiverRecorder recorder;
+  status->addListener(client.outputs[0], &recorder);
+  client.roundtrip();
+  drain();
+  REQUIRE(recorder.changes.size() == 1);
+  CHECK(recorder.outputs[0].focused);
+  CHECK(recorder.seats[0].focused_output == client.outputs[0]);
+
+  server.run([&] {
+    for (uint32_t i = 0; i < 200; ++i) {
+      server.riverFocusedTags(0, 1 << (i % 9));
+      server.riverViewTags(0, {1u << (i % 9), 1});
+      server.riverFocusedView(fmt::format("view {}", i));
+    }
+  });
+  client.roundtrip();
+  drain();
+  REQUIRE(recorder.changes.size() == 2);
+  CHECK(recorder.outputs[1].focused_tags == 1 << (199 % 9));
+  CHECK(recorder.outputs[1].view_tags == ((1u << (199 % 9)) | 1));
+  CHECK(recorder.seats[1].focused_view == "view 199");
+  CHECK(recorder.changes[1] == (river::StatusChange::FOCUSED_TAGS |
+                                river::StatusChange::VIEW_TAGS |
+                                river::StatusChange::FOCUSED_VIEW));
+
+  status->removeListener(&recorder);
+}
+
+#ifdef WAYBAR_HAVE_BENCHMARK
+TEST_CASE("Status event cost", "[.][benchmark][wayland]") {
+  constexpr int events = 1000;
+  TestServer server;
+  TestClient client(server);
+
+  SECTION("dwl") {
+    auto status = dwl::Status::getInstance(client.display);
+    DwlRecorder recorder;
+    status->addListener(client.outputs[0], &recorder);
+    client.roundtrip();
+
+    // the events are queued before the clock starts, only the client side dispatch is counted
+    server.run([&] {
+      for (int i = 0; i < events; ++i) {
+        server.dwlTitle(0, fmt::format("title {}", i));
+        server.dwlFrame(0);
+      }
+    });
+    const auto start = thread_cpu_ns();
+    client.roundtrip();
+    REQUIRE(recorder.snapshots.size() == events + 1);
+    WARN("dwl client CPU per title+frame: " << (thread_cpu_ns() - start) / events << " ns");
+    status->removeListener(&recorder);
+  }
+
+  SECTION("river") {
+    auto status = river::Status::getInstance(client.display);
+    RiverRecorder recorder;
+    status->addListener(client.outputs[0], &recorder);
+    client.roundtrip();
+    drain();
+
+    server.run([&] {
+      for (int i = 0; i < events; ++i) {
+        server.riverFocusedTags(0, 1 << (i % 9));
+        server.riverFocusedView(fmt::format("view {}", i));
+      }
+    });
+    const auto start = thread_cpu_ns();
+    client.roundtrip();
+    drain();
+    WARN("river client CPU per tags+view: " << (thread_cpu_ns() - start) / events << " ns");
+    status->removeListener(&recorder);
+  }
+}
+#endif